@@ -85,6 +85,7 @@ static bool check_device_type (struct disk *);
 static void identify_ata_device (struct disk *);
 
 static void select_sector (struct disk *, disk_sector_t);
+static void select_sectors (struct disk *, disk_sector_t, size_t cnt);
 static void issue_pio_command (struct channel *, uint8_t command);
 static void input_sector (struct channel *, void *);
 static void output_sector (struct channel *, const void *);
@@ -226,6 +227,57 @@ disk_read (struct disk *d, disk_sector_t sec_no, void *buffer) {
 	lock_release (&c->lock);
 }
 
+/* Reads CNT consecutive sectors starting at SEC_NO from disk D
+   into BUFFER, which must have room for CNT * DISK_SECTOR_SIZE
+   bytes, with a single READ SECTOR(S) command.  CNT must be
+   between 1 and DISK_READ_MAX.
+   Internally synchronizes accesses to disks, so external
+   per-disk locking is unneeded. */
+void
+disk_read_multi (struct disk *d, disk_sector_t sec_no, size_t cnt,
+		void *buffer) {
+	struct iovec iov = { buffer, cnt * DISK_SECTOR_SIZE };
+
+	ASSERT (buffer != NULL);
+	disk_readv_multi (d, sec_no, cnt, &iov, 0);
+}
+
+/* Reads CNT consecutive sectors starting at SEC_NO from disk D
+   with a single READ SECTOR(S) command, as disk_read_multi()
+   does, but scatters them over the buffers in IOV, filling each
+   before moving to the next, starting OFS bytes into the first.
+   Each sector must fit within one buffer, and the buffers must
+   have room for all CNT of them. */
+void
+disk_readv_multi (struct disk *d, disk_sector_t sec_no, size_t cnt,
+		const struct iovec *iov, size_t ofs) {
+	struct channel *c;
+
+	ASSERT (d != NULL);
+	ASSERT (iov != NULL);
+	ASSERT (cnt > 0 && cnt <= DISK_READ_MAX);
+
+	c = d->channel;
+	lock_acquire (&c->lock);
+	select_sectors (d, sec_no, cnt);
+	issue_pio_command (c, CMD_READ_SECTOR_RETRY);
+	/* The device interrupts once per sector, as it becomes ready. */
+	for (size_t i = 0; i < cnt; i++, ofs += DISK_SECTOR_SIZE) {
+		while (ofs == iov->iov_len) {
+			iov++;
+			ofs = 0;
+		}
+		ASSERT (iov->iov_len - ofs >= DISK_SECTOR_SIZE);
+		sema_down (&c->completion_wait);
+		if (!wait_while_busy (d))
+			PANIC ("%s: disk read failed, sector=%"PRDSNu, d->name,
+					sec_no + (disk_sector_t) i);
+		input_sector (c, (uint8_t *) iov->iov_base + ofs);
+	}
+	d->read_cnt += cnt;
+	lock_release (&c->lock);
+}
+
 /* Write sector SEC_NO to disk D from BUFFER, which must contain
    DISK_SECTOR_SIZE bytes.  Returns after the disk has
    acknowledged receiving the data.
@@ -250,6 +302,40 @@ disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer) {
 	lock_release (&c->lock);
 }
 
+/* Writes CNT consecutive sectors starting at SEC_NO to disk D
+   from BUFFER, which must contain CNT * DISK_SECTOR_SIZE bytes,
+   with a single WRITE SECTOR(S) command.  CNT must be between 1
+   and DISK_READ_MAX.  Returns after the disk has acknowledged
+   receiving all of the data.
+   Internally synchronizes accesses to disks, so external
+   per-disk locking is unneeded. */
+void
+disk_write_multi (struct disk *d, disk_sector_t sec_no, size_t cnt,
+		const void *buffer) {
+	struct channel *c;
+	const uint8_t *p = buffer;
+
+	ASSERT (d != NULL);
+	ASSERT (buffer != NULL);
+	ASSERT (cnt > 0 && cnt <= DISK_READ_MAX);
+
+	c = d->channel;
+	lock_acquire (&c->lock);
+	select_sectors (d, sec_no, cnt);
+	issue_pio_command (c, CMD_WRITE_SECTOR_RETRY);
+	/* The device asks for each sector in turn, and interrupts once
+	   it has taken it. */
+	for (size_t i = 0; i < cnt; i++, p += DISK_SECTOR_SIZE) {
+		if (!wait_while_busy (d))
+			PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name,
+					sec_no + (disk_sector_t) i);
+		output_sector (c, p);
+		sema_down (&c->completion_wait);
+	}
+	d->write_cnt += cnt;
+	lock_release (&c->lock);
+}
+
 /* Disk detection and identification. */
 
 static void print_ata_string (char *string, size_t size);
@@ -406,13 +492,21 @@ print_ata_string (char *string, size_t size) {
    use LBA mode.) */
 static void
 select_sector (struct disk *d, disk_sector_t sec_no) {
+	select_sectors (d, sec_no, 1);
+}
+
+/* As select_sector(), but selects CNT sectors starting at
+   SEC_NO.  A sector count of 0 tells the device 256. */
+static void
+select_sectors (struct disk *d, disk_sector_t sec_no, size_t cnt) {
 	struct channel *c = d->channel;
 
-	ASSERT (sec_no < d->capacity);
-	ASSERT (sec_no < (1UL << 28));
+	ASSERT (sec_no + cnt <= d->capacity);
+	ASSERT (sec_no + cnt <= (1UL << 28));
+	ASSERT (cnt > 0 && cnt <= DISK_READ_MAX);
 
 	select_device_wait (d);
-	outb (reg_nsect (c), 1);
+	outb (reg_nsect (c), (uint8_t) cnt);
 	outb (reg_lbal (c), sec_no);
 	outb (reg_lbam (c), sec_no >> 8);
 	outb (reg_lbah (c), (sec_no >> 16));
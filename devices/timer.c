@@ -7,6 +7,7 @@
 #include "threads/io.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
 
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -131,6 +132,7 @@ static void timer_interrupt (struct intr_frame *args UNUSED) {
 	if (get_next_tick_to_awake() <= ticks) {
 		thread_awake(ticks);
 	}
+	workqueue_tick (ticks);
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
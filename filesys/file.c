@@ -1,6 +1,7 @@
 #include "filesys/file.h"
 #include <debug.h>
 #include "filesys/inode.h"
+#include "filesys/pipe.h"
 #include "threads/malloc.h"
 
 // /* An open file. */
@@ -42,7 +43,15 @@ file_reopen (struct file *file) {
  * same inode as FILE. Returns a null pointer if unsuccessful. */
 struct file *
 file_duplicate (struct file *file) {
-	struct file *nfile = file_open (inode_reopen (file->inode));
+	struct file *nfile;
+
+	if (file->pipe != NULL) {
+		nfile = pipe_reopen (file);
+		if (nfile)
+			nfile->dup_count = file->dup_count;
+		return nfile;
+	}
+	nfile = file_open (inode_reopen (file->inode));
 	if (nfile) {
 		nfile->pos = file->pos;
 		if (file->deny_write)
@@ -56,8 +65,12 @@ file_duplicate (struct file *file) {
 void
 file_close (struct file *file) {
 	if (file != NULL) {
-		file_allow_write (file);
-		inode_close (file->inode);
+		if (file->pipe != NULL)
+			pipe_close (file);
+		else {
+			file_allow_write (file);
+			inode_close (file->inode);
+		}
 		free (file);
 	}
 }
@@ -68,6 +81,13 @@ file_get_inode (struct file *file) {
 	return file->inode;
 }
 
+/* Returns true if FILE is an end of a pipe rather than an open
+ * inode. */
+bool
+file_is_pipe (struct file *file) {
+	return file->pipe != NULL;
+}
+
 /* Reads SIZE bytes from FILE into BUFFER,
  * starting at the file's current position.
  * Returns the number of bytes actually read,
@@ -124,6 +144,24 @@ file_write_at (struct file *file, const void *buffer, off_t size,
 	return inode_write_at (file->inode, buffer, size, file_ofs);
 }
 
+/* Reads from FILE into the IOVCNT buffers in IOV, starting at
+ * offset FILE_OFS in the file, as inode_read_iov() does.  The
+ * file's current position is unaffected. */
+off_t
+file_readv_at (struct file *file, const struct iovec *iov, int iovcnt,
+		off_t file_ofs) {
+	return inode_read_iov (file->inode, iov, iovcnt, file_ofs);
+}
+
+/* Writes the IOVCNT buffers in IOV into FILE, starting at offset
+ * FILE_OFS in the file, as inode_write_iov() does.  The file's
+ * current position is unaffected. */
+off_t
+file_writev_at (struct file *file, const struct iovec *iov, int iovcnt,
+		off_t file_ofs) {
+	return inode_write_iov (file->inode, iov, iovcnt, file_ofs);
+}
+
 /* Prevents write operations on FILE's underlying inode
  * until file_allow_write() is called or FILE is closed. */
 void
@@ -1,5 +1,6 @@
 #include "filesys/fsutil.h"
 #include <debug.h>
+#include <round.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +10,7 @@
 #include "devices/disk.h"
 #include "threads/malloc.h"
 #include "threads/palloc.h"
+#include "threads/schedtrace.h"
 #include "threads/vaddr.h"
 
 /* List files in the root directory. */
@@ -187,3 +189,32 @@ fsutil_get (char **argv) {
 	file_close (src);
 	free (buffer);
 }
+
+/* Saves the scheduler event trace to file ARGV[1], replacing
+ * any existing file of that name.  Use `pintos -g' to retrieve
+ * it and utils/schedtrace-report to analyze it. */
+void
+fsutil_schedtrace (char **argv) {
+	const char *file_name = argv[1];
+	size_t pages = DIV_ROUND_UP (schedtrace_format_size (), PGSIZE);
+	struct file *dst;
+	char *buffer;
+	off_t size;
+
+	printf ("Saving scheduler trace to '%s'...\n", file_name);
+
+	buffer = palloc_get_multiple (PAL_ASSERT, pages);
+	size = schedtrace_format (buffer, pages * PGSIZE);
+
+	filesys_remove (file_name);
+	if (!filesys_create (file_name, size))
+		PANIC ("%s: create failed", file_name);
+	dst = filesys_open (file_name);
+	if (dst == NULL)
+		PANIC ("%s: open failed", file_name);
+	if (file_write (dst, buffer, size) != size)
+		PANIC ("%s: write failed", file_name);
+
+	file_close (dst);
+	palloc_free_multiple (buffer, pages);
+}
@@ -6,6 +6,8 @@
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
 #include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -181,6 +183,138 @@ inode_remove (struct inode *inode) {
 	inode->removed = true;
 }
 
+/* Sectors the bounce page holds. */
+#define BOUNCE_SECTORS (PGSIZE / DISK_SECTOR_SIZE)
+
+/* A position in a list of buffers being read into or written
+ * from. */
+struct iov_iter {
+	const struct iovec *iov;            /* Current buffer. */
+	int cnt;                            /* Buffers left, this one included. */
+	size_t ofs;                         /* Offset into the current buffer. */
+};
+
+/* Moves IT past any buffers it has reached the end of. */
+static void
+iter_settle (struct iov_iter *it) {
+	while (it->cnt > 0 && it->ofs == it->iov->iov_len) {
+		it->iov++;
+		it->cnt--;
+		it->ofs = 0;
+	}
+}
+
+/* Returns how many bytes the disk may transfer straight to or from
+ * IT's current buffer: what is left of it. */
+static size_t
+iter_direct (struct iov_iter *it) {
+	iter_settle (it);
+	if (it->cnt == 0)
+		return 0;
+	return it->iov->iov_len - it->ofs;
+}
+
+/* Returns how many bytes the disk may read straight into the
+ * buffers at IT: what is left of the current one, and of those
+ * after it for as long as the ones before hold whole sectors, so
+ * that no sector straddles two buffers.  See disk_readv_multi(). */
+static size_t
+iter_direct_run (struct iov_iter *it) {
+	size_t room = iter_direct (it);
+
+	for (int i = 1; i < it->cnt && room % DISK_SECTOR_SIZE == 0; i++)
+		room += it->iov[i].iov_len;
+	return room;
+}
+
+/* Advances IT past SIZE bytes. */
+static void
+iter_skip (struct iov_iter *it, size_t size) {
+	while (size > 0) {
+		size_t n;
+
+		iter_settle (it);
+		ASSERT (it->cnt > 0);
+		n = it->iov->iov_len - it->ofs;
+		if (n > size)
+			n = size;
+		it->ofs += n;
+		size -= n;
+	}
+}
+
+/* Returns IT's current position. */
+static uint8_t *
+iter_ptr (const struct iov_iter *it) {
+	return (uint8_t *) it->iov->iov_base + it->ofs;
+}
+
+/* Copies SIZE bytes from SRC into the buffers at IT and advances IT
+ * past them. */
+static void
+iter_copy_out (struct iov_iter *it, const void *src_, size_t size) {
+	const uint8_t *src = src_;
+
+	while (size > 0) {
+		size_t n;
+
+		iter_settle (it);
+		ASSERT (it->cnt > 0);
+		n = it->iov->iov_len - it->ofs;
+		if (n > size)
+			n = size;
+		memcpy (iter_ptr (it), src, n);
+		it->ofs += n;
+		src += n;
+		size -= n;
+	}
+}
+
+/* Copies SIZE bytes from the buffers at IT into DST and advances IT
+ * past them. */
+static void
+iter_copy_in (struct iov_iter *it, void *dst_, size_t size) {
+	uint8_t *dst = dst_;
+
+	while (size > 0) {
+		size_t n;
+
+		iter_settle (it);
+		ASSERT (it->cnt > 0);
+		n = it->iov->iov_len - it->ofs;
+		if (n > size)
+			n = size;
+		memcpy (dst, iter_ptr (it), n);
+		it->ofs += n;
+		dst += n;
+		size -= n;
+	}
+}
+
+/* Returns the total length of the IOVCNT buffers in IOV. */
+static size_t
+iov_length (const struct iovec *iov, int iovcnt) {
+	size_t size = 0;
+
+	for (int i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+	return size;
+}
+
+/* Returns how many sectors of INODE, starting with SECTOR_IDX at
+ * OFFSET and up to MAX of them, follow one another on disk. */
+static size_t
+sector_run (const struct inode *inode, disk_sector_t sector_idx,
+		off_t offset, size_t max) {
+	size_t cnt = 1;
+
+	while (cnt < max
+			&& byte_to_sector (inode, offset + cnt * DISK_SECTOR_SIZE)
+				== sector_idx + cnt)
+		cnt++;
+	return cnt;
+}
+
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
  * Returns the number of bytes actually read, which may be less
  * than SIZE if an error occurs or end of file is reached. */
@@ -188,8 +322,26 @@ inode_remove (struct inode *inode) {
 /* 실제 읽은 바이트 수를 반환한다. */
 /* 오류가 발생하거나 파일의 끝에 도달한 경우 SIZE보다 작음. */
 off_t
-inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset) {
-	uint8_t *buffer = buffer_;
+inode_read_at (struct inode *inode, void *buffer, off_t size, off_t offset) {
+	struct iovec iov = { buffer, size };
+
+	return inode_read_iov (inode, &iov, 1, offset);
+}
+
+/* Reads from INODE, starting at position OFFSET, into the IOVCNT
+ * buffers in IOV, filling each before moving to the next.  Returns
+ * the number of bytes actually read, which may be less than their
+ * total length if an error occurs or end of file is reached.
+ *
+ * Full sectors that follow one another on disk are read with a
+ * single command even where the data crosses from one buffer to
+ * the next: scattered straight into the buffers while each holds
+ * whole sectors, otherwise through a page-sized bounce buffer. */
+off_t
+inode_read_iov (struct inode *inode, const struct iovec *iov, int iovcnt,
+		off_t offset) {
+	struct iov_iter it = { iov, iovcnt, 0 };
+	size_t size = iov_length (iov, iovcnt);
 	off_t bytes_read = 0;
 	uint8_t *bounce = NULL;
 
@@ -205,23 +357,49 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset) {
 		int min_left = inode_left < sector_left ? inode_left : sector_left;
 
 		/* Number of bytes to actually copy out of this sector. */
-		int chunk_size = size < min_left ? size : min_left;
-		if (chunk_size <= 0)
+		if (min_left <= 0)
 			break;
+		int chunk_size = size < (size_t) min_left ? (int) size : min_left;
+
+		if (bounce == NULL
+				&& (sector_ofs != 0 || chunk_size != DISK_SECTOR_SIZE
+					|| iter_direct_run (&it) < DISK_SECTOR_SIZE)) {
+			bounce = palloc_get_page (0);
+			if (bounce == NULL)
+				break;
+		}
 
 		if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE) {
-			/* Read full sector directly into caller's buffer. */
-			disk_read (filesys_disk, sector_idx, buffer + bytes_read); 
+			/* Read as many full sectors as are consecutive on disk
+			 * in one request: directly into the caller's buffers if
+			 * they have room for them, else into the bounce buffer
+			 * to be copied out. */
+			size_t room = iter_direct_run (&it);
+			size_t max = room >= DISK_SECTOR_SIZE
+				? room / DISK_SECTOR_SIZE : BOUNCE_SECTORS;
+			size_t left = (size < (size_t) inode_left
+				? size : (size_t) inode_left) / DISK_SECTOR_SIZE;
+			size_t cnt;
+
+			if (max > left)
+				max = left;
+			if (max > DISK_READ_MAX)
+				max = DISK_READ_MAX;
+			cnt = sector_run (inode, sector_idx, offset, max);
+			chunk_size = cnt * DISK_SECTOR_SIZE;
+			if (room >= DISK_SECTOR_SIZE) {
+				disk_readv_multi (filesys_disk, sector_idx, cnt, it.iov,
+						it.ofs);
+				iter_skip (&it, chunk_size);
+			} else {
+				disk_read_multi (filesys_disk, sector_idx, cnt, bounce);
+				iter_copy_out (&it, bounce, chunk_size);
+			}
 		} else {
 			/* Read sector into bounce buffer, then partially copy
 			 * into caller's buffer. */
-			if (bounce == NULL) {
-				bounce = malloc (DISK_SECTOR_SIZE);
-				if (bounce == NULL)
-					break;
-			}
 			disk_read (filesys_disk, sector_idx, bounce);
-			memcpy (buffer + bytes_read, bounce + sector_ofs, chunk_size);
+			iter_copy_out (&it, bounce + sector_ofs, chunk_size);
 		}
 
 		/* Advance. */
@@ -229,7 +407,8 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset) {
 		offset += chunk_size;
 		bytes_read += chunk_size;
 	}
-	free (bounce);
+	if (bounce != NULL)
+		palloc_free_page (bounce);
 
 	return bytes_read;
 }
@@ -240,9 +419,23 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset) {
  * (Normally a write at end of file would extend the inode, but
  * growth is not yet implemented.) */
 off_t
-inode_write_at (struct inode *inode, const void *buffer_, off_t size,
+inode_write_at (struct inode *inode, const void *buffer, off_t size,
+		off_t offset) {
+	struct iovec iov = { (void *) buffer, size };
+
+	return inode_write_iov (inode, &iov, 1, offset);
+}
+
+/* Writes the IOVCNT buffers in IOV, one after another, into INODE,
+ * starting at OFFSET.  Returns the number of bytes actually
+ * written, which may be less than their total length if end of
+ * file is reached or an error occurs.  Consecutive full sectors
+ * are written together, as inode_read_iov() reads them. */
+off_t
+inode_write_iov (struct inode *inode, const struct iovec *iov, int iovcnt,
 		off_t offset) {
-	const uint8_t *buffer = buffer_;
+	struct iov_iter it = { iov, iovcnt, 0 };
+	size_t size = iov_length (iov, iovcnt);
 	off_t bytes_written = 0;
 	uint8_t *bounce = NULL;
 
@@ -260,21 +453,44 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 		int min_left = inode_left < sector_left ? inode_left : sector_left;
 
 		/* Number of bytes to actually write into this sector. */
-		int chunk_size = size < min_left ? size : min_left;
-		if (chunk_size <= 0)
+		if (min_left <= 0)
 			break;
+		int chunk_size = size < (size_t) min_left ? (int) size : min_left;
+
+		/* We need a bounce buffer unless the caller's buffer can go
+		 * straight to disk. */
+		if (bounce == NULL
+				&& (sector_ofs != 0 || chunk_size != DISK_SECTOR_SIZE
+					|| iter_direct (&it) < DISK_SECTOR_SIZE)) {
+			bounce = palloc_get_page (0);
+			if (bounce == NULL)
+				break;
+		}
 
 		if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE) {
-			/* Write full sector directly to disk. */
-			disk_write (filesys_disk, sector_idx, buffer + bytes_written); 
-		} else {
-			/* We need a bounce buffer. */
-			if (bounce == NULL) {
-				bounce = malloc (DISK_SECTOR_SIZE);
-				if (bounce == NULL)
-					break;
+			/* Write full sectors, as many as are consecutive on
+			 * disk, in one request. */
+			size_t room = iter_direct (&it);
+			size_t max = room >= DISK_SECTOR_SIZE
+				? room / DISK_SECTOR_SIZE : BOUNCE_SECTORS;
+			size_t left = (size < (size_t) inode_left
+				? size : (size_t) inode_left) / DISK_SECTOR_SIZE;
+			size_t cnt;
+
+			if (max > left)
+				max = left;
+			if (max > DISK_READ_MAX)
+				max = DISK_READ_MAX;
+			cnt = sector_run (inode, sector_idx, offset, max);
+			chunk_size = cnt * DISK_SECTOR_SIZE;
+			if (room >= DISK_SECTOR_SIZE) {
+				disk_write_multi (filesys_disk, sector_idx, cnt, iter_ptr (&it));
+				it.ofs += chunk_size;
+			} else {
+				iter_copy_in (&it, bounce, chunk_size);
+				disk_write_multi (filesys_disk, sector_idx, cnt, bounce);
 			}
-
+		} else {
 			/* If the sector contains data before or after the chunk
 			   we're writing, then we need to read in the sector
 			   first.  Otherwise we start with a sector of all zeros. */
@@ -282,7 +498,7 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 				disk_read (filesys_disk, sector_idx, bounce);
 			else
 				memset (bounce, 0, DISK_SECTOR_SIZE);
-			memcpy (bounce + sector_ofs, buffer + bytes_written, chunk_size);
+			iter_copy_in (&it, bounce + sector_ofs, chunk_size);
 			disk_write (filesys_disk, sector_idx, bounce); 
 		}
 
@@ -291,11 +507,73 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 		offset += chunk_size;
 		bytes_written += chunk_size;
 	}
-	free (bounce);
+	if (bounce != NULL)
+		palloc_free_page (bounce);
 
 	return bytes_written;
 }
 
+/* Pages in the buffer inode_copy_range() tries to allocate. */
+#define COPY_PAGES 8
+
+/* Copies SIZE bytes from SRC, starting at SRC_OFS, to DST, starting
+ * at DST_OFS, inside the kernel.  Returns the number of bytes
+ * copied, which may be less than SIZE if end of file is reached in
+ * either inode or writes to DST are denied.  The two ranges must
+ * not overlap if SRC and DST are the same inode.
+ *
+ * The data goes through a kernel buffer of up to COPY_PAGES pages.
+ * When the two offsets are equally aligned within a sector, only
+ * the first chunk is cut short, up to a sector boundary, so that
+ * every later chunk is whole sectors on both sides and is read and
+ * written with one disk command per run of consecutive sectors. */
+off_t
+inode_copy_range (struct inode *dst, off_t dst_ofs, struct inode *src,
+		off_t src_ofs, off_t size) {
+	size_t buf_size = COPY_PAGES * PGSIZE;
+	uint8_t *buf = palloc_get_multiple (0, COPY_PAGES);
+	off_t bytes_copied = 0;
+
+	if (buf == NULL) {
+		buf = palloc_get_page (0);
+		buf_size = PGSIZE;
+		if (buf == NULL)
+			return 0;
+	}
+
+	while (size > 0) {
+		off_t chunk = size < (off_t) buf_size ? size : (off_t) buf_size;
+		int head = src_ofs % DISK_SECTOR_SIZE;
+		off_t n;
+
+		/* 두 오프셋의 섹터 안 위치가 같으면 첫 덩어리만 섹터 경계까지
+		 * 자른다 */
+		if (head != 0 && head == dst_ofs % DISK_SECTOR_SIZE
+				&& chunk > DISK_SECTOR_SIZE - head)
+			chunk = DISK_SECTOR_SIZE - head;
+
+		n = inode_read_at (src, buf, chunk, src_ofs);
+		if (n <= 0)
+			break;
+		n = inode_write_at (dst, buf, n, dst_ofs);
+		if (n <= 0)
+			break;
+
+		size -= n;
+		src_ofs += n;
+		dst_ofs += n;
+		bytes_copied += n;
+		if (n < chunk)
+			break;
+	}
+	if (buf_size == PGSIZE)
+		palloc_free_page (buf);
+	else
+		palloc_free_multiple (buf, COPY_PAGES);
+
+	return bytes_copied;
+}
+
 /* Disables writes to INODE.
    May be called at most once per inode opener. */
 	void
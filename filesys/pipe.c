@@ -0,0 +1,185 @@
+#include "filesys/pipe.h"
+#include <debug.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Bytes in a pipe's ring buffer. */
+#define PIPE_SIZE (PIPE_PAGES * PGSIZE)
+
+/* A pipe.  Its ends are struct files that point here; every
+ * duplicate of an end, made by fork(), counts as another end. */
+struct pipe {
+	struct lock lock;           /* Guards everything below. */
+	struct condition readable;  /* Data arrived or the last writer left. */
+	struct condition writable;  /* Room freed up or the last reader left. */
+	uint8_t *buf;               /* Ring buffer, PIPE_SIZE bytes. */
+	size_t head;                /* Bytes ever read; counts up freely. */
+	size_t tail;                /* Bytes ever written; counts up freely. */
+	int readers;                /* Open read ends. */
+	int writers;                /* Open write ends. */
+};
+
+/* Returns a new end of PIPE, for writing if WRITER is true, or a
+ * null pointer if memory is short.  The caller holds PIPE's lock
+ * unless no one else can see PIPE yet. */
+static struct file *
+open_end (struct pipe *pipe, bool writer) {
+	struct file *end = calloc (1, sizeof *end);
+
+	if (end != NULL) {
+		end->pipe = pipe;
+		end->pipe_writer = writer;
+		if (writer)
+			pipe->writers++;
+		else
+			pipe->readers++;
+	}
+	return end;
+}
+
+/* Creates a pipe and stores its two ends in *READ_END and
+ * *WRITE_END.  Returns false if memory is short. */
+bool
+pipe_create (struct file **read_end, struct file **write_end) {
+	struct pipe *pipe = malloc (sizeof *pipe);
+
+	if (pipe == NULL)
+		return false;
+	pipe->buf = palloc_get_multiple (0, PIPE_PAGES);
+	if (pipe->buf == NULL) {
+		free (pipe);
+		return false;
+	}
+	lock_init (&pipe->lock);
+	cond_init (&pipe->readable);
+	cond_init (&pipe->writable);
+	pipe->head = pipe->tail = 0;
+	pipe->readers = pipe->writers = 0;
+
+	*read_end = open_end (pipe, false);
+	*write_end = open_end (pipe, true);
+	if (*read_end == NULL || *write_end == NULL) {
+		free (*read_end);
+		free (*write_end);
+		palloc_free_multiple (pipe->buf, PIPE_PAGES);
+		free (pipe);
+		return false;
+	}
+	return true;
+}
+
+/* Returns another end of the same pipe, and of the same kind, as
+ * END, or a null pointer if memory is short. */
+struct file *
+pipe_reopen (struct file *end) {
+	struct pipe *pipe = end->pipe;
+	struct file *nend;
+
+	lock_acquire (&pipe->lock);
+	nend = open_end (pipe, end->pipe_writer);
+	lock_release (&pipe->lock);
+	return nend;
+}
+
+/* Closes END, but does not free it.  Wakes up the other side if
+ * this was its last peer, and frees the pipe with its last end. */
+void
+pipe_close (struct file *end) {
+	struct pipe *pipe = end->pipe;
+	bool last;
+
+	lock_acquire (&pipe->lock);
+	if (end->pipe_writer) {
+		if (--pipe->writers == 0)
+			cond_broadcast (&pipe->readable, &pipe->lock);
+	} else {
+		if (--pipe->readers == 0)
+			cond_broadcast (&pipe->writable, &pipe->lock);
+	}
+	last = pipe->readers == 0 && pipe->writers == 0;
+	lock_release (&pipe->lock);
+
+	if (last) {
+		palloc_free_multiple (pipe->buf, PIPE_PAGES);
+		free (pipe);
+	}
+}
+
+/* Reads up to SIZE bytes from read end END into BUFFER, waiting
+ * until there is at least one byte or no writer is left.  Returns
+ * the bytes read, which is 0 at end of file or if SIZE is 0, or -1
+ * if END is a write end. */
+off_t
+pipe_read (struct file *end, void *buffer, off_t size) {
+	struct pipe *pipe = end->pipe;
+	size_t n, ofs, run;
+
+	if (end->pipe_writer || size < 0)
+		return -1;
+	/* 읽을 것이 없으니 쓰는 쪽을 기다리지 않는다 */
+	if (size == 0)
+		return 0;
+
+	lock_acquire (&pipe->lock);
+	while (pipe->head == pipe->tail && pipe->writers > 0)
+		cond_wait (&pipe->readable, &pipe->lock);
+
+	n = pipe->tail - pipe->head;
+	if (n > (size_t) size)
+		n = size;
+	/* At most two runs: up to the end of the ring, then from its start. */
+	ofs = pipe->head % PIPE_SIZE;
+	run = n < PIPE_SIZE - ofs ? n : PIPE_SIZE - ofs;
+	memcpy (buffer, pipe->buf + ofs, run);
+	memcpy ((uint8_t *) buffer + run, pipe->buf, n - run);
+	pipe->head += n;
+	if (n > 0)
+		cond_broadcast (&pipe->writable, &pipe->lock);
+	lock_release (&pipe->lock);
+	return n;
+}
+
+/* Writes SIZE bytes from BUFFER to write end END, waiting for room
+ * as needed.  A write of up to PIPE_BUF bytes waits until it fits
+ * whole; a longer one waits for a page of room at a time, so a fast
+ * writer and a slow reader trade whole pages instead of a few bytes
+ * per wakeup.
+ * Returns the bytes written, which is less than SIZE only if every
+ * read end was closed, or -1 if nothing could be written. */
+off_t
+pipe_write (struct file *end, const void *buffer, off_t size) {
+	struct pipe *pipe = end->pipe;
+	off_t written = 0;
+
+	if (!end->pipe_writer || size < 0)
+		return -1;
+
+	lock_acquire (&pipe->lock);
+	while (written < size && pipe->readers > 0) {
+		size_t left = size - written;
+		size_t want = left < PIPE_BUF ? left : PIPE_BUF;
+		size_t room, n, ofs, run;
+
+		while (PIPE_SIZE - (pipe->tail - pipe->head) < want
+				&& pipe->readers > 0)
+			cond_wait (&pipe->writable, &pipe->lock);
+		if (pipe->readers == 0)
+			break;
+
+		room = PIPE_SIZE - (pipe->tail - pipe->head);
+		n = left < room ? left : room;
+		ofs = pipe->tail % PIPE_SIZE;
+		run = n < PIPE_SIZE - ofs ? n : PIPE_SIZE - ofs;
+		memcpy (pipe->buf + ofs, (const uint8_t *) buffer + written, run);
+		memcpy (pipe->buf, (const uint8_t *) buffer + written + run, n - run);
+		pipe->tail += n;
+		written += n;
+		cond_broadcast (&pipe->readable, &pipe->lock);
+	}
+	lock_release (&pipe->lock);
+	return written > 0 || size == 0 ? written : -1;
+}
@@ -2,7 +2,9 @@
 #define DEVICES_DISK_H
 
 #include <inttypes.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <uio.h>
 
 /* Size of a disk sector in bytes. */
 #define DISK_SECTOR_SIZE 512
@@ -15,13 +17,22 @@ typedef uint32_t disk_sector_t;
  * printf ("sector=%"PRDSNu"\n", sector); */
 #define PRDSNu PRIu32
 
+/* Most sectors disk_read_multi(), disk_readv_multi() or
+ * disk_write_multi() transfers at once. */
+#define DISK_READ_MAX 256
+
 void disk_init (void);
 void disk_print_stats (void);
 
 struct disk *disk_get (int chan_no, int dev_no);
 disk_sector_t disk_size (struct disk *);
 void disk_read (struct disk *, disk_sector_t, void *);
+void disk_read_multi (struct disk *, disk_sector_t, size_t cnt, void *);
+void disk_readv_multi (struct disk *, disk_sector_t, size_t cnt,
+		const struct iovec *, size_t ofs);
 void disk_write (struct disk *, disk_sector_t, const void *);
+void disk_write_multi (struct disk *, disk_sector_t, size_t cnt,
+		const void *);
 
 void 	register_disk_inspect_intr ();
 #endif /* devices/disk.h */
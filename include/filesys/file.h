@@ -3,15 +3,19 @@
 
 #include "filesys/off_t.h"
 #include <stdbool.h>
+#include <uio.h>
 /* An open file. */
 struct file {
 	struct inode *inode;        /* File's inode. */
 	off_t pos;                  /* Current position. */
 	bool deny_write;            /* Has file_deny_write() been called? */
 	int dup_count;				// 0일때만 close
+	struct pipe *pipe;          /* Pipe this is an end of, or null. */
+	bool pipe_writer;           /* Write end of PIPE? */
 };
 
 struct inode;
+struct pipe;
 
 /* Opening and closing files. */
 struct file *file_open (struct inode *);
@@ -19,12 +23,17 @@ struct file *file_reopen (struct file *);
 struct file *file_duplicate (struct file *file);
 void file_close (struct file *);
 struct inode *file_get_inode (struct file *);
+bool file_is_pipe (struct file *);
 
 /* Reading and writing. */
 off_t file_read (struct file *, void *, off_t);
 off_t file_read_at (struct file *, void *, off_t size, off_t start);
 off_t file_write (struct file *, const void *, off_t);
 off_t file_write_at (struct file *, const void *, off_t size, off_t start);
+off_t file_readv_at (struct file *, const struct iovec *, int iovcnt,
+		off_t start);
+off_t file_writev_at (struct file *, const struct iovec *, int iovcnt,
+		off_t start);
 
 /* Preventing writes. */
 void file_deny_write (struct file *);
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include "filesys/off_t.h"
 #include "devices/disk.h"
+#include <uio.h>
 
 struct bitmap;
 
@@ -16,6 +17,12 @@ void inode_close (struct inode *);
 void inode_remove (struct inode *);
 off_t inode_read_at (struct inode *, void *, off_t size, off_t offset);
 off_t inode_write_at (struct inode *, const void *, off_t size, off_t offset);
+off_t inode_read_iov (struct inode *, const struct iovec *, int iovcnt,
+		off_t offset);
+off_t inode_write_iov (struct inode *, const struct iovec *, int iovcnt,
+		off_t offset);
+off_t inode_copy_range (struct inode *dst, off_t dst_ofs, struct inode *src,
+		off_t src_ofs, off_t size);
 void inode_deny_write (struct inode *);
 void inode_allow_write (struct inode *);
 off_t inode_length (const struct inode *);
@@ -0,0 +1,22 @@
+#ifndef FILESYS_PIPE_H
+#define FILESYS_PIPE_H
+
+#include <stdbool.h>
+#include "filesys/off_t.h"
+
+struct file;
+
+/* Pages in each pipe's ring buffer. */
+#define PIPE_PAGES 4
+
+/* Writes of at most this many bytes are not interleaved with other
+ * writes to the same pipe. */
+#define PIPE_BUF 4096
+
+bool pipe_create (struct file **read_end, struct file **write_end);
+struct file *pipe_reopen (struct file *end);
+void pipe_close (struct file *end);
+off_t pipe_read (struct file *end, void *buffer, off_t size);
+off_t pipe_write (struct file *end, const void *buffer, off_t size);
+
+#endif /* filesys/pipe.h */
@@ -0,0 +1,34 @@
+#ifndef __LIB_FAULTSTAT_H
+#define __LIB_FAULTSTAT_H
+
+/* Kinds of page faults. */
+enum fault_type {
+	FAULT_LAZY,                 /* First touch of an executable page. */
+	FAULT_ZERO,                 /* First touch of an anonymous page. */
+	FAULT_STACK,                /* Stack growth. */
+	FAULT_SWAP,                 /* Anonymous page back from swap. */
+	FAULT_FILE,                 /* Page of an mmap'd file. */
+	FAULT_COW,                  /* Write to a zero or merged page. */
+	FAULT_SHM,                  /* Page of a shared memory segment. */
+	FAULT_INVALID,              /* Not handled: the process dies. */
+	FAULT_TYPE_CNT
+};
+
+/* Latency histogram buckets.  Bucket I counts faults that took
+ * from 2**I to 2**(I + 1) - 1 TSC cycles; the last also counts all
+ * slower ones. */
+#define FAULT_HIST_CNT 32
+
+/* Which faults faultstat() reports. */
+#define FAULTSTAT_SELF 0        /* The calling process's. */
+#define FAULTSTAT_ALL 1         /* Every process's since boot. */
+
+/* Page fault counts and latencies, as filled in by faultstat(). */
+struct faultstat {
+	long long count[FAULT_TYPE_CNT];            /* Faults. */
+	long long cycles[FAULT_TYPE_CNT];           /* Total TSC cycles. */
+	long long max[FAULT_TYPE_CNT];              /* Slowest, in cycles. */
+	unsigned hist[FAULT_TYPE_CNT][FAULT_HIST_CNT];
+};
+
+#endif /* lib/faultstat.h */
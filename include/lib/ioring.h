@@ -0,0 +1,55 @@
+#ifndef __LIB_IORING_H
+#define __LIB_IORING_H
+
+#include <stdint.h>
+
+/* Most entries in each queue of a ring. */
+#define IORING_MAX_ENTRIES 64
+
+/* Most bytes in a ring's buffer area. */
+#define IORING_MAX_BUF (64 * 4096)
+
+/* Operations a submission may ask for. */
+enum ioring_op {
+	IORING_OP_NOP,              /* Do nothing. */
+	IORING_OP_READ,             /* Read from a file into the buffer area. */
+	IORING_OP_WRITE,            /* Write to a file from the buffer area. */
+	IORING_OP_FSYNC,            /* Complete after all earlier requests. */
+};
+
+/* A submission queue entry. */
+struct ioring_sqe {
+	uint8_t opcode;             /* An enum ioring_op. */
+	int32_t fd;                 /* File to read or write. */
+	int32_t off;                /* Offset in the file. */
+	uint32_t len;               /* Bytes to transfer. */
+	void *buf;                  /* Where, within the buffer area. */
+	uint64_t user_data;         /* Handed back in the completion. */
+};
+
+/* A completion queue entry. */
+struct ioring_cqe {
+	uint64_t user_data;         /* From the submission. */
+	int32_t res;                /* Bytes transferred, or -1. */
+	uint32_t pad;
+};
+
+/* The first page of a ring set up by ioring_setup().  The process
+ * fills submission entries and advances sq_tail, and consumes
+ * completions and advances cq_head; the kernel advances the other
+ * two.  Each index counts up freely and is taken modulo ENTRIES.
+ * The kernel only takes a submission when the completion queue has
+ * room for its result, so completions are never lost. */
+struct ioring {
+	volatile uint32_t sq_head;  /* Next submission the kernel takes. */
+	volatile uint32_t sq_tail;  /* Next submission the process fills. */
+	volatile uint32_t cq_head;  /* Next completion the process reads. */
+	volatile uint32_t cq_tail;  /* Next completion the kernel fills. */
+	uint32_t entries;           /* Size of each queue, a power of 2. */
+	uint32_t buf_size;          /* Bytes in the buffer area. */
+	void *buf;                  /* Buffer area, in the pages after this. */
+	struct ioring_sqe sqes[IORING_MAX_ENTRIES];
+	struct ioring_cqe cqes[IORING_MAX_ENTRIES];
+};
+
+#endif /* lib/ioring.h */
@@ -0,0 +1,54 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue (min-heap).
+ *
+ * This is a leftist heap.  Like list.h and hash.h, it is
+ * intrusive: each structure that can be in a heap embeds a
+ * struct heap_elem, and heap_entry() converts a struct heap_elem
+ * back to the structure that contains it.  No memory is
+ * allocated, so a heap may be used with interrupts off.
+ *
+ * Push and pop take O(lg n) time.  Elements that compare equal
+ * come out in no particular order. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem {
+	struct heap_elem *left;     /* Left child. */
+	struct heap_elem *right;    /* Right child, the shorter side. */
+	int rank;                   /* Length of the right spine. */
+};
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)           \
+	((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->left     \
+		- offsetof (STRUCT, MEMBER.left)))
+
+/* Returns true if A must come out of the heap before B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+                             const struct heap_elem *b,
+                             void *aux);
+
+/* Heap. */
+struct heap {
+	struct heap_elem *root;     /* Minimum element. */
+	size_t size;                /* Number of elements. */
+	heap_less_func *less;       /* Comparison function. */
+	void *aux;                  /* Auxiliary data for `less'. */
+};
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+void heap_push (struct heap *, struct heap_elem *);
+struct heap_elem *heap_min (const struct heap *);
+struct heap_elem *heap_pop (struct heap *);
+size_t heap_size (const struct heap *);
+bool heap_empty (const struct heap *);
+
+#endif /* lib/kernel/heap.h */
@@ -0,0 +1,17 @@
+#ifndef __LIB_RUSAGE_H
+#define __LIB_RUSAGE_H
+
+/* Memory use of a process, as filled in by getrusage().  Counts
+ * are in pages. */
+struct rusage {
+	long ru_rss;                /* Pages resident in memory. */
+	long ru_maxrss;             /* Most pages ever resident. */
+	long ru_swap;               /* Pages in swap. */
+	long ru_file;               /* Resident pages of mmap'd files. */
+	long ru_ws;                 /* Working set: pages referenced during
+	                               the last revolution of the clock. */
+	long long ru_minflt;        /* Page faults served without I/O. */
+	long long ru_majflt;        /* Page faults that read the disk. */
+};
+
+#endif /* lib/rusage.h */
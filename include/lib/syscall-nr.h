@@ -33,9 +33,35 @@ enum {
 
 	/* Extra for Project 2 */
 	SYS_DUP2,                   /* Duplicate the file descriptor */
+	SYS_PIPE,                   /* Create a pipe. */
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Scheduling. */
+	SYS_SET_TICKETS,            /* Set stride scheduling tickets. */
+
+	/* Virtual memory. */
+	SYS_MSYNC,                  /* Write back a memory mapping. */
+	SYS_MADVISE,                /* Give a hint on memory access. */
+	SYS_GETRUSAGE,              /* Report memory use. */
+	SYS_FAULTSTAT,              /* Report page fault statistics. */
+
+	/* Positioned and vectored I/O. */
+	SYS_PREAD,                  /* Read from a position in a file. */
+	SYS_PWRITE,                 /* Write to a position in a file. */
+	SYS_READV,                  /* Read into several buffers. */
+	SYS_WRITEV,                 /* Write from several buffers. */
+	SYS_COPY_FILE_RANGE,        /* Copy between files in the kernel. */
+
+	/* Asynchronous I/O. */
+	SYS_IORING_SETUP,           /* Map a submission/completion ring. */
+	SYS_IORING_ENTER,           /* Submit to a ring and wait on it. */
+
+	/* Shared memory. */
+	SYS_SHM_CREATE,             /* Create a shared memory segment. */
+	SYS_SHM_ATTACH,             /* Map a segment into this process. */
+	SYS_SHM_DETACH,             /* Unmap a segment. */
 };
 
 #endif /* lib/syscall-nr.h */
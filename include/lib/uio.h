@@ -0,0 +1,16 @@
+#ifndef __LIB_UIO_H
+#define __LIB_UIO_H
+
+#include <stddef.h>
+
+/* One buffer of a scattered read or gathered write, as passed to
+ * readv() and writev(). */
+struct iovec {
+	void *iov_base;             /* Start of the buffer. */
+	size_t iov_len;             /* Its length in bytes. */
+};
+
+/* Most buffers readv() or writev() accepts. */
+#define IOV_MAX 16
+
+#endif /* lib/uio.h */
@@ -4,6 +4,10 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <faultstat.h>
+#include <ioring.h>
+#include <rusage.h>
+#include <uio.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -13,6 +17,14 @@ typedef int pid_t;
 typedef int off_t;
 #define MAP_FAILED ((void *) NULL)
 
+/* Access hints for madvise(). */
+#define MADV_NORMAL     0       /* No hint. */
+#define MADV_RANDOM     1       /* No read-ahead. */
+#define MADV_SEQUENTIAL 2       /* Read far ahead, drop pages behind. */
+#define MADV_WILLNEED   3       /* Start reading the range in now. */
+#define MADV_DONTNEED   4       /* Drop the range now; it reads back as
+                                   zeros unless mapped from a file. */
+
 /* Maximum characters in a filename written by readdir(). */
 #define READDIR_MAX_LEN 14
 
@@ -37,10 +49,31 @@ unsigned tell (int fd);
 void close (int fd);
 
 int dup2(int oldfd, int newfd);
+int pipe (int fds[2]);
+
+/* Positioned and vectored I/O. */
+int pread (int fd, void *buffer, unsigned length, off_t offset);
+int pwrite (int fd, const void *buffer, unsigned length, off_t offset);
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+int copy_file_range (int fd_in, off_t *off_in, int fd_out, off_t *off_out,
+		unsigned length);
+
+/* Scheduling. */
+int set_tickets (int tickets);
 
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
+int msync (void *addr, size_t length);
+int madvise (void *addr, size_t length, int advice);
+int getrusage (struct rusage *usage);
+int faultstat (int who, struct faultstat *stats);
+int ioring_setup (void *addr, unsigned entries, size_t buf_size);
+int ioring_enter (struct ioring *ring, unsigned min_complete);
+int shm_create (size_t size);
+void *shm_attach (int id, void *addr);
+int shm_detach (void *addr);
 
 /* Project 4 only. */
 bool chdir (const char *dir);
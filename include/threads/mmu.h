@@ -5,13 +5,21 @@
 #include <stdint.h>
 #include "threads/pte.h"
 
+/* If true, address spaces are not tagged with PCIDs.
+   Controlled by kernel command-line option "-no-pcid". */
+extern bool pcid_disabled;
+
 typedef bool pte_for_each_func (uint64_t *pte, void *va, void *aux);
 
 uint64_t *pml4e_walk (uint64_t *pml4, const uint64_t va, int create);
 uint64_t *pml4_create (void);
+bool pml4_set_large_page (uint64_t *pml4, uint64_t va, uint64_t pa,
+		uint64_t flags);
 bool pml4_for_each (uint64_t *, pte_for_each_func *, void *);
 void pml4_destroy (uint64_t *pml4);
 void pml4_activate (uint64_t *pml4);
+void pml4_init_pcid (void);
+void pml4_print_stats (void);
 void *pml4_get_page (uint64_t *pml4, const void *upage);
 bool pml4_set_page (uint64_t *pml4, void *upage, void *kpage, bool rw);
 void pml4_clear_page (uint64_t *pml4, void *upage);
@@ -41,5 +41,12 @@
 #define PTE_U 0x4                        /* 1=user/kernel, 0=kernel only. */
 #define PTE_A 0x20                       /* 1=accessed, 0=not acccessed. */
 #define PTE_D 0x40                       /* 1=dirty, 0=not dirty (PTEs only). */
+#define PTE_PS 0x80                      /* 1=large page (PDEs and PDPEs only). */
+
+/* A PDE with PTE_PS set maps a 2 MiB page directly, and a PDPE
+   with PTE_PS set a 1 GiB page.  In a PTE the same bit selects a
+   memory type (PAT), which we never use. */
+#define LPGSIZE (1UL << PDXSHIFT)        /* Bytes in a 2 MiB page. */
+#define HPGSIZE (1UL << PDPESHIFT)       /* Bytes in a 1 GiB page. */
 
 #endif /* threads/pte.h */
@@ -0,0 +1,34 @@
+#ifndef THREADS_SCHEDTRACE_H
+#define THREADS_SCHEDTRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Scheduler events recorded in the trace ring.  The value of each
+   event is the character written for it in a dump, see
+   utils/schedtrace-report. */
+enum sched_event_type {
+	SCHED_CREATE = 'C',     /* TID created by thread ARG. */
+	SCHED_SWITCH = 'S',     /* TID switched out, thread ARG switched in. */
+	SCHED_BLOCK = 'B',      /* TID blocked itself. */
+	SCHED_UNBLOCK = 'U',    /* TID made ready by thread ARG. */
+	SCHED_YIELD = 'Y',      /* TID yielded or was preempted. */
+	SCHED_DONATE = 'D',     /* TID donated its priority to thread ARG. */
+	SCHED_SLEEP = 'L',      /* TID went to sleep until tick ARG. */
+	SCHED_WAKE = 'W',       /* TID woken up at tick ARG. */
+	SCHED_EXIT = 'X',       /* TID exited. */
+};
+
+/* Upper bound on the length of one dumped event line. */
+#define SCHEDTRACE_LINE_MAX 64
+
+/* -schedtrace: dump the trace at power off. */
+extern bool schedtrace_dump;
+
+void schedtrace_record (enum sched_event_type, int tid, int64_t arg);
+size_t schedtrace_format (char *buf, size_t size);
+size_t schedtrace_format_size (void);
+void schedtrace_print (void);
+
+#endif /* threads/schedtrace.h */
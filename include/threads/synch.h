@@ -3,6 +3,7 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* A counting semaphore. */
 struct semaphore {
@@ -23,6 +24,11 @@ void sema_self_test (void);
 struct lock {
 	struct thread *holder;      /* Thread holding lock (for debugging). */
 	struct semaphore semaphore; /* Binary semaphore controlling access. */
+#ifdef LOCKSTAT
+	const char *class;          /* Where the lock was initialized. */
+	struct lockstat *stat;      /* Statistics of current acquisition. */
+	uint64_t acquire_tsc;       /* When the holder acquired it. */
+#endif
 };
 
 // lock 자료 구조를 초기화
@@ -34,6 +40,25 @@ bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
 
+#ifdef LOCKSTAT
+/* Lock contention statistics, enabled by adding -DLOCKSTAT to
+   CFLAGS (see Make.config).  Locks are told apart by the place
+   they were initialized at, and acquisitions by the place they
+   were made from. */
+#define LOCKSTAT_STR_(X) #X
+#define LOCKSTAT_STR(X) LOCKSTAT_STR_ (X)
+#define LOCKSTAT_SITE __FILE__ ":" LOCKSTAT_STR (__LINE__)
+
+void lock_init_at (struct lock *, const char *class);
+void lock_acquire_at (struct lock *, const char *site);
+bool lock_try_acquire_at (struct lock *, const char *site);
+void lockstat_print_stats (void);
+
+#define lock_init(LOCK) lock_init_at (LOCK, LOCKSTAT_SITE)
+#define lock_acquire(LOCK) lock_acquire_at (LOCK, LOCKSTAT_SITE)
+#define lock_try_acquire(LOCK) lock_try_acquire_at (LOCK, LOCKSTAT_SITE)
+#endif
+
 /* Condition variable. */
 struct condition {
 	struct list waiters;        /* List of waiting threads. */
@@ -7,6 +7,7 @@
 										 // 이를 분리하면 512byte (1<<9)만큼의 공간을 할당받는 것과 같다.
 										 // 즉, 파일 구조체를 저장하기 위해 4KB만큼의 페이지 공간을 할당해주는 것이다.
 #include <debug.h>
+#include <heap.h>
 #include <list.h>
 #include <stdint.h>
 #include "threads/interrupt.h"
@@ -34,6 +35,11 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
+/* Stride scheduling tickets. */
+#define TICKETS_MIN 1                   /* Fewest tickets. */
+#define TICKETS_DEFAULT 100             /* Default tickets. */
+#define TICKETS_MAX 10000               /* Most tickets. */
+
 /* A kernel thread or user process.
  *
  * Each thread structure is stored in its own 4 kB page.  The
@@ -112,6 +118,13 @@ struct thread {
 										이 element를 통해 자신이 우선 순위를 donate한 쓰레드의 donates 리스트에 연결*/
 	
 	uintptr_t *stack_rsp;
+
+	/* Stride scheduling (-stride). */
+	int tickets;                        /* Share of the CPU. */
+	int64_t stride;                     /* Pass increment per tick, for its
+	                                       own and borrowed tickets. */
+	int64_t pass;                       /* Virtual time; lowest runs next. */
+	struct heap_elem stride_elem;       /* Element in the stride run queue. */
 #ifdef USERPROG
 	/* Owned by userprog/process.c. */
 	uint64_t *pml4;                     /* Page map level 4 */
@@ -120,6 +133,8 @@ struct thread {
 	/* Table for whole virtual memory owned by thread. */
 	/* 스레드가 소유한 전체 가상 메모리에 대한 테이블입니다. */
 	struct supplemental_page_table spt;
+	struct vm_usage usage;              /* Memory use; see vm_account(). */
+	struct ioring_ctx *iorings;         /* Rings; see vm/ioring.c. */
 	// void *stack_bottom;
 #endif
 
@@ -152,6 +167,15 @@ struct thread {
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, use the proportional-share stride scheduler, where
+   each thread gets CPU time in proportion to its tickets.
+   Priorities are ignored then: a thread waiting on a lock lends
+   its tickets to the holder instead of donating its priority, and
+   the kernel's own threads set their tickets where they would
+   otherwise rely on their priority.
+   Controlled by kernel command-line option "-stride". */
+extern bool thread_stride;
+
 void thread_init (void);
 void thread_start (void);
 
@@ -174,6 +198,10 @@ void thread_yield (void);
 int thread_get_priority (void);
 void thread_set_priority (int);
 
+int thread_get_tickets (void);
+void thread_set_tickets (int);
+void thread_update_stride (struct thread *);
+
 int thread_get_nice (void);
 void thread_set_nice (int);
 int thread_get_recent_cpu (void);
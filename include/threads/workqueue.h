@@ -0,0 +1,54 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "threads/synch.h"
+
+/* Function run by a worker thread for a work item. */
+typedef void work_func (void *aux);
+
+/* A deferred unit of work.  Owned by the caller, which must keep
+   it alive until it has run or has been cancelled. */
+struct work {
+	work_func *func;            /* Function to run. */
+	void *aux;                  /* Argument to FUNC. */
+	int priority;               /* Higher priority work runs first. */
+	int64_t expires;            /* Tick at which delayed work is queued. */
+	bool pending;               /* Queued or delayed, not yet started. */
+	struct workqueue *wq;       /* Queue it is pending on. */
+	struct list_elem elem;      /* Pending or delayed list element. */
+};
+
+/* Maximum number of items a worker takes off a queue at once. */
+#define WORKQUEUE_BATCH_MAX 16
+
+/* A queue of work served by a fixed pool of worker threads. */
+struct workqueue {
+	char name[16];              /* Name, also used for the workers. */
+	struct list pending;        /* Ready work, highest priority first. */
+	struct semaphore wakeup;    /* Upped once per queued item. */
+	int workers;                /* Number of worker threads. */
+	int batch;                  /* Items taken per wakeup. */
+	int active;                 /* Workers currently running work. */
+	int flush_waiters;          /* Threads in workqueue_flush(). */
+	struct semaphore flushed;   /* Upped when the queue drains. */
+};
+
+/* Shared queue for work that does not need a queue of its own. */
+extern struct workqueue *system_wq;
+
+void workqueue_init (void);
+struct workqueue *workqueue_create (const char *name, int workers,
+		int priority, int batch);
+void workqueue_flush (struct workqueue *);
+
+void work_init (struct work *, work_func *, void *aux, int priority);
+bool queue_work (struct workqueue *, struct work *);
+bool queue_delayed_work (struct workqueue *, struct work *, int64_t ticks);
+bool cancel_work (struct work *);
+
+void workqueue_tick (int64_t ticks);
+
+#endif /* threads/workqueue.h */
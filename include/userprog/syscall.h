@@ -3,7 +3,10 @@
 
 // #include "userprog/process.h"
 
-// void syscall_init (void);
+// struct file;
+
+void syscall_init (void);
+struct file *get_regular_file (int fd);
 // /* project2 : system call */
 // void check_address(void *addr);
 // // struct lock filesys_lock;
@@ -15,7 +18,10 @@
 
 #include "threads/synch.h"
 
+struct file;
+
 void syscall_init (void);
+struct file *get_regular_file (int fd);
 
 struct lock filesys_lock;
 
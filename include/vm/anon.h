@@ -2,14 +2,22 @@
 #define VM_ANON_H
 #include "vm/vm.h"
 struct page;
+struct zswap_entry;
 enum vm_type;
 
 struct anon_page {
     int slot_number;
+    struct zswap_entry *zswap;  /* Compressed copy in memory, if any. */
     enum vm_type aux_type;
 };
 
 void vm_anon_init (void);
 bool anon_initializer (struct page *page, enum vm_type type, void *kva);
+void anon_swap_read (struct page *page, void *kva);
+bool anon_swap_discard (struct page *page);
+bool anon_swap_save (struct page *page, const void *kva);
+bool anon_swap_restore (struct page *page, void *kva);
+void anon_swap_drop (struct page *page);
+void swap_print_stats (void);
 
 #endif
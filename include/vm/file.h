@@ -1,10 +1,21 @@
 #ifndef VM_FILE_H
 #define VM_FILE_H
+#include <list.h>
 #include "filesys/file.h"
 #include "vm/vm.h"
 
 struct page;
+struct thread;
 enum vm_type;
+struct supplemental_page_table;
+
+/* A region mapped by mmap(). */
+struct mmap_region {
+	void *addr;                 /* First page of the region. */
+	size_t page_cnt;            /* Number of pages. */
+	struct file *file;          /* The region's own reopened file. */
+	struct list_elem elem;      /* supplemental_page_table's regions. */
+};
 
 struct file_page {
     struct file *file;
@@ -17,7 +28,10 @@ struct file_page {
 
 void vm_file_init (void);
 bool file_backed_initializer (struct page *page, enum vm_type type, void *kva);
+bool file_backed_clean (struct page *page, struct thread *t, void *kva);
 void *do_mmap(void *addr, size_t length, int writable,
 		struct file *file, off_t offset);
 void do_munmap (void *va);
+bool do_msync (void *addr, size_t length);
+void mmap_unmap_all (struct supplemental_page_table *spt);
 #endif
@@ -0,0 +1,13 @@
+#ifndef VM_IORING_H
+#define VM_IORING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+void ioring_init (void);
+bool ioring_create (void *addr, unsigned entries, size_t buf_size);
+int ioring_submit (void *addr, unsigned min_complete);
+void ioring_exit (void);
+void ioring_print_stats (void);
+
+#endif /* vm/ioring.h */
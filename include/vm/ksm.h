@@ -0,0 +1,18 @@
+#ifndef VM_KSM_H
+#define VM_KSM_H
+#include <stdbool.h>
+
+struct page;
+
+/* A read-only frame holding contents that several anonymous pages
+ * had in common, merged by the ksm thread and shared by all of
+ * them until they write to it. */
+struct ksm_frame;
+
+void ksm_init (void);
+void *ksm_kva (const struct ksm_frame *ksm);
+void ksm_unmap (struct page *page, bool unshare);
+void ksm_forget (struct page *page);
+void ksm_print_stats (void);
+
+#endif /* vm/ksm.h */
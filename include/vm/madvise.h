@@ -0,0 +1,37 @@
+#ifndef VM_MADVISE_H
+#define VM_MADVISE_H
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Access hints for madvise().  Must match lib/user/syscall.h. */
+#define MADV_NORMAL     0       /* No hint. */
+#define MADV_RANDOM     1       /* No read-ahead. */
+#define MADV_SEQUENTIAL 2       /* Read far ahead, drop pages behind. */
+#define MADV_WILLNEED   3       /* Start reading the range in now. */
+#define MADV_DONTNEED   4       /* Drop the range's frames now. */
+
+struct supplemental_page_table;
+
+/* A range of pages with a lasting access hint, MADV_RANDOM or
+ * MADV_SEQUENTIAL.  Pages in no region have MADV_NORMAL. */
+struct madvise_region {
+	void *start;                /* First page. */
+	void *end;                  /* Page past the last one. */
+	int advice;                 /* The hint. */
+	struct list_elem elem;      /* supplemental_page_table's advice. */
+};
+
+void madvise_init (void);
+bool do_madvise (void *addr, size_t length, int advice);
+const struct madvise_region *madvise_find (struct supplemental_page_table *spt,
+		const void *va);
+int madvise_get (struct supplemental_page_table *spt, const void *va);
+void madvise_clear (struct supplemental_page_table *spt, void *start,
+		void *end);
+bool madvise_copy (struct supplemental_page_table *dst,
+		struct supplemental_page_table *src);
+void madvise_destroy (struct supplemental_page_table *spt);
+void madvise_print_stats (void);
+
+#endif /* vm/madvise.h */
@@ -0,0 +1,26 @@
+#ifndef VM_SHM_H
+#define VM_SHM_H
+#include <stdbool.h>
+#include <stddef.h>
+
+struct page;
+
+/* A page of a process attached to a page of a shared memory
+ * segment. */
+struct shm_map;
+
+/* Most pages in one segment. */
+#define SHM_MAX_PAGES 256
+
+void shm_init (void);
+int shm_new (size_t size);
+void *shm_map_at (int id, void *addr);
+bool shm_unmap_at (void *addr);
+bool shm_copy (struct page *src);
+bool shm_fault (struct page *page, bool *io);
+bool shm_test_accessed (struct page *page);
+void shm_release (struct page *page);
+void shm_exit (void);
+void shm_print_stats (void);
+
+#endif /* vm/shm.h */
@@ -0,0 +1,42 @@
+#ifndef VM_TEXT_H
+#define VM_TEXT_H
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+struct frame;
+struct inode;
+struct page;
+
+/* A page of a read-only part of an executable, or of an mmap'd
+ * file, shared by every process that maps that page, along with
+ * the frame it is loaded in, if any.  Found by the inode and
+ * offset it is loaded from. */
+struct text_frame;
+
+/* A page of a process attached to a text frame. */
+struct text_map;
+
+/* Where a shareable page is loaded from; see vm_text_key(). */
+struct text_key {
+	struct inode *inode;        /* File the page is read from. */
+	off_t offset;               /* Offset of the page in the file. */
+	size_t read_bytes;          /* Bytes read; the rest is zeroed. */
+	bool mapping;               /* Page of an mmap'd file? */
+};
+
+void text_init (void);
+struct text_frame *text_get (const struct text_key *key);
+bool text_attach (struct page *page, struct text_frame *text);
+bool text_copy (struct page *dst, struct page *src);
+bool text_fault (struct page *page, bool ahead, bool *io);
+struct frame *text_load_begin (struct page *page);
+bool text_load_end (struct page *page, struct frame *frame, bool ok);
+bool text_prefetch (struct text_frame *text);
+bool text_test_accessed (struct page *page);
+void text_writeback (struct page *page);
+void text_release (struct page *page);
+void text_park (struct text_frame *text);
+void text_print_stats (void);
+
+#endif /* vm/text.h */
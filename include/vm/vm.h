@@ -1,8 +1,10 @@
 #ifndef VM_VM_H
 #define VM_VM_H
 #include <stdbool.h>
+#include <stddef.h>
+#include <hash.h>
+#include <list.h>
 #include "threads/palloc.h"
-#include "include/lib/kernel/hash.h"
 
 enum vm_type {
 	/* page not initialized */
@@ -34,6 +36,11 @@ enum vm_type {
 
 struct page_operations;
 struct thread;
+struct text_map;
+struct text_key;
+struct ksm_frame;
+struct shm_map;
+struct faultstat;
 
 #define VM_TYPE(type) ((type) & 7)
 /* The representation of "page".
@@ -46,7 +53,22 @@ struct page {
 	struct frame *frame;   /* Back reference for frame */
 	bool writable;
 	/* Your implementation */
-	struct hash_elem hash_elem; /* Hash table element */
+	bool mapped_ahead;     /* Claimed by fault-around, not by a fault. */
+	struct text_map *text; /* Shared file frame mapping, or NULL. */
+	bool zero;             /* Maps the zero page read-only. */
+	bool busy;             /* Frame in I/O outside the frame table
+	                          lock; see vm_frame_pin(). */
+	bool pinned;           /* Frame owned elsewhere, never evicted;
+	                          see vm_map_pinned(). */
+	struct shm_map *shm;   /* Attached shared memory page, or NULL;
+	                          see vm/shm.c. */
+
+	/* Merging with identical pages; see vm/ksm.c. */
+	struct ksm_frame *ksm;      /* Shared frame mapped read-only, or NULL. */
+	uint64_t ksm_sum;           /* Hash of the contents when last seen. */
+	bool ksm_unstable;          /* In the ksm candidate table? */
+	bool ksm_young;             /* Accessed bit cleared by ksm while set. */
+	struct hash_elem ksm_elem;  /* Element in the ksm candidate table. */
 
 	/* Per-type data are binded into the union.
 	 * Each function automatically detects the current union */
@@ -64,13 +86,34 @@ struct page {
 struct frame {
 	void *kva;	// 커널 가상 주소
 	struct page *page;
-	struct list frame_elem;
+	struct thread *owner;         /* Process that maps the frame, or
+	                                 NULL for a shared memory frame. */
+	bool evictable;               /* On the frame table? */
+	struct list_elem frame_elem;  /* Element in the frame table. */
+};
+
+/* Memory use of a process; see struct rusage. */
+struct vm_usage {
+	long rss;                   /* Pages with a frame. */
+	long max_rss;               /* Most RSS ever. */
+	long swap;                  /* Pages in swap. */
+	long file;                  /* Resident pages of mmap'd files. */
+	long long minflt;           /* Faults served without disk I/O. */
+	long long majflt;           /* Faults that read the disk. */
+	long ws;                    /* Pages referenced in the revolution of
+	                               the clock hand before ws_epoch. */
+	long ws_cur;                /* ...in revolution ws_epoch so far. */
+	unsigned ws_epoch;          /* Revolution ws_cur counts. */
+	struct faultstat *faults;   /* Faults by kind, from the first. */
 };
 
 /* The function table for page operations.
  * This is one way of implementing "interface" in C.
  * Put the table of "method" into the struct's member, and
- * call it whenever you needed. */
+ * call it whenever you needed.
+ * swap_out() takes the page's frame away: it unlinks the frame
+ * from the page, unmaps the page from the frame's owner and saves
+ * the contents, leaving the frame itself to the caller. */
 /* 페이지 작업을 위한 함수 테이블 */
 struct page_operations {
 	bool (*swap_in) (struct page *, void *);
@@ -85,12 +128,26 @@ struct page_operations {
 	if ((page)->operations->destroy) (page)->operations->destroy (page)
 
 /* Representation of current process's memory space.
- * We don't want to force you to obey any specific design for this struct.
- * All designs up to you for this. */
+ * A radix tree of five levels of 64-entry nodes, each indexed by
+ * six bits of the va from bit 12 up, whose leaves point to struct
+ * page.  Nodes are allocated on first use and freed once their
+ * last page is removed, so a range of pages is found by walking
+ * only the nodes that cover it, in address order. */
 struct supplemental_page_table {
-	struct hash *pages;
+	void **root;           /* Top-level node, or NULL if empty. */
+	size_t page_cnt;       /* Number of pages in the table. */
+
+	/* Fault-around state; see vm_fault_around(). */
+	void *ra_next;         /* First page past the last window. */
+	unsigned ra_window;    /* Pages to map after a faulting page. */
+
+	struct list regions;   /* mmap'd regions; see struct mmap_region. */
+	struct list advice;    /* Access hints; see struct madvise_region. */
 };
 
+/* Called for each page by spt_for_each(). Returns false to stop. */
+typedef bool spt_page_func (struct page *page, void *aux);
+
 #include "threads/thread.h"
 void supplemental_page_table_init (struct supplemental_page_table *spt);
 bool supplemental_page_table_copy (struct supplemental_page_table *dst,
@@ -100,8 +157,13 @@ struct page *spt_find_page (struct supplemental_page_table *spt,
 		void *va);
 bool spt_insert_page (struct supplemental_page_table *spt, struct page *page);
 void spt_remove_page (struct supplemental_page_table *spt, struct page *page);
+bool spt_for_each (struct supplemental_page_table *spt, void *start,
+		void *end, spt_page_func *func, void *aux);
+void spt_remove_range (struct supplemental_page_table *spt, void *start,
+		void *end);
 
 void vm_init (void);
+void vm_print_stats (void);
 bool vm_try_handle_fault (struct intr_frame *f, void *addr, bool user,
 		bool write, bool not_present);
 
@@ -111,9 +173,23 @@ bool vm_alloc_page_with_initializer (enum vm_type type, void *upage,
 		bool writable, vm_initializer *init, void *aux);
 void vm_dealloc_page (struct page *page);
 bool vm_claim_page (void *va);
+struct frame *vm_get_frame (bool zero);
+bool vm_map_pinned (void *va, void *kva);
+bool vm_text_key (struct page *page, struct text_key *key);
+bool vm_drop_frame (struct page *page);
+void vm_frame_pin (struct page *page);
+void vm_frame_register (struct frame *frame);
+void vm_frame_unlink (struct frame *frame);
+void vm_frame_take (struct frame *frame);
+void vm_frame_put_back (struct frame *frame);
+typedef void frame_scan_func (struct frame *frame, void *aux);
+void vm_frame_scan (size_t cnt, frame_scan_func *func, void *aux);
+bool vm_reclaim_frame (void);
+void vm_frame_free (struct page *page, bool free_kva);
+void vm_account (struct thread *t, long rss, long swap, long file);
+struct rusage;
+void vm_getrusage (struct rusage *usage);
+void vm_faultstat (struct faultstat *stats, bool all);
+void vm_usage_exit (void);
 enum vm_type page_get_type (struct page *page);
-void page_destructor(struct hash_elem* hash_elem, void* aux);
-
-unsigned page_hash (const struct hash_elem *p_, void *aux UNUSED);
-bool page_less (const struct hash_elem *a_, const struct hash_elem *b_, void *aux UNUSED);
 #endif  /* VM_VM_H */
@@ -0,0 +1,29 @@
+#ifndef VM_ZSWAP_H
+#define VM_ZSWAP_H
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct page;
+
+/* An evicted anonymous page kept compressed in kernel memory
+ * instead of in a swap slot. */
+struct zswap_entry {
+	struct page *page;          /* Page whose contents these are. */
+	struct list_elem elem;      /* Element in the pool, oldest first. */
+	size_t charge;              /* Bytes charged to the pool. */
+	bool same;                  /* Same-filled: FILL is all there is. */
+	uint64_t fill;              /* Value repeated over a same-filled page. */
+	size_t len;                 /* Bytes of compressed data. */
+	uint8_t data[];             /* Compressed data. */
+};
+
+void zswap_init (void);
+struct zswap_entry *zswap_store (struct page *page, const void *kva);
+void zswap_load (const struct zswap_entry *entry, void *kva);
+void zswap_free (struct zswap_entry *entry, bool written_back);
+struct zswap_entry *zswap_victim (void);
+void zswap_print_stats (void);
+
+#endif /* vm/zswap.h */
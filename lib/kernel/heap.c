@@ -0,0 +1,94 @@
+#include "heap.h"
+#include "../debug.h"
+
+/* A leftist heap is a binary tree in which every node is no
+   greater than its children and the right spine of every
+   subtree is no longer than the left one.  Merging walks only
+   right spines, which are O(lg n) long, so the recursion in
+   merge() is shallow enough for a kernel stack. */
+
+static int
+rank (const struct heap_elem *e) {
+	return e != NULL ? e->rank : 0;
+}
+
+/* Merges the heaps rooted at A and B and returns the new root. */
+static struct heap_elem *
+merge (struct heap *heap, struct heap_elem *a, struct heap_elem *b) {
+	struct heap_elem *t;
+
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+	if (heap->less (b, a, heap->aux)) {
+		t = a;
+		a = b;
+		b = t;
+	}
+	a->right = merge (heap, a->right, b);
+	if (rank (a->left) < rank (a->right)) {
+		t = a->left;
+		a->left = a->right;
+		a->right = t;
+	}
+	a->rank = rank (a->right) + 1;
+	return a;
+}
+
+/* Initializes HEAP as an empty heap ordered by LESS given
+   auxiliary data AUX. */
+void
+heap_init (struct heap *heap, heap_less_func *less, void *aux) {
+	ASSERT (heap != NULL);
+	ASSERT (less != NULL);
+
+	heap->root = NULL;
+	heap->size = 0;
+	heap->less = less;
+	heap->aux = aux;
+}
+
+/* Inserts ELEM into HEAP. */
+void
+heap_push (struct heap *heap, struct heap_elem *elem) {
+	ASSERT (heap != NULL);
+	ASSERT (elem != NULL);
+
+	elem->left = elem->right = NULL;
+	elem->rank = 1;
+	heap->root = merge (heap, heap->root, elem);
+	heap->size++;
+}
+
+/* Returns the minimum element of HEAP, or a null pointer if HEAP
+   is empty. */
+struct heap_elem *
+heap_min (const struct heap *heap) {
+	return heap->root;
+}
+
+/* Removes and returns the minimum element of HEAP, or returns a
+   null pointer if HEAP is empty. */
+struct heap_elem *
+heap_pop (struct heap *heap) {
+	struct heap_elem *min = heap->root;
+
+	if (min != NULL) {
+		heap->root = merge (heap, min->left, min->right);
+		heap->size--;
+	}
+	return min;
+}
+
+/* Returns the number of elements in HEAP. */
+size_t
+heap_size (const struct heap *heap) {
+	return heap->size;
+}
+
+/* Returns true if HEAP is empty, false otherwise. */
+bool
+heap_empty (const struct heap *heap) {
+	return heap->root == NULL;
+}
@@ -35,6 +35,16 @@ void fail (const char *, ...) PRINTF_FORMAT (1, 2) NO_RETURN;
           }                                     \
         while (0)
 
+/* Returns the CPU's time-stamp counter, for timing benchmarks. */
+static inline unsigned long long
+rdtsc (void)
+{
+  unsigned lo, hi;
+
+  asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((unsigned long long) hi << 32) | lo;
+}
+
 void shuffle (void *, size_t cnt, size_t size);
 
 void exec_children (const char *child_name, pid_t pids[], size_t child_cnt);
@@ -164,6 +164,12 @@ sub compare_output {
 			&& !/^ esi=.* edi=.* esp=.* ebp=.*/
 			&& !/^ cs=.* ds=.* es=.* ss=.*/, @output);
     }
+    # Benchmarks print TSC cycle counts, which differ from run to run.
+    my $ignore_cycles = exists $options{IGNORE_CYCLES};
+    if ($ignore_cycles) {
+	delete $options{IGNORE_CYCLES};
+	s/\d+ cycles$/N cycles/ foreach @output;
+    }
     die "unknown option " . (keys (%options))[0] . "\n" if %options;
 
     my ($msg);
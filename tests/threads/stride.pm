@@ -0,0 +1,60 @@
+# -*- perl -*-
+use strict;
+use warnings;
+
+# Checks the per-second tick counts printed by stride-share.c.
+# $tickets and $join give each thread's tickets and the second it
+# started spinning at.  At every sample, each thread's count must
+# be within $maxdiff ticks of its share of the ticks handed out
+# while it was running.
+sub check_stride_share {
+    my ($tickets, $join, $maxdiff) = @_;
+    our ($test);
+    my (@output) = read_text_file ("$test.output");
+    common_checks ("run", @output);
+    @output = get_core_output ("run", @output);
+
+    my (@samples);
+    local ($_);
+    foreach (@output) {
+	my ($sec, $counts) = /After (\d+) seconds:((?: \d+)+)$/ or next;
+	$samples[$sec] = [split (' ', $counts)];
+    }
+    fail "Missing samples.\n" if @samples < 2;
+
+    my ($thread_cnt) = scalar (@$tickets);
+    my (@prev) = (0) x $thread_cnt;
+    my (@expected) = (0) x $thread_cnt;
+    my ($ok) = 1;
+    for my $sec (1...$#samples) {
+	my ($cur) = $samples[$sec];
+	fail "Missing sample for second $sec.\n"
+	  if !defined ($cur) || @$cur != $thread_cnt;
+
+	# Hand out this second's ticks among the running threads.
+	my ($delta, $active_tickets) = (0, 0);
+	for my $i (0...$thread_cnt - 1) {
+	    $delta += $cur->[$i] - $prev[$i];
+	    $active_tickets += $tickets->[$i] if $join->[$i] < $sec;
+	}
+	for my $i (0...$thread_cnt - 1) {
+	    $expected[$i] += $delta * $tickets->[$i] / $active_tickets
+	      if $join->[$i] < $sec;
+	}
+
+	my (@row);
+	for my $i (0...$thread_cnt - 1) {
+	    my ($diff) = $cur->[$i] - $expected[$i];
+	    $ok = 0 if abs ($diff) > $maxdiff + .01;
+	    push (@row, sprintf ("%d (expected %.1f)",
+				 $cur->[$i], $expected[$i]));
+	}
+	print "After $sec seconds: ", join (', ', @row), "\n" if !$ok;
+	@prev = @$cur;
+    }
+    fail "Some tick counts differed from their share by more than "
+      . "$maxdiff.\n" if !$ok;
+    pass;
+}
+
+1;
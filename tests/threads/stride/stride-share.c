@@ -0,0 +1,142 @@
+/* Checks that the stride scheduler divides the CPU among threads
+   in proportion to their tickets.
+
+   Each test starts a few threads that spin for 10 seconds,
+   counting the timer ticks during which they were running.  Once
+   a second the main thread prints the counts so far.  Stride
+   scheduling keeps every thread within a constant number of
+   ticks of its exact share at all times, so its relative error
+   shrinks as the counts grow.  The .ck files check the absolute
+   error at every sample.
+
+   The stride-2 test runs 2 threads with 100 and 300 tickets.
+
+   The stride-3 test runs 3 threads with 100, 200, and 300
+   tickets.
+
+   The stride-join test runs 2 threads with 100 tickets each, the
+   second of which sleeps through the first 5 seconds.  A thread
+   that slept must not be paid back for the time it missed, so
+   from then on the two should split the CPU evenly. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define MAX_THREAD_CNT 4
+#define SAMPLE_CNT 10
+
+struct thread_info
+  {
+    int64_t start_time;         /* When all threads start spinning. */
+    int tickets;                /* Tickets to run with. */
+    int join;                   /* Seconds to sleep before spinning. */
+    int tick_count;             /* Ticks seen while running. */
+    struct semaphore *done;     /* Upped when finished. */
+  };
+
+static void test_stride_share (int thread_cnt, const int tickets[],
+                               const int join[]);
+static void spin_thread (void *aux);
+
+void
+test_stride_2 (void)
+{
+  static const int tickets[] = {100, 300};
+  static const int join[] = {0, 0};
+  test_stride_share (2, tickets, join);
+}
+
+void
+test_stride_3 (void)
+{
+  static const int tickets[] = {100, 200, 300};
+  static const int join[] = {0, 0, 0};
+  test_stride_share (3, tickets, join);
+}
+
+void
+test_stride_join (void)
+{
+  static const int tickets[] = {100, 100};
+  static const int join[] = {0, 5};
+  test_stride_share (2, tickets, join);
+}
+
+static void
+test_stride_share (int thread_cnt, const int tickets[], const int join[])
+{
+  struct thread_info info[MAX_THREAD_CNT];
+  struct semaphore done;
+  int64_t start_time;
+  int i, s;
+
+  ASSERT (thread_stride);
+  ASSERT (thread_cnt <= MAX_THREAD_CNT);
+
+  sema_init (&done, 0);
+  start_time = timer_ticks () + TIMER_FREQ;
+  msg ("Starting %d threads...", thread_cnt);
+  for (i = 0; i < thread_cnt; i++)
+    {
+      struct thread_info *ti = &info[i];
+      char name[16];
+
+      ti->start_time = start_time;
+      ti->tickets = tickets[i];
+      ti->join = join[i];
+      ti->tick_count = 0;
+      ti->done = &done;
+
+      snprintf (name, sizeof name, "spin %d", i);
+      thread_create (name, PRI_DEFAULT, spin_thread, ti);
+    }
+
+  for (s = 1; s <= SAMPLE_CNT; s++)
+    {
+      char line[128];
+      size_t len;
+      enum intr_level old_level;
+      int counts[MAX_THREAD_CNT];
+
+      timer_sleep (start_time + s * TIMER_FREQ - timer_ticks ());
+
+      old_level = intr_disable ();
+      for (i = 0; i < thread_cnt; i++)
+        counts[i] = info[i].tick_count;
+      intr_set_level (old_level);
+
+      len = snprintf (line, sizeof line, "After %d seconds:", s);
+      for (i = 0; i < thread_cnt; i++)
+        len += snprintf (line + len, sizeof line - len, " %d", counts[i]);
+      msg ("%s", line);
+    }
+
+  for (i = 0; i < thread_cnt; i++)
+    sema_down (&done);
+}
+
+static void
+spin_thread (void *ti_)
+{
+  struct thread_info *ti = ti_;
+  int64_t spin_start = ti->start_time + ti->join * TIMER_FREQ;
+  int64_t spin_end = ti->start_time + SAMPLE_CNT * TIMER_FREQ;
+  int64_t last_time = 0;
+
+  thread_set_tickets (ti->tickets);
+  timer_sleep (spin_start - timer_ticks ());
+  while (timer_ticks () < spin_end)
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        ti->tick_count++;
+      last_time = cur_time;
+    }
+  sema_up (ti->done);
+}
@@ -38,6 +38,9 @@ static const struct test tests[] =
   //   {"mlfqs-nice-2", test_mlfqs_nice_2},
   //   {"mlfqs-nice-10", test_mlfqs_nice_10},
   //   {"mlfqs-block", test_mlfqs_block},
+    {"stride-2", test_stride_2},
+    {"stride-3", test_stride_3},
+    {"stride-join", test_stride_join},
   };
 
 static const char *test_name;
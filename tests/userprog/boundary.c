@@ -9,6 +9,9 @@
 
 static char dst[8192];
 
+/* End of the program's data, from the linker script. */
+extern char end[];
+
 /* Returns the beginning of a page.  There are at least 2048
    modifiable bytes on either side of the pointer returned. */
 void *
@@ -31,3 +34,15 @@ copy_string_across_boundary (const char *src)
   return p;
 }
 
+
+/* Returns the first page past the end of the program's data,
+   which is never mapped.  Stores in *SLACK how many bytes just
+   below it are mapped but hold no variable, so that they may be
+   overwritten freely. */
+void *
+get_unmapped_area (size_t *slack) 
+{
+  char *p = (char *) ROUND_UP ((uintptr_t) end, 4096);
+  *slack = p - end;
+  return p;
+}
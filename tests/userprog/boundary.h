@@ -1,7 +1,10 @@
 #ifndef TESTS_USERPROG_BOUNDARY_H
 #define TESTS_USERPROG_BOUNDARY_H
 
+#include <stddef.h>
+
 void *get_boundary_area (void);
 char *copy_string_across_boundary (const char *);
+void *get_unmapped_area (size_t *slack);
 
 #endif /* tests/userprog/boundary.h */
@@ -0,0 +1,91 @@
+/* Copies a file twice, once through a user buffer with read() and
+   write() and once with copy_file_range(), which moves the data
+   inside the kernel, and checks that both copies match the source.
+
+   Used as a benchmark: compare the TSC cycles of the "read/write"
+   and "copy_file_range" lines. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE (64 * 1024)
+#define CHUNK 4096
+
+static char buf[CHUNK];
+static char check[CHUNK];
+
+/* Fills BUF with the source contents at offset OFS. */
+static void
+fill (char *p, int ofs)
+{
+  int i;
+
+  for (i = 0; i < CHUNK; i++)
+    p[i] = (ofs + i) * 7 + (ofs + i) / 251;
+}
+
+/* Creates NAME with FILE_SIZE bytes and opens it. */
+static int
+make_file (const char *name)
+{
+  int fd;
+
+  CHECK (create (name, FILE_SIZE), "create \"%s\"", name);
+  CHECK ((fd = open (name)) > 1, "open \"%s\"", name);
+  return fd;
+}
+
+/* Fails unless FD holds the source contents. */
+static void
+verify (int fd, const char *name)
+{
+  int ofs;
+
+  for (ofs = 0; ofs < FILE_SIZE; ofs += CHUNK)
+    {
+      if (pread (fd, buf, CHUNK, ofs) != CHUNK)
+        fail ("read \"%s\" at %d", name, ofs);
+      fill (check, ofs);
+      if (memcmp (buf, check, CHUNK))
+        fail ("\"%s\" differs from the source at %d", name, ofs);
+    }
+}
+
+void
+test_main (void)
+{
+  unsigned long long start, rw_cycles, copy_cycles;
+  int src, rw, copy, ofs;
+  off_t in_ofs = 0, out_ofs = 0;
+
+  src = make_file ("source");
+  for (ofs = 0; ofs < FILE_SIZE; ofs += CHUNK)
+    {
+      fill (buf, ofs);
+      if (write (src, buf, CHUNK) != CHUNK)
+        fail ("write \"source\" at %d", ofs);
+    }
+  rw = make_file ("rw");
+  copy = make_file ("copy");
+
+  start = rdtsc ();
+  seek (src, 0);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += CHUNK)
+    if (read (src, buf, CHUNK) != CHUNK || write (rw, buf, CHUNK) != CHUNK)
+      fail ("read/write at %d", ofs);
+  rw_cycles = rdtsc () - start;
+
+  start = rdtsc ();
+  if (copy_file_range (src, &in_ofs, copy, &out_ofs, FILE_SIZE) != FILE_SIZE)
+    fail ("copy_file_range");
+  copy_cycles = rdtsc () - start;
+  if (in_ofs != FILE_SIZE || out_ofs != FILE_SIZE)
+    fail ("offsets advanced to %d and %d", in_ofs, out_ofs);
+
+  verify (rw, "rw");
+  verify (copy, "copy");
+  msg ("read/write: %d bytes in %llu cycles", FILE_SIZE, rw_cycles);
+  msg ("copy_file_range: %d bytes in %llu cycles", FILE_SIZE, copy_cycles);
+}
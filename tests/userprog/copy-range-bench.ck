@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, IGNORE_CYCLES => 1, [<<'EOF']);
+(copy-range-bench) begin
+(copy-range-bench) create "source"
+(copy-range-bench) open "source"
+(copy-range-bench) create "rw"
+(copy-range-bench) open "rw"
+(copy-range-bench) create "copy"
+(copy-range-bench) open "copy"
+(copy-range-bench) read/write: 65536 bytes in N cycles
+(copy-range-bench) copy_file_range: 65536 bytes in N cycles
+(copy-range-bench) end
+EOF
+pass;
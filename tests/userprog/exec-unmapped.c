@@ -0,0 +1,31 @@
+/* Executes a program whose name runs, without a null terminator,
+   into an unmapped page.  The child doing so must be terminated
+   with -1 exit code, and the kernel must not be left holding any
+   lock, so the parent can still open a file afterward. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/boundary.h"
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t child;
+
+  if ((child = fork ("exec-child")) == 0)
+    {
+      size_t slack;
+      char *page = get_unmapped_area (&slack);
+      const char *name = "child-simple";
+      size_t len = slack < strlen (name) ? slack : strlen (name);
+
+      memcpy (page - len, name, len);
+      exec (page - len);
+      fail ("should have exited with -1");
+    }
+  msg ("wait(child) = %d", wait (child));
+  check_file ("sample.txt", sample, sizeof sample - 1);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(exec-unmapped) begin
+exec-child: exit(-1)
+(exec-unmapped) wait(child) = -1
+(exec-unmapped) open "sample.txt" for verification
+(exec-unmapped) verified contents of "sample.txt"
+(exec-unmapped) close "sample.txt"
+(exec-unmapped) end
+exec-unmapped: exit(0)
+EOF
+pass;
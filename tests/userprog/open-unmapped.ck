@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(open-unmapped) begin
+open-child: exit(-1)
+(open-unmapped) wait(child) = -1
+(open-unmapped) open "sample.txt" for verification
+(open-unmapped) verified contents of "sample.txt"
+(open-unmapped) close "sample.txt"
+(open-unmapped) end
+open-unmapped: exit(0)
+EOF
+pass;
@@ -0,0 +1,87 @@
+/* Streams data from a parent to a forked child through a pipe and
+   checks every byte on the child's side.  Does it once with small
+   writes and once with page-sized writes, which the kernel moves a
+   page at a time.
+
+   Used as a benchmark: compare the TSC cycles of the "small" and
+   "page" lines. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define TOTAL (256 * 1024)
+#define SMALL 64
+#define PAGE 4096
+
+static char buf[PAGE];
+
+static char
+pattern (int i)
+{
+  return i * 13 + i / 509;
+}
+
+/* Reads the pipe's read end FD to end of file and checks it. */
+static void
+consume (int fd)
+{
+  int total = 0;
+  int n, i;
+
+  while ((n = read (fd, buf, sizeof buf)) > 0)
+    {
+      for (i = 0; i < n; i++)
+        if (buf[i] != pattern (total + i))
+          fail ("byte %d differs", total + i);
+      total += n;
+    }
+  if (n < 0 || total != TOTAL)
+    fail ("read %d bytes instead of %d", total, TOTAL);
+}
+
+/* Sends TOTAL bytes through a new pipe to a child in writes of
+   CHUNK bytes and returns the cycles until the child is done. */
+static unsigned long long
+run (const char *name, int chunk)
+{
+  unsigned long long start;
+  int fds[2];
+  int ofs, i;
+  pid_t pid;
+
+  CHECK (pipe (fds) == 0, "pipe for %s writes", name);
+  start = rdtsc ();
+  pid = fork (name);
+  if (pid < 0)
+    fail ("fork");
+  if (pid == 0)
+    {
+      close (fds[1]);
+      consume (fds[0]);
+      exit (0);
+    }
+
+  close (fds[0]);
+  for (ofs = 0; ofs < TOTAL; ofs += chunk)
+    {
+      for (i = 0; i < chunk; i++)
+        buf[i] = pattern (ofs + i);
+      if (write (fds[1], buf, chunk) != chunk)
+        fail ("write at %d", ofs);
+    }
+  close (fds[1]);
+  if (wait (pid) != 0)
+    fail ("child failed");
+  return rdtsc () - start;
+}
+
+void
+test_main (void)
+{
+  unsigned long long small_cycles = run ("small", SMALL);
+  unsigned long long page_cycles = run ("page", PAGE);
+
+  msg ("small: %d bytes in %llu cycles", TOTAL, small_cycles);
+  msg ("page: %d bytes in %llu cycles", TOTAL, page_cycles);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, IGNORE_CYCLES => 1, [<<'EOF']);
+(pipe-bench) begin
+(pipe-bench) pipe for small writes
+(pipe-bench) pipe for page writes
+(pipe-bench) small: 262144 bytes in N cycles
+(pipe-bench) page: 262144 bytes in N cycles
+(pipe-bench) end
+EOF
+pass;
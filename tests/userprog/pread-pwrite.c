@@ -0,0 +1,49 @@
+/* Writes and reads a file at given offsets with pwrite() and
+   pread(), across a sector boundary and up to the end of the file.
+   Neither may move the file position, which read() then checks. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE 1024
+#define OFFSET 300
+
+void
+test_main (void) 
+{
+  static char buf[sizeof sample];
+  const int size = sizeof sample - 1;
+  int handle;
+  int i;
+
+  CHECK (create ("data", FILE_SIZE), "create \"data\"");
+  CHECK ((handle = open ("data")) > 1, "open \"data\"");
+
+  CHECK (pwrite (handle, sample, size, OFFSET) == size,
+         "pwrite at offset %d", OFFSET);
+  CHECK (tell (handle) == 0, "pwrite left the position alone");
+  CHECK (pread (handle, buf, size, OFFSET) == size,
+         "pread at offset %d", OFFSET);
+  if (memcmp (buf, sample, size))
+    fail ("pread returned bad data");
+  CHECK (pread (handle, buf, 100, FILE_SIZE - 24) == 24,
+         "pread stops at the end of the file");
+  CHECK (pread (handle, buf, 100, FILE_SIZE + 100) == 0,
+         "pread past the end reads nothing");
+  CHECK (tell (handle) == 0, "pread left the position alone");
+
+  CHECK (read (handle, buf, OFFSET) == OFFSET, "read %d bytes", OFFSET);
+  for (i = 0; i < OFFSET; i++)
+    if (buf[i] != 0)
+      fail ("byte %d before the pwrite is not zero", i);
+  CHECK (read (handle, buf, size) == size, "read the rest");
+  if (memcmp (buf, sample, size))
+    fail ("read returned bad data");
+
+  CHECK (pread (1, buf, size, 0) == -1, "pread on the console fails");
+  CHECK (pwrite (handle, sample, size, -1) == -1,
+         "pwrite at a negative offset fails");
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pread-pwrite) begin
+(pread-pwrite) create "data"
+(pread-pwrite) open "data"
+(pread-pwrite) pwrite at offset 300
+(pread-pwrite) pwrite left the position alone
+(pread-pwrite) pread at offset 300
+(pread-pwrite) pread stops at the end of the file
+(pread-pwrite) pread past the end reads nothing
+(pread-pwrite) pread left the position alone
+(pread-pwrite) read 300 bytes
+(pread-pwrite) read the rest
+(pread-pwrite) pread on the console fails
+(pread-pwrite) pwrite at a negative offset fails
+(pread-pwrite) end
+pread-pwrite: exit(0)
+EOF
+pass;
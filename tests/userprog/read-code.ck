@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(read-code) begin
+(read-code) open "sample.txt"
+read-child: exit(-1)
+(read-code) wait(child) = -1
+(read-code) open "sample.txt" for verification
+(read-code) verified contents of "sample.txt"
+(read-code) close "sample.txt"
+(read-code) end
+read-code: exit(0)
+EOF
+pass;
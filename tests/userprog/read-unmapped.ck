@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(read-unmapped) begin
+(read-unmapped) open "sample.txt"
+read-child: exit(-1)
+(read-unmapped) wait(child) = -1
+(read-unmapped) open "sample.txt" for verification
+(read-unmapped) verified contents of "sample.txt"
+(read-unmapped) close "sample.txt"
+(read-unmapped) end
+read-unmapped: exit(0)
+EOF
+pass;
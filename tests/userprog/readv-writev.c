@@ -0,0 +1,58 @@
+/* Gathers three pieces of a buffer into a file with writev() and
+   scatters the file back into three other buffers with readv(),
+   one of which crosses a page boundary.  Both move the file
+   position, and writev() to the console writes every piece. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/boundary.h"
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char first[1], last[sizeof sample];
+  static char greeting[] = "Hello, ", name[] = "console!\n";
+  const int size = sizeof sample - 1;
+  char *middle = (char *) get_boundary_area () - 100;
+  struct iovec iov[IOV_MAX + 1];
+  int handle;
+
+  CHECK (create ("data", size), "create \"data\"");
+  CHECK ((handle = open ("data")) > 1, "open \"data\"");
+
+  iov[0].iov_base = sample;
+  iov[0].iov_len = 10;
+  iov[1].iov_base = sample + 10;
+  iov[1].iov_len = 190;
+  iov[2].iov_base = sample + 200;
+  iov[2].iov_len = size - 200;
+  CHECK (writev (handle, iov, 3) == size, "writev \"data\"");
+  CHECK ((int) tell (handle) == size, "writev moved the position");
+
+  seek (handle, 0);
+  iov[0].iov_base = first;
+  iov[0].iov_len = sizeof first;
+  iov[1].iov_base = middle;
+  iov[1].iov_len = 200;
+  iov[2].iov_base = last;
+  iov[2].iov_len = sizeof last;
+  CHECK (readv (handle, iov, 3) == size, "readv \"data\"");
+  CHECK ((int) tell (handle) == size, "readv moved the position");
+  if (first[0] != sample[0] || memcmp (middle, sample + 1, 200)
+      || memcmp (last, sample + 201, size - 201))
+    fail ("readv returned bad data");
+
+  iov[0].iov_base = greeting;
+  iov[0].iov_len = strlen (greeting);
+  iov[1].iov_base = name;
+  iov[1].iov_len = strlen (name);
+  CHECK (writev (1, iov, 2) == (int) (strlen (greeting) + strlen (name)),
+         "writev to the console");
+
+  memset (iov, 0, sizeof iov);
+  CHECK (readv (handle, iov, IOV_MAX + 1) == -1,
+         "readv of too many buffers fails");
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(readv-writev) begin
+(readv-writev) create "data"
+(readv-writev) open "data"
+(readv-writev) writev "data"
+(readv-writev) writev moved the position
+(readv-writev) readv "data"
+(readv-writev) readv moved the position
+(readv-writev) writev to the console
+Hello, console!
+(readv-writev) readv of too many buffers fails
+(readv-writev) end
+readv-writev: exit(0)
+EOF
+pass;
@@ -0,0 +1,92 @@
+/* Checks that set_tickets() divides the CPU between processes in
+   proportion to their tickets, under the stride scheduler.
+
+   Forks two children that set 100 and 300 tickets and then spin
+   through the same stretch of TSC cycles, counting how many times
+   they get around their loop.  The parent stays blocked on a pipe
+   meanwhile, so the two children split the CPU between them and
+   their counts should come out about 1 to 3. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Cycles the children spin for, and before they start. */
+#define SPIN_CYCLES 2000000000ULL
+#define LEAD_CYCLES 100000000ULL
+
+struct window
+  {
+    unsigned long long start;   /* When to start counting. */
+    unsigned long long end;     /* When to stop. */
+  };
+
+/* Sets TICKETS, waits for the window to spin through from IN,
+   spins through it and writes how often it got around to OUT. */
+static void
+spin (int tickets, int in, int out)
+{
+  struct window w;
+  long long count = 0;
+
+  if (set_tickets (tickets) != 0)
+    fail ("set_tickets (%d)", tickets);
+  if (read (in, &w, sizeof w) != sizeof w)
+    fail ("read window");
+  while (rdtsc () < w.start)
+    continue;
+  while (rdtsc () < w.end)
+    count++;
+  if (write (out, &count, sizeof count) != sizeof count)
+    fail ("write count");
+  exit (0);
+}
+
+void
+test_main (void)
+{
+  static const int tickets[2] = {100, 300};
+  long long counts[2];
+  struct window w;
+  int to_child[2], from_child[2];
+  pid_t pids[2];
+  int i;
+
+  CHECK (set_tickets (0) == -1, "set_tickets (0) fails");
+  CHECK (pipe (to_child) == 0, "pipe to children");
+  for (i = 0; i < 2; i++)
+    {
+      int result[2];
+
+      /* Each child answers on a pipe of its own, so that the
+         parent knows whose count it reads. */
+      CHECK (pipe (result) == 0, "pipe from child %d", i);
+      pids[i] = fork ("spinner");
+      if (pids[i] < 0)
+        fail ("fork");
+      if (pids[i] == 0)
+        spin (tickets[i], to_child[0], result[1]);
+      close (result[1]);
+      from_child[i] = result[0];
+    }
+
+  w.start = rdtsc () + LEAD_CYCLES;
+  w.end = w.start + SPIN_CYCLES;
+  for (i = 0; i < 2; i++)
+    if (write (to_child[1], &w, sizeof w) != sizeof w)
+      fail ("write window");
+  for (i = 0; i < 2; i++)
+    {
+      if (read (from_child[i], &counts[i], sizeof counts[i])
+          != sizeof counts[i])
+        fail ("read count of child %d", i);
+      wait (pids[i]);
+    }
+
+  /* Allow a quarter either side of the 1 to 3 ratio. */
+  if (counts[0] <= 0
+      || 4 * counts[1] < 9 * counts[0] || 4 * counts[1] > 15 * counts[0])
+    fail ("counts %lld and %lld are not about 1 to 3",
+          counts[0], counts[1]);
+  msg ("counts are about 1 to 3");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(stride-tickets) begin
+(stride-tickets) set_tickets (0) fails
+(stride-tickets) pipe to children
+(stride-tickets) pipe from child 0
+(stride-tickets) pipe from child 1
+(stride-tickets) counts are about 1 to 3
+(stride-tickets) end
+EOF
+pass;
@@ -0,0 +1,30 @@
+/* Writes from a buffer that runs from mapped memory into an
+   unmapped page.  The child doing so must be terminated with -1
+   exit code before anything reaches the file, and the kernel must
+   not be left holding any lock, so the parent can still read the
+   file afterward. */
+
+#include <syscall.h>
+#include "tests/userprog/boundary.h"
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t child;
+
+  if ((child = fork ("write-child")) == 0)
+    {
+      size_t slack;
+      char *page = get_unmapped_area (&slack);
+      int handle;
+
+      CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+      write (handle, page - (slack < 16 ? slack : 16), sizeof sample - 1);
+      fail ("should not have survived write()");
+    }
+  msg ("wait(child) = %d", wait (child));
+  check_file ("sample.txt", sample, sizeof sample - 1);
+}
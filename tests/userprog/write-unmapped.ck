@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(write-unmapped) begin
+(write-unmapped) open "sample.txt"
+write-child: exit(-1)
+(write-unmapped) wait(child) = -1
+(write-unmapped) open "sample.txt" for verification
+(write-unmapped) verified contents of "sample.txt"
+(write-unmapped) close "sample.txt"
+(write-unmapped) end
+write-unmapped: exit(0)
+EOF
+pass;
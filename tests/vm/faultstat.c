@@ -0,0 +1,70 @@
+/* Reads and then writes untouched pages of the bss, which must
+   take one zero-page fault and then one copy-on-write fault each,
+   and checks that faultstat() counts them, for this process and
+   for the whole system, with histograms that add up. */
+
+#include <round.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 16
+
+static char buf[(PAGE_CNT + 1) * PAGE_SIZE];
+static struct faultstat before, after, all;
+
+/* Fails unless the histogram of each kind of fault in S adds up to
+   its count, and its slowest fault fits in its total. */
+static void
+check_stats (const struct faultstat *s, const char *name)
+{
+  int type, i;
+
+  for (type = 0; type < FAULT_TYPE_CNT; type++)
+    {
+      long long sum = 0;
+
+      for (i = 0; i < FAULT_HIST_CNT; i++)
+        sum += s->hist[type][i];
+      if (sum != s->count[type])
+        fail ("%s: histogram of type %d holds %lld faults, not %lld",
+              name, type, sum, s->count[type]);
+      if (s->max[type] > s->cycles[type])
+        fail ("%s: slowest fault of type %d exceeds the total", name, type);
+    }
+}
+
+void
+test_main (void)
+{
+  char *pages = (char *) ROUND_UP ((uintptr_t) buf, PAGE_SIZE);
+  int type, i;
+
+  CHECK (faultstat (2, &before) == -1, "faultstat of bad scope");
+  CHECK (faultstat (FAULTSTAT_SELF, &before) == 0, "faultstat");
+
+  for (i = 0; i < PAGE_CNT; i++)
+    if (pages[i * PAGE_SIZE] != 0)
+      fail ("page %d does not read as zero", i);
+  for (i = 0; i < PAGE_CNT; i++)
+    pages[i * PAGE_SIZE] = 1;
+
+  faultstat (FAULTSTAT_SELF, &after);
+  faultstat (FAULTSTAT_ALL, &all);
+  CHECK (after.count[FAULT_ZERO] >= before.count[FAULT_ZERO] + PAGE_CNT,
+         "reads were counted as zero-page faults");
+  CHECK (after.count[FAULT_COW] >= before.count[FAULT_COW] + PAGE_CNT,
+         "writes were counted as copy-on-write faults");
+  CHECK (after.cycles[FAULT_ZERO] > before.cycles[FAULT_ZERO]
+         && after.cycles[FAULT_COW] > before.cycles[FAULT_COW],
+         "faults took time");
+  check_stats (&after, "self");
+  check_stats (&all, "all");
+  for (type = 0; type < FAULT_TYPE_CNT; type++)
+    if (all.count[type] < after.count[type])
+      fail ("system counts fewer faults of type %d than this process",
+            type);
+  msg ("statistics are consistent");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(faultstat) begin
+(faultstat) faultstat of bad scope
+(faultstat) faultstat
+(faultstat) reads were counted as zero-page faults
+(faultstat) writes were counted as copy-on-write faults
+(faultstat) faults took time
+(faultstat) statistics are consistent
+(faultstat) end
+EOF
+pass;
@@ -0,0 +1,52 @@
+/* Checks that getrusage() counts the pages a process touches, the
+   faults that brought them in, and the resident pages of an mmap'd
+   file, which stop counting once the file is unmapped. */
+
+#include <round.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x10000000)
+#define PAGE_SIZE 4096
+#define PAGE_CNT 16
+#define FILE_PAGES 3
+
+static char buf[(PAGE_CNT + 1) * PAGE_SIZE];
+
+void
+test_main (void)
+{
+  static struct rusage before, after;
+  char *pages = (char *) ROUND_UP ((uintptr_t) buf, PAGE_SIZE);
+  int handle;
+  void *map;
+  int i;
+
+  CHECK (getrusage (&before) == 0, "getrusage");
+  for (i = 0; i < PAGE_CNT; i++)
+    pages[i * PAGE_SIZE] = i + 1;
+  getrusage (&after);
+  CHECK (after.ru_rss >= before.ru_rss + PAGE_CNT,
+         "touched pages are resident");
+  CHECK (after.ru_maxrss >= after.ru_rss, "peak is at least current use");
+  CHECK (after.ru_minflt + after.ru_majflt
+         >= before.ru_minflt + before.ru_majflt + PAGE_CNT,
+         "touched pages were faulted in");
+
+  CHECK ((handle = open ("small.txt")) > 1, "open \"small.txt\"");
+  CHECK ((map = mmap (ACTUAL, FILE_PAGES * PAGE_SIZE, 0, handle, 0))
+         != MAP_FAILED, "mmap \"small.txt\"");
+  getrusage (&before);
+  for (i = 0; i < FILE_PAGES; i++)
+    if (ACTUAL[i * PAGE_SIZE] == 0)
+      fail ("page %d of \"small.txt\" reads as zero", i);
+  getrusage (&after);
+  CHECK (after.ru_file >= before.ru_file + FILE_PAGES,
+         "mapped pages count as file pages");
+  munmap (map);
+  getrusage (&after);
+  CHECK (after.ru_file == before.ru_file,
+         "unmapped pages no longer count");
+}
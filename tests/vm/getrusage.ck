@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(getrusage) begin
+(getrusage) getrusage
+(getrusage) touched pages are resident
+(getrusage) peak is at least current use
+(getrusage) touched pages were faulted in
+(getrusage) open "small.txt"
+(getrusage) mmap "small.txt"
+(getrusage) mapped pages count as file pages
+(getrusage) unmapped pages no longer count
+(getrusage) end
+EOF
+pass;
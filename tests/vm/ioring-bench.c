@@ -0,0 +1,172 @@
+/* Writes a file a block at a time and reads it back, computing
+   each block's contents before writing it and checking them after
+   reading it.  Does it once with pwrite() and pread(), which wait
+   for the disk, and once through an ioring, which keeps DEPTH
+   blocks in flight so the computing overlaps the disk I/O.
+
+   Used as a benchmark: compare the TSC cycles of the "sync" and
+   "ring" lines, and the "Ioring" line the kernel prints at power
+   off. */
+
+#include <ioring.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BLOCK_SIZE 4096
+#define BLOCK_CNT 32
+#define DEPTH 4
+#define ROUNDS 8
+
+#define RING ((struct ioring *) 0x10000000)
+
+static char block[BLOCK_SIZE];
+
+/* Byte I of block N, made to cost some computation. */
+static char
+pattern (int n, int i)
+{
+  unsigned x = n * BLOCK_SIZE + i + 1;
+  int r;
+
+  for (r = 0; r < ROUNDS; r++)
+    {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+    }
+  return x;
+}
+
+static void
+produce (char *buf, int n)
+{
+  int i;
+
+  for (i = 0; i < BLOCK_SIZE; i++)
+    buf[i] = pattern (n, i);
+}
+
+static void
+consume (const char *buf, int n)
+{
+  int i;
+
+  for (i = 0; i < BLOCK_SIZE; i++)
+    if (buf[i] != pattern (n, i))
+      fail ("block %d differs at byte %d", n, i);
+}
+
+/* Buffer area slot for block N. */
+static char *
+slot (int n)
+{
+  return (char *) RING->buf + n % DEPTH * BLOCK_SIZE;
+}
+
+/* Queues OP on block N of FD and submits it. */
+static void
+submit (int op, int fd, int n)
+{
+  struct ioring_sqe *sqe = &RING->sqes[RING->sq_tail & (RING->entries - 1)];
+
+  sqe->opcode = op;
+  sqe->fd = fd;
+  sqe->off = n * BLOCK_SIZE;
+  sqe->len = op == IORING_OP_FSYNC ? 0 : BLOCK_SIZE;
+  sqe->buf = slot (n);
+  sqe->user_data = n;
+  RING->sq_tail++;
+  if (ioring_enter (RING, 0) != 1)
+    fail ("submit block %d", n);
+}
+
+/* Waits for the completion of the request for block N, which
+   returned RES. */
+static void
+reap (int n, int res)
+{
+  struct ioring_cqe *cqe;
+
+  if (RING->cq_head == RING->cq_tail)
+    ioring_enter (RING, 1);
+  if (RING->cq_head == RING->cq_tail)
+    fail ("no completion for block %d", n);
+  cqe = &RING->cqes[RING->cq_head & (RING->entries - 1)];
+  if (cqe->user_data != (uint64_t) n || cqe->res != res)
+    fail ("block %d completed as %d with %d", n, (int) cqe->user_data,
+          cqe->res);
+  RING->cq_head++;
+}
+
+static unsigned long long
+run_sync (int fd)
+{
+  unsigned long long start = rdtsc ();
+  int n;
+
+  for (n = 0; n < BLOCK_CNT; n++)
+    {
+      produce (block, n);
+      if (pwrite (fd, block, BLOCK_SIZE, n * BLOCK_SIZE) != BLOCK_SIZE)
+        fail ("pwrite block %d", n);
+    }
+  for (n = 0; n < BLOCK_CNT; n++)
+    {
+      if (pread (fd, block, BLOCK_SIZE, n * BLOCK_SIZE) != BLOCK_SIZE)
+        fail ("pread block %d", n);
+      consume (block, n);
+    }
+  return rdtsc () - start;
+}
+
+static unsigned long long
+run_ring (int fd)
+{
+  unsigned long long start = rdtsc ();
+  int n;
+
+  /* Compute each block while the ones before it are written. */
+  for (n = 0; n < BLOCK_CNT; n++)
+    {
+      if (n >= DEPTH)
+        reap (n - DEPTH, BLOCK_SIZE);
+      produce (slot (n), n);
+      submit (IORING_OP_WRITE, fd, n);
+    }
+  for (n = BLOCK_CNT - DEPTH; n < BLOCK_CNT; n++)
+    reap (n, BLOCK_SIZE);
+  submit (IORING_OP_FSYNC, fd, BLOCK_CNT);
+  reap (BLOCK_CNT, 0);
+
+  /* Check each block while the ones after it are read. */
+  for (n = 0; n < DEPTH; n++)
+    submit (IORING_OP_READ, fd, n);
+  for (n = 0; n < BLOCK_CNT; n++)
+    {
+      reap (n, BLOCK_SIZE);
+      consume (slot (n), n);
+      if (n + DEPTH < BLOCK_CNT)
+        submit (IORING_OP_READ, fd, n + DEPTH);
+    }
+  return rdtsc () - start;
+}
+
+void
+test_main (void)
+{
+  unsigned long long sync_cycles, ring_cycles;
+  int sync_fd, ring_fd;
+
+  CHECK (create ("sync", BLOCK_CNT * BLOCK_SIZE), "create \"sync\"");
+  CHECK ((sync_fd = open ("sync")) > 1, "open \"sync\"");
+  CHECK (create ("ring", BLOCK_CNT * BLOCK_SIZE), "create \"ring\"");
+  CHECK ((ring_fd = open ("ring")) > 1, "open \"ring\"");
+  CHECK (ioring_setup (RING, 2 * DEPTH, DEPTH * BLOCK_SIZE) == 0,
+         "ioring_setup");
+
+  sync_cycles = run_sync (sync_fd);
+  ring_cycles = run_ring (ring_fd);
+  msg ("sync: %d blocks in %llu cycles", BLOCK_CNT, sync_cycles);
+  msg ("ring: %d blocks in %llu cycles", BLOCK_CNT, ring_cycles);
+}
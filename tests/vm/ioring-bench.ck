@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, IGNORE_CYCLES => 1, [<<'EOF']);
+(ioring-bench) begin
+(ioring-bench) create "sync"
+(ioring-bench) open "sync"
+(ioring-bench) create "ring"
+(ioring-bench) open "ring"
+(ioring-bench) ioring_setup
+(ioring-bench) sync: 32 blocks in N cycles
+(ioring-bench) ring: 32 blocks in N cycles
+(ioring-bench) end
+EOF
+pass;
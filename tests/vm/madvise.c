@@ -0,0 +1,65 @@
+/* Gives madvise() hints on an mmap'd file and on anonymous memory.
+   Every hint must leave the data intact: MADV_DONTNEED writes a
+   modified mapped page back before dropping it, so the mapping and
+   the file both keep the change, while an anonymous page reads as
+   zeros again afterward.  Bad hints and addresses are refused. */
+
+#include <round.h>
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/small.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x10000000)
+#define PAGE_SIZE 4096
+
+static char anon[2 * PAGE_SIZE];
+
+void
+test_main (void)
+{
+  static const char data[] = "Written before MADV_DONTNEED.";
+  static char buf[sizeof data - 1];
+  size_t size = ROUND_UP (sizeof small - 1, PAGE_SIZE);
+  char *page = (char *) ROUND_UP ((uintptr_t) anon, PAGE_SIZE);
+  int handle;
+  void *map;
+
+  CHECK ((handle = open ("small.txt")) > 1, "open \"small.txt\"");
+  CHECK ((map = mmap (ACTUAL, size, 1, handle, 0)) != MAP_FAILED,
+         "mmap \"small.txt\"");
+  CHECK (madvise (ACTUAL, size, 99) == -1, "madvise with a bad hint");
+  CHECK (madvise (ACTUAL + 1, size, MADV_NORMAL) == -1,
+         "madvise at a misaligned address");
+
+  CHECK (madvise (ACTUAL, size, MADV_WILLNEED) == 0, "MADV_WILLNEED");
+  if (memcmp (ACTUAL, small, sizeof small - 1))
+    fail ("read after MADV_WILLNEED returned bad data");
+  CHECK (madvise (ACTUAL, size, MADV_SEQUENTIAL) == 0, "MADV_SEQUENTIAL");
+  if (memcmp (ACTUAL, small, sizeof small - 1))
+    fail ("read after MADV_SEQUENTIAL returned bad data");
+  CHECK (madvise (ACTUAL, size, MADV_RANDOM) == 0, "MADV_RANDOM");
+
+  memcpy (ACTUAL + PAGE_SIZE, data, sizeof data - 1);
+  CHECK (madvise (ACTUAL, size, MADV_DONTNEED) == 0, "MADV_DONTNEED");
+  CHECK (get_phys_addr (ACTUAL + PAGE_SIZE) == NULL, "frame was dropped");
+  if (memcmp (ACTUAL + PAGE_SIZE, data, sizeof data - 1))
+    fail ("write lost by MADV_DONTNEED");
+  if (memcmp (ACTUAL, small, PAGE_SIZE))
+    fail ("page 0 changed by MADV_DONTNEED");
+  seek (handle, PAGE_SIZE);
+  CHECK (read (handle, buf, sizeof buf) == (int) sizeof buf,
+         "read \"small.txt\"");
+  if (memcmp (buf, data, sizeof buf))
+    fail ("MADV_DONTNEED did not write the page back");
+  munmap (map);
+
+  memset (page, 'a', PAGE_SIZE);
+  CHECK (madvise (page, PAGE_SIZE, MADV_DONTNEED) == 0,
+         "MADV_DONTNEED on anonymous memory");
+  for (size_t i = 0; i < PAGE_SIZE; i++)
+    if (page[i] != 0)
+      fail ("anonymous page does not read as zeros after MADV_DONTNEED");
+}
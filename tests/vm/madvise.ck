@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(madvise) begin
+(madvise) open "small.txt"
+(madvise) mmap "small.txt"
+(madvise) madvise with a bad hint
+(madvise) madvise at a misaligned address
+(madvise) MADV_WILLNEED
+(madvise) MADV_SEQUENTIAL
+(madvise) MADV_RANDOM
+(madvise) MADV_DONTNEED
+(madvise) frame was dropped
+(madvise) read "small.txt"
+(madvise) MADV_DONTNEED on anonymous memory
+(madvise) end
+EOF
+pass;
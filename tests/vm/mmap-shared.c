@@ -0,0 +1,68 @@
+/* Maps one file in two processes.  The child writes through its
+   mapping and calls msync(), after which the parent sees the
+   change both through its own mapping, which shares the child's
+   frame, and in the file.  The frame is clean again after the
+   msync(), so unmapping it must not write it back over a later
+   write() to the file. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x10000000)
+
+void
+test_main (void)
+{
+  static const char child_data[] = "Written by the child.";
+  static const char parent_data[] = "Written by the parent.";
+  static char buf[sizeof sample - 1];
+  pid_t child;
+  int handle;
+  void *map;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((map = mmap (ACTUAL, 4096, 1, handle, 0)) != MAP_FAILED,
+         "mmap \"sample.txt\"");
+  if (memcmp (ACTUAL, sample, strlen (sample)))
+    fail ("read of mmap'd file reported bad data");
+
+  child = fork ("child");
+  if (child == 0)
+    {
+      /* mmap() regions are not inherited, so map the file again. */
+      CHECK ((handle = open ("sample.txt")) > 1,
+             "open \"sample.txt\" in child");
+      CHECK (mmap (ACTUAL, 4096, 1, handle, 0) != MAP_FAILED,
+             "mmap \"sample.txt\" in child");
+      memcpy (ACTUAL, child_data, strlen (child_data));
+      CHECK (msync (ACTUAL, 4096) == 0, "msync in child");
+      exit (0);
+    }
+  CHECK (wait (child) == 0, "wait for child");
+
+  if (memcmp (ACTUAL, child_data, strlen (child_data)))
+    fail ("child's write not seen through parent's mapping");
+  CHECK (read (handle, buf, sizeof buf) == sizeof buf,
+         "read \"sample.txt\"");
+  if (memcmp (buf, child_data, strlen (child_data))
+      || memcmp (buf + strlen (child_data), sample + strlen (child_data),
+                 sizeof buf - strlen (child_data)))
+    fail ("child's msync did not write the file");
+
+  /* The mapping is clean, so munmap must not undo this write. */
+  seek (handle, 0);
+  CHECK (write (handle, parent_data, strlen (parent_data))
+         == (int) strlen (parent_data), "write \"sample.txt\"");
+  msg ("munmap \"sample.txt\"");
+  munmap (map);
+
+  seek (handle, 0);
+  CHECK (read (handle, buf, sizeof buf) == sizeof buf,
+         "read \"sample.txt\" again");
+  if (memcmp (buf, parent_data, strlen (parent_data)))
+    fail ("munmap wrote back a clean shared frame");
+  msg ("file change was retained after munmap");
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-shared) begin
+(mmap-shared) open "sample.txt"
+(mmap-shared) mmap "sample.txt"
+(mmap-shared) open "sample.txt" in child
+(mmap-shared) mmap "sample.txt" in child
+(mmap-shared) msync in child
+(mmap-shared) wait for child
+(mmap-shared) read "sample.txt"
+(mmap-shared) write "sample.txt"
+(mmap-shared) munmap "sample.txt"
+(mmap-shared) read "sample.txt" again
+(mmap-shared) file change was retained after munmap
+(mmap-shared) end
+EOF
+pass;
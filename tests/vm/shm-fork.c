@@ -0,0 +1,70 @@
+/* Shares a segment between a process and its child.  The child
+   inherits the parent's attachment through fork() and attaches the
+   segment a second time; writes through any attachment are seen
+   through all the others.  The segment keeps its contents while
+   its creator is detached from it, and is freed once the last
+   process holding it goes away. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ADDR1 ((char *) 0x10000000)
+#define ADDR2 ((char *) 0x10100000)
+#define SIZE (2 * 4096)
+
+void
+test_main (void)
+{
+  static const char parent_data[] = "Written by the parent.";
+  static const char child_data[] = "Written by the child.";
+  pid_t child;
+  int id, id2;
+
+  CHECK ((id = shm_create (SIZE)) > 0, "shm_create");
+  CHECK (shm_attach (id, ADDR1) == ADDR1, "shm_attach");
+  if (ADDR1[0] != 0 || ADDR1[SIZE - 1] != 0)
+    fail ("new segment is not zeroed");
+  memcpy (ADDR1, parent_data, sizeof parent_data);
+
+  child = fork ("child");
+  if (child == 0)
+    {
+      if (memcmp (ADDR1, parent_data, sizeof parent_data))
+        fail ("parent's write not seen through inherited attachment");
+      CHECK (shm_attach (id, ADDR2) == ADDR2, "shm_attach in child");
+      if (memcmp (ADDR2, parent_data, sizeof parent_data))
+        fail ("parent's write not seen through second attachment");
+      memcpy (ADDR2 + 4096, child_data, sizeof child_data);
+      if (memcmp (ADDR1 + 4096, child_data, sizeof child_data))
+        fail ("child's write not seen through inherited attachment");
+      CHECK (shm_detach (ADDR2) == 0, "shm_detach in child");
+      CHECK (shm_detach (ADDR2) == -1, "shm_detach again in child");
+      exit (0);
+    }
+  CHECK (wait (child) == 0, "wait for child");
+  if (memcmp (ADDR1 + 4096, child_data, sizeof child_data))
+    fail ("child's write not seen by parent");
+
+  /* The creator holds the segment until it exits. */
+  CHECK (shm_detach (ADDR1) == 0, "shm_detach");
+  CHECK (shm_attach (id, ADDR2) == ADDR2, "shm_attach again");
+  if (memcmp (ADDR2, parent_data, sizeof parent_data)
+      || memcmp (ADDR2 + 4096, child_data, sizeof child_data))
+    fail ("segment lost its contents while detached");
+
+  /* The child exits still attached to the segment it made, which
+     drops the last references to it. */
+  child = fork ("creator");
+  if (child == 0)
+    {
+      id2 = shm_create (4096);
+      if (id2 < 0 || shm_attach (id2, ADDR1) != ADDR1)
+        fail ("shm_create and shm_attach in child failed");
+      ADDR1[0] = 1;
+      exit (id2);
+    }
+  CHECK ((id2 = wait (child)) > id, "wait for creator");
+  CHECK (shm_attach (id2, ADDR1) == NULL, "attach freed segment");
+}
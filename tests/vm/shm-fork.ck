@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(shm-fork) begin
+(shm-fork) shm_create
+(shm-fork) shm_attach
+(shm-fork) shm_attach in child
+(shm-fork) shm_detach in child
+(shm-fork) shm_detach again in child
+(shm-fork) wait for child
+(shm-fork) shm_detach
+(shm-fork) shm_attach again
+(shm-fork) wait for creator
+(shm-fork) attach freed segment
+(shm-fork) end
+EOF
+pass;
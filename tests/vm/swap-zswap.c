@@ -0,0 +1,76 @@
+/* Fills more anonymous memory than fits in RAM with three kinds of
+   pages, to send evicted pages down each path of the compressed
+   swap pool: pages of one repeated 64-bit word, text that
+   compresses well, and random bytes that do not compress and go
+   to the swap disk.  With so many pages the pool also fills up and
+   writes its oldest entries to the disk.  Every page must read
+   back intact.  Pintos runs with 10 MB of memory for this test. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/arc4.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHUNK_SIZE (16 * 1024 * 1024)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+
+static char big_chunks[CHUNK_SIZE];
+
+/* Fills PAGE with what page I of big_chunks should hold. */
+static void
+fill_page (char *page, size_t i)
+{
+  if (i % 3 == 0)
+    {
+      uint64_t *words = (uint64_t *) page;
+      size_t j;
+
+      for (j = 0; j < PAGE_SIZE / sizeof *words; j++)
+        words[j] = i * 0x9e3779b97f4a7c15ULL | 1;
+    }
+  else if (i % 3 == 1)
+    {
+      char line[32];
+      size_t len, ofs;
+
+      len = snprintf (line, sizeof line, "page %06zu of swap-zswap\n", i);
+      for (ofs = 0; ofs < PAGE_SIZE; ofs += len)
+        memcpy (page + ofs, line,
+                PAGE_SIZE - ofs < len ? PAGE_SIZE - ofs : len);
+    }
+  else
+    {
+      struct arc4 arc4;
+
+      memset (page, 0, PAGE_SIZE);
+      arc4_init (&arc4, &i, sizeof i);
+      arc4_crypt (&arc4, page, PAGE_SIZE);
+    }
+}
+
+void
+test_main (void)
+{
+  static char expected[PAGE_SIZE];
+  size_t i;
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    {
+      if (i % 1024 == 0)
+        msg ("write page %zu", i);
+      fill_page (big_chunks + i * PAGE_SIZE, i);
+    }
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    {
+      fill_page (expected, i);
+      if (memcmp (big_chunks + i * PAGE_SIZE, expected, PAGE_SIZE))
+        fail ("page %zu is inconsistent", i);
+      if (i % 1024 == 0)
+        msg ("check page %zu", i);
+    }
+}
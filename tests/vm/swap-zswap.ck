@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-zswap) begin
+(swap-zswap) write page 0
+(swap-zswap) write page 1024
+(swap-zswap) write page 2048
+(swap-zswap) write page 3072
+(swap-zswap) check page 0
+(swap-zswap) check page 1024
+(swap-zswap) check page 2048
+(swap-zswap) check page 3072
+(swap-zswap) end
+EOF
+pass;
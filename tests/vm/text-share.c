@@ -0,0 +1,43 @@
+/* Runs a second copy of this program while the first is still
+   running.  The second copy must map the frame that already holds
+   its code, instead of reading the executable into a frame of its
+   own.  The frame is passed to the second copy on its command
+   line, and it exits with 0 if its own code is there. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+/* Returns the page number of the frame that holds this function's
+   code in this process. */
+static int
+code_frame (void)
+{
+  return (uintptr_t) get_phys_addr ((void *) code_frame) >> 12;
+}
+
+int
+main (int argc, char *argv[])
+{
+  char cmd[64];
+  pid_t child;
+
+  test_name = "text-share";
+  if (argc == 2)
+    return code_frame () == atoi (argv[1]) ? 0 : 1;
+
+  msg ("begin");
+  CHECK (code_frame () != 0, "code is loaded");
+  snprintf (cmd, sizeof cmd, "text-share %d", code_frame ());
+  child = fork ("child");
+  if (child == 0)
+    {
+      exec (cmd);
+      fail ("exec \"%s\" failed", cmd);
+    }
+  CHECK (wait (child) == 0, "second copy shares the code frame");
+  msg ("end");
+  return 0;
+}
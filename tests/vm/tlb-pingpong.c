@@ -0,0 +1,88 @@
+/* Passes a token back and forth between a parent and a forked
+   child through a pair of pipes, each touching its own working set
+   of pages whenever it holds the token.  The process without the
+   token is blocked on its pipe, so every hand-off is an address
+   space switch, and the run time depends on how much of the TLB
+   survives it.
+
+   Used as a benchmark: compare the TSC cycles the rounds take,
+   and the "Paging" line the kernel prints at power off, with and
+   without -no-pcid. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 64
+#define ROUND_CNT 64
+
+static char buf[PAGE_CNT * PAGE_SIZE];
+
+/* Reads the token from FD, blocking until the other process has
+   written it. */
+static void
+take_turn (int fd)
+{
+  char token;
+
+  if (read (fd, &token, 1) != 1)
+    fail ("read token");
+}
+
+/* Touches every page of the working set and passes the token to
+   the other process through OUT, then waits for it to come back
+   through IN, for ROUND_CNT rounds.  The process that does not
+   SERVE waits for the token before each turn instead. */
+static void
+play (int in, int out, bool serve)
+{
+  char token = 0;
+  int round, i;
+
+  for (round = 0; round < ROUND_CNT; round++)
+    {
+      if (!serve)
+        take_turn (in);
+
+      for (i = 0; i < PAGE_CNT; i++)
+        buf[i * PAGE_SIZE]++;
+
+      if (write (out, &token, 1) != 1)
+        fail ("write token");
+      if (serve)
+        take_turn (in);
+    }
+
+  for (i = 0; i < PAGE_CNT; i++)
+    if (buf[i * PAGE_SIZE] != ROUND_CNT)
+      fail ("page %d touched %d times", i, buf[i * PAGE_SIZE]);
+}
+
+void
+test_main (void)
+{
+  unsigned long long cycles;
+  int ping[2], pong[2];
+  pid_t child;
+
+  CHECK (pipe (ping) == 0, "pipe to child");
+  CHECK (pipe (pong) == 0, "pipe from child");
+
+  child = fork ("pong");
+  if (child == 0)
+    {
+      close (ping[1]);
+      close (pong[0]);
+      play (ping[0], pong[1], false);
+      exit (0);
+    }
+  close (ping[0]);
+  close (pong[1]);
+  cycles = rdtsc ();
+  play (pong[0], ping[1], true);
+  cycles = rdtsc () - cycles;
+  CHECK (wait (child) == 0, "wait for child");
+  msg ("%d rounds over %d pages in %llu cycles", ROUND_CNT, PAGE_CNT,
+       cycles);
+}
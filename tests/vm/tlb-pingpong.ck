@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, IGNORE_CYCLES => 1, [<<'EOF']);
+(tlb-pingpong) begin
+(tlb-pingpong) pipe to child
+(tlb-pingpong) pipe from child
+(tlb-pingpong) wait for child
+(tlb-pingpong) 64 rounds over 64 pages in N cycles
+(tlb-pingpong) end
+EOF
+pass;
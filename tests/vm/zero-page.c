@@ -0,0 +1,75 @@
+/* Reads untouched pages of the bss, which must all map one shared
+   zero-filled frame, and then writes to some of them, directly and
+   through read(), each of which must give the page a frame of its
+   own and leave the zero frame zeroed.  A child forked meanwhile
+   shares the zero frame too. */
+
+#include <round.h>
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 4
+
+static char buf[(PAGE_CNT + 1) * PAGE_SIZE];
+
+/* Fails unless the SIZE bytes at P are all zero. */
+static void
+check_zero (const char *p, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    if (p[i] != 0)
+      fail ("byte %zu of %p is %d, not 0", i, p, p[i]);
+}
+
+void
+test_main (void)
+{
+  char *pages = (char *) ROUND_UP ((uintptr_t) buf, PAGE_SIZE);
+  void *zero;
+  pid_t child;
+  int handle;
+  int i;
+
+  check_zero (pages, PAGE_CNT * PAGE_SIZE);
+  zero = get_phys_addr (pages);
+  CHECK (zero != NULL, "read maps a frame");
+  for (i = 1; i < PAGE_CNT; i++)
+    if (get_phys_addr (pages + i * PAGE_SIZE) != zero)
+      fail ("page %d does not map the zero frame", i);
+  msg ("untouched pages share one frame");
+
+  child = fork ("child");
+  if (child == 0)
+    {
+      CHECK (get_phys_addr (pages) == zero, "child maps the zero frame");
+      pages[0] = 'c';
+      exit (0);
+    }
+  CHECK (wait (child) == 0, "wait for child");
+
+  pages[PAGE_SIZE] = 'p';
+  CHECK (get_phys_addr (pages + PAGE_SIZE) != zero,
+         "written page has a frame of its own");
+  if (pages[PAGE_SIZE] != 'p')
+    fail ("write to page 1 was lost");
+  check_zero (pages + PAGE_SIZE + 1, PAGE_SIZE - 1);
+
+  /* Page 3 is mapped read-only to the zero frame, so the kernel
+     must not write through that mapping. */
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (read (handle, pages + 3 * PAGE_SIZE, sizeof sample - 1)
+         == (int) sizeof sample - 1, "read \"sample.txt\" into page 3");
+  if (memcmp (pages + 3 * PAGE_SIZE, sample, sizeof sample - 1))
+    fail ("read into page 3 returned bad data");
+
+  CHECK (get_phys_addr (pages) == zero
+         && get_phys_addr (pages + 2 * PAGE_SIZE) == zero,
+         "other pages still map the zero frame");
+  check_zero (pages, PAGE_SIZE);
+  check_zero (pages + 2 * PAGE_SIZE, PAGE_SIZE);
+}
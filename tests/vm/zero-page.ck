@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(zero-page) begin
+(zero-page) read maps a frame
+(zero-page) untouched pages share one frame
+(zero-page) child maps the zero frame
+(zero-page) wait for child
+(zero-page) written page has a frame of its own
+(zero-page) open "sample.txt"
+(zero-page) read "sample.txt" into page 3
+(zero-page) other pages still map the zero frame
+(zero-page) end
+EOF
+pass;
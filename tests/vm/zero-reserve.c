@@ -0,0 +1,52 @@
+/* Has a child fill many pages with garbage and exit, which frees
+   their frames dirty, and then makes the parent fault in as many
+   new pages of its own, which likely reuse those frames.  Apart
+   from the byte the parent writes to take the fault, each new page
+   must hold only zeros, whether its frame came zeroed from the
+   reserve or was cleared on demand. */
+
+#include <round.h>
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 256
+#define ROUNDS 3
+
+static char buf[(ROUNDS * PAGE_CNT + 1) * PAGE_SIZE];
+
+void
+test_main (void)
+{
+  char *pages = (char *) ROUND_UP ((uintptr_t) buf, PAGE_SIZE);
+  int round;
+  size_t i, j;
+
+  for (round = 0; round < ROUNDS; round++)
+    {
+      char *area = pages + round * PAGE_CNT * PAGE_SIZE;
+      pid_t child = fork ("child");
+
+      if (child == 0)
+        {
+          memset (area, 0xcc, PAGE_CNT * PAGE_SIZE);
+          exit (0);
+        }
+      CHECK (wait (child) == 0, "child dirtied %d pages", PAGE_CNT);
+
+      for (i = 0; i < PAGE_CNT; i++)
+        {
+          char *page = area + i * PAGE_SIZE;
+
+          page[0] = 1;
+          for (j = 1; j < PAGE_SIZE; j++)
+            if (page[j] != 0)
+              fail ("byte %zu of new page %zu is %d, not 0",
+                    j, i, page[j]);
+        }
+      msg ("%d new pages are zeroed", PAGE_CNT);
+    }
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(zero-reserve) begin
+(zero-reserve) child dirtied 256 pages
+(zero-reserve) 256 new pages are zeroed
+(zero-reserve) child dirtied 256 pages
+(zero-reserve) 256 new pages are zeroed
+(zero-reserve) child dirtied 256 pages
+(zero-reserve) 256 new pages are zeroed
+(zero-reserve) end
+EOF
+pass;
@@ -20,7 +20,9 @@
 #include "threads/mmu.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/schedtrace.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -106,6 +108,8 @@ main (void) {
 	thread_start ();
 	serial_init_queue ();
 	timer_calibrate ();
+	workqueue_init ();
+	palloc_zero_init ();
 
 #ifdef FILESYS
 	/* Initialize file system. */
@@ -151,21 +155,42 @@ paging_init (uint64_t mem_end) {
 	pml4 = base_pml4 = palloc_get_page (PAL_ASSERT | PAL_ZERO);
 
 	extern char start, _end_kernel_text;
+	uint64_t text_start = (uint64_t) &start;
+	uint64_t text_end = (uint64_t) &_end_kernel_text;
 	// Maps physical address [0 ~ mem_end] to
 	//   [LOADER_KERN_BASE ~ LOADER_KERN_BASE + mem_end].
-	for (uint64_t pa = 0; pa < mem_end; pa += PGSIZE) {
+	// LOADER_KERN_BASE is 2 MiB aligned, so every 2 MiB chunk that
+	// fits below mem_end is mapped with a single PDE.  Only the
+	// chunks that straddle an edge of the kernel text, whose pages
+	// differ in permissions, fall back to 4 kB pages.  1 GiB pages
+	// are not used: LOADER_KERN_BASE is not 1 GiB aligned.
+	for (uint64_t pa = 0; pa < mem_end; ) {
 		uint64_t va = (uint64_t) ptov(pa);
 
+		if (pa % LPGSIZE == 0 && pa + LPGSIZE <= mem_end
+				&& (va + LPGSIZE <= text_start || text_end <= va
+					|| (text_start <= va && va + LPGSIZE <= text_end))) {
+			perm = PTE_W;
+			if (text_start <= va && va < text_end)
+				perm &= ~PTE_W;
+			if (!pml4_set_large_page (pml4, va, pa, perm))
+				PANIC ("paging_init: out of memory");
+			pa += LPGSIZE;
+			continue;
+		}
+
 		perm = PTE_P | PTE_W;
-		if ((uint64_t) &start <= va && va < (uint64_t) &_end_kernel_text)
+		if (text_start <= va && va < text_end)
 			perm &= ~PTE_W;
 
 		if ((pte = pml4e_walk (pml4, va, 1)) != NULL)
 			*pte = pa | perm;
+		pa += PGSIZE;
 	}
 
 	// reload cr3
 	pml4_activate(0);
+	pml4_init_pcid ();
 }
 
 /* Breaks the kernel command line into words and returns them as
@@ -221,6 +246,12 @@ parse_options (char **argv) {
 			random_init (atoi (value));
 		else if (!strcmp (name, "-mlfqs"))
 			thread_mlfqs = true;
+		else if (!strcmp (name, "-stride"))
+			thread_stride = true;
+		else if (!strcmp (name, "-schedtrace"))
+			schedtrace_dump = true;
+		else if (!strcmp (name, "-no-pcid"))
+			pcid_disabled = true;
 #ifdef USERPROG
 		else if (!strcmp (name, "-ul"))
 			user_page_limit = atoi (value);
@@ -276,6 +307,7 @@ run_actions (char **argv) {
 		{"rm", 2, fsutil_rm},
 		{"put", 2, fsutil_put},
 		{"get", 2, fsutil_get},
+		{"schedtrace", 2, fsutil_schedtrace},
 #endif
 		{NULL, 0, NULL},
 	};
@@ -323,6 +355,7 @@ usage (void) {
 			"  ls                 List files in the root directory.\n"
 			"  cat FILE           Print FILE to the console.\n"
 			"  rm FILE            Delete FILE.\n"
+			"  schedtrace FILE    Save the scheduler event trace to FILE.\n"
 			"Use these actions indirectly via `pintos' -g and -p options:\n"
 			"  put FILE           Put FILE into file system from scratch disk.\n"
 			"  get FILE           Get FILE from file system into scratch disk.\n"
@@ -333,6 +366,9 @@ usage (void) {
 			"  -f                 Format file system disk during startup.\n"
 			"  -rs=SEED           Set random number seed to SEED.\n"
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
+			"  -stride            Use stride (proportional-share) scheduler.\n"
+			"  -schedtrace        Dump the scheduler event trace at power off.\n"
+			"  -no-pcid           Flush the TLB on every address space switch.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -361,6 +397,8 @@ static void
 print_stats (void) {
 	timer_print_stats ();
 	thread_print_stats ();
+	palloc_print_stats ();
+	pml4_print_stats ();
 #ifdef FILESYS
 	disk_print_stats ();
 #endif
@@ -369,4 +407,12 @@ print_stats (void) {
 #ifdef USERPROG
 	exception_print_stats ();
 #endif
+#ifdef VM
+	vm_print_stats ();
+#endif
+#ifdef LOCKSTAT
+	lockstat_print_stats ();
+#endif
+	if (schedtrace_dump)
+		schedtrace_print ();
 }
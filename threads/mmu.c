@@ -1,15 +1,92 @@
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "intrinsic.h"
 
+/* Process-context identifiers (PCIDs).
+
+   With CR4.PCIDE set, the low 12 bits of CR3 tag every TLB entry
+   the CPU creates, and a CR3 write with CR3_NOFLUSH set keeps the
+   entries of all PCIDs.  Switching between processes then no
+   longer throws away their translations.
+
+   A pml4 does not carry any state of its own, so PCIDs are handed
+   out from a direct-mapped table indexed by the pml4's frame
+   number.  PCID 0 always belongs to base_pml4.  pcid_owner[]
+   records which pml4 the TLB entries tagged with each PCID came
+   from; a pml4 whose slot was taken over, or whose entries were
+   changed while it was not loaded, is activated with a flushing
+   CR3 write. */
+#define PCID_CNT 4096
+#define CR3_NOFLUSH (1ULL << 63)
+#define CR4_PCIDE (1ULL << 17)
+#define CPUID_PCID (1 << 17)              /* CPUID.01H:ECX. */
+
+bool pcid_disabled;                      /* Set by -no-pcid. */
+static bool pcid_enabled;
+static uint64_t *pcid_owner[PCID_CNT];
+
+/* CR3 statistics. */
+static long long cr3_loads;             /* CR3 writes. */
+static long long cr3_flushes;           /* CR3 writes that flushed the TLB. */
+static long long cr3_skipped;           /* Activations that needed no write. */
+
+static unsigned
+pml4_pcid (uint64_t *pml4) {
+	if (pml4 == base_pml4)
+		return 0;
+	return 1 + (vtop (pml4) >> PGBITS) % (PCID_CNT - 1);
+}
+
+/* Invalidates the TLB entry for VA in PML4 after its PTE
+ * changed.  If PML4 is not loaded, its PCID is given up instead,
+ * so that the next pml4_activate() flushes. */
+static void
+pml4_invalidate (uint64_t *pml4, uint64_t va) {
+	enum intr_level old_level = intr_disable ();
+	if (PTE_ADDR (rcr3 ()) == vtop (pml4))
+		invlpg (va);
+	else if (pcid_enabled && pcid_owner[pml4_pcid (pml4)] == pml4)
+		pcid_owner[pml4_pcid (pml4)] = NULL;
+	intr_set_level (old_level);
+}
+
+/* Replaces the large page mapped by *ENTRY, which covers SIZE
+ * bytes starting at VA, by a table of 512 entries mapping the
+ * same memory with the same permissions in SIZE / 512 byte
+ * pages.  Returns false if out of memory. */
+static bool
+split_large_page (uint64_t *entry, uint64_t va, uint64_t size) {
+	uint64_t *table = palloc_get_page (0);
+	uint64_t base = PTE_ADDR (*entry) & ~(size - 1);
+	uint64_t flags = *entry & PTE_FLAGS;
+	uint64_t child = size / 512;
+
+	if (table == NULL)
+		return false;
+	if (child == PGSIZE)
+		flags &= ~PTE_PS;
+	for (unsigned i = 0; i < 512; i++)
+		table[i] = (base + i * child) | flags;
+	*entry = vtop (table) | PTE_U | PTE_W | PTE_P;
+	invlpg (va);
+	return true;
+}
+
+/* The walkers below return the entry that maps VA.  That is a
+ * PTE, or a PDE or PDPE with PTE_PS set if VA lies in a large
+ * page and CREATE is false.  With CREATE, large pages on the way
+ * are split so that a PTE is always returned.  If SIZE is
+ * nonnull, the size of the page the entry maps is stored there. */
 static uint64_t *
-pgdir_walk (uint64_t *pdp, const uint64_t va, int create) {
+pgdir_walk (uint64_t *pdp, const uint64_t va, int create, uint64_t *size) {
 	int idx = PDX (va);
 	if (pdp) {
 		uint64_t *pte = (uint64_t *) pdp[idx];
@@ -22,14 +99,24 @@ pgdir_walk (uint64_t *pdp, const uint64_t va, int create) {
 					return NULL;
 			} else
 				return NULL;
+		} else if (pdp[idx] & PTE_PS) {
+			if (!create) {
+				if (size)
+					*size = LPGSIZE;
+				return &pdp[idx];
+			}
+			if (!split_large_page (&pdp[idx], va, LPGSIZE))
+				return NULL;
 		}
+		if (size)
+			*size = PGSIZE;
 		return (uint64_t *) ptov (PTE_ADDR (pdp[idx]) + 8 * PTX (va));
 	}
 	return NULL;
 }
 
 static uint64_t *
-pdpe_walk (uint64_t *pdpe, const uint64_t va, int create) {
+pdpe_walk (uint64_t *pdpe, const uint64_t va, int create, uint64_t *size) {
 	uint64_t *pte = NULL;
 	int idx = PDPE (va);
 	int allocated = 0;
@@ -45,8 +132,16 @@ pdpe_walk (uint64_t *pdpe, const uint64_t va, int create) {
 					return NULL;
 			} else
 				return NULL;
+		} else if (pdpe[idx] & PTE_PS) {
+			if (!create) {
+				if (size)
+					*size = HPGSIZE;
+				return &pdpe[idx];
+			}
+			if (!split_large_page (&pdpe[idx], va, HPGSIZE))
+				return NULL;
 		}
-		pte = pgdir_walk (ptov (PTE_ADDR (pdpe[idx])), va, create);
+		pte = pgdir_walk (ptov (PTE_ADDR (pdpe[idx])), va, create, size);
 	}
 	if (pte == NULL && allocated) {
 		palloc_free_page ((void *) ptov (PTE_ADDR (pdpe[idx])));
@@ -55,15 +150,8 @@ pdpe_walk (uint64_t *pdpe, const uint64_t va, int create) {
 	return pte;
 }
 
-/* Returns the address of the page table entry for virtual
- * address VADDR in page map level 4, pml4.
- * If PML4E does not have a page table for VADDR, behavior depends
- * on CREATE.  If CREATE is true, then a new page table is
- * created and a pointer into it is returned.  Otherwise, a null
- * pointer is returned. */
-/*uint64_t *pte = pml4e_walk (pml4, (uint64_t) upage, 1);*/
-uint64_t *
-pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
+static uint64_t *
+walk (uint64_t *pml4e, const uint64_t va, int create, uint64_t *size) {
 	uint64_t *pte = NULL;
 	int idx = PML4 (va);
 	int allocated = 0;
@@ -80,7 +168,7 @@ pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
 			} else
 				return NULL;
 		}
-		pte = pdpe_walk (ptov (PTE_ADDR (pml4e[idx])), va, create);
+		pte = pdpe_walk (ptov (PTE_ADDR (pml4e[idx])), va, create, size);
 	}
 	if (pte == NULL && allocated) {
 		palloc_free_page ((void *) ptov (PTE_ADDR (pml4e[idx])));
@@ -89,6 +177,44 @@ pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
 	return pte;
 }
 
+/* Returns the address of the page table entry for virtual
+ * address VADDR in page map level 4, pml4.
+ * If PML4E does not have a page table for VADDR, behavior depends
+ * on CREATE.  If CREATE is true, then a new page table is
+ * created and a pointer into it is returned.  Otherwise, a null
+ * pointer is returned.
+ * If VADDR lies in a large page and CREATE is false, the PDE or
+ * PDPE mapping it is returned; it has PTE_PS set.  If CREATE is
+ * true, the large page is split and a PTE is returned. */
+/*uint64_t *pte = pml4e_walk (pml4, (uint64_t) upage, 1);*/
+uint64_t *
+pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
+	return walk (pml4e, va, create, NULL);
+}
+
+/* Maps the 2 MiB page at physical address PA at VA in PML4 with a
+ * single PDE, using permission bits FLAGS.  VA and PA must be 2
+ * MiB aligned, and VA must not be mapped yet.  Returns false if
+ * out of memory. */
+bool
+pml4_set_large_page (uint64_t *pml4, uint64_t va, uint64_t pa, uint64_t flags) {
+	uint64_t *pdpe, *pde;
+
+	ASSERT (va % LPGSIZE == 0);
+	ASSERT (pa % LPGSIZE == 0);
+
+	/* Let the walker build the upper levels, then take the
+	 * directory the 4 kB table would have been hung from. */
+	if (walk (pml4, va, 1, NULL) == NULL)
+		return false;
+	pdpe = ptov (PTE_ADDR (pml4[PML4 (va)]));
+	pde = ptov (PTE_ADDR (pdpe[PDPE (va)]));
+	ASSERT (!(pde[PDX (va)] & PTE_PS));
+	palloc_free_page (ptov (PTE_ADDR (pde[PDX (va)])));
+	pde[PDX (va)] = pa | flags | PTE_PS | PTE_P;
+	return true;
+}
+
 /* Creates a new page map level 4 (pml4) has mappings for kernel
  * virtual addresses, but none for user virtual addresses.
  * Returns the new page directory, or a null pointer if memory
@@ -123,10 +249,17 @@ pgdir_for_each (uint64_t *pdp, pte_for_each_func *func, void *aux,
 		unsigned pml4_index, unsigned pdp_index) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
-		if (((uint64_t) pte) & PTE_P)
-			if (!pt_for_each ((uint64_t *) PTE_ADDR (pte), func, aux,
-					pml4_index, pdp_index, i))
+		if (!(((uint64_t) pte) & PTE_P))
+			continue;
+		if (pdp[i] & PTE_PS) {
+			void *va = (void *) (((uint64_t) pml4_index << PML4SHIFT) |
+								 ((uint64_t) pdp_index << PDPESHIFT) |
+								 ((uint64_t) i << PDXSHIFT));
+			if (!func (&pdp[i], va, aux))
 				return false;
+		} else if (!pt_for_each ((uint64_t *) PTE_ADDR (pte), func, aux,
+					pml4_index, pdp_index, i))
+			return false;
 	}
 	return true;
 }
@@ -136,15 +269,23 @@ pdp_for_each (uint64_t *pdp,
 		pte_for_each_func *func, void *aux, unsigned pml4_index) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pde = ptov((uint64_t *) pdp[i]);
-		if (((uint64_t) pde) & PTE_P)
-			if (!pgdir_for_each ((uint64_t *) PTE_ADDR (pde), func,
-					 aux, pml4_index, i))
+		if (!(((uint64_t) pde) & PTE_P))
+			continue;
+		if (pdp[i] & PTE_PS) {
+			void *va = (void *) (((uint64_t) pml4_index << PML4SHIFT) |
+								 ((uint64_t) i << PDPESHIFT));
+			if (!func (&pdp[i], va, aux))
 				return false;
+		} else if (!pgdir_for_each ((uint64_t *) PTE_ADDR (pde), func,
+					 aux, pml4_index, i))
+			return false;
 	}
 	return true;
 }
 
-/* Apply FUNC to each available pte entries including kernel's. */
+/* Apply FUNC to each available pte entries including kernel's.
+ * A large page is passed to FUNC once, as its PDE or PDPE with
+ * PTE_PS set, together with the address it starts at. */
 bool
 pml4_for_each (uint64_t *pml4, pte_for_each_func *func, void *aux) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
@@ -197,14 +338,62 @@ pml4_destroy (uint64_t *pml4) {
 	uint64_t *pdpe = ptov ((uint64_t *) pml4[0]);
 	if (((uint64_t) pdpe) & PTE_P)
 		pdpe_destroy ((void *) PTE_ADDR (pdpe));
+	if (pcid_owner[pml4_pcid (pml4)] == pml4)
+		pcid_owner[pml4_pcid (pml4)] = NULL;
 	palloc_free_page ((void *) pml4);
 }
 
+/* Turns on PCIDs if the CPU supports them and they were not
+ * disabled on the command line.  Must be called with base_pml4
+ * loaded. */
+void
+pml4_init_pcid (void) {
+	uint32_t eax, ebx, ecx, edx;
+
+	cpuid (1, 0, &eax, &ebx, &ecx, &edx);
+	if (pcid_disabled || !(ecx & CPUID_PCID))
+		return;
+
+	/* CR4.PCIDE may only be set while CR3 holds PCID 0. */
+	ASSERT (rcr3 () == vtop (base_pml4));
+	lcr4 (rcr4 () | CR4_PCIDE);
+	pcid_owner[0] = base_pml4;
+	pcid_enabled = true;
+}
+
 /* Loads page directory PD into the CPU's page directory base
- * register. */
+ * register.  Does nothing if PD is already loaded. */
 void
 pml4_activate (uint64_t *pml4) {
-	lcr3 (vtop (pml4 ? pml4 : base_pml4));
+	uint64_t *target = pml4 ? pml4 : base_pml4;
+	uint64_t cr3 = vtop (target);
+	enum intr_level old_level = intr_disable ();
+
+	if (PTE_ADDR (rcr3 ()) == cr3)
+		cr3_skipped++;
+	else {
+		if (pcid_enabled) {
+			unsigned pcid = pml4_pcid (target);
+			cr3 |= pcid;
+			if (pcid_owner[pcid] == target)
+				cr3 |= CR3_NOFLUSH;
+			else {
+				pcid_owner[pcid] = target;
+				cr3_flushes++;
+			}
+		} else
+			cr3_flushes++;
+		lcr3 (cr3);
+		cr3_loads++;
+	}
+	intr_set_level (old_level);
+}
+
+/* Prints CR3 statistics. */
+void
+pml4_print_stats (void) {
+	printf ("Paging: PCID %s, %lld CR3 loads (%lld flushing), %lld skipped\n",
+			pcid_enabled ? "on" : "off", cr3_loads, cr3_flushes, cr3_skipped);
 }
 
 /* Looks up the physical address that corresponds to user virtual
@@ -216,10 +405,12 @@ void *
 pml4_get_page (uint64_t *pml4, const void *uaddr) {
 	ASSERT (is_user_vaddr (uaddr));
 
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) uaddr, 0);
+	uint64_t size;
+	uint64_t *pte = walk (pml4, (uint64_t) uaddr, 0, &size);
 	/* 만약 해당 가상 메모리가 물리메모리에 매핑되지 않았다면 NULL pointer를 리턴 */
 	if (pte && (*pte & PTE_P))
-		return ptov (PTE_ADDR (*pte)) + pg_ofs (uaddr);
+		return ptov ((PTE_ADDR (*pte) & ~(size - 1))
+				+ ((uint64_t) uaddr & (size - 1)));
 	return NULL;
 }
 
@@ -259,8 +450,7 @@ pml4_clear_page (uint64_t *pml4, void *upage) {
 
 	if (pte != NULL && (*pte & PTE_P) != 0) {
 		*pte &= ~PTE_P;
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) upage);
+		pml4_invalidate (pml4, (uint64_t) upage);
 	}
 }
 
@@ -285,8 +475,7 @@ pml4_set_dirty (uint64_t *pml4, const void *vpage, bool dirty) {
 		else
 			*pte &= ~(uint32_t) PTE_D;
 
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) vpage);
+		pml4_invalidate (pml4, (uint64_t) vpage);
 	}
 }
 
@@ -311,7 +500,6 @@ pml4_set_accessed (uint64_t *pml4, const void *vpage, bool accessed) {
 		else
 			*pte &= ~(uint32_t) PTE_A;
 
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) vpage);
+		pml4_invalidate (pml4, (uint64_t) vpage);
 	}
 }
@@ -8,8 +8,10 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 #include "threads/vaddr.h"
 
 /* Page allocator.  Hands out memory in page-size (or
@@ -22,15 +24,29 @@
    that the kernel needs to have memory for its own operations
    even if user processes are swapping like mad.
 
+   Each pool also keeps a small reserve of pages that a low
+   priority thread has already zeroed, so that single-page
+   PAL_ZERO allocations, which page tables, new threads and
+   anonymous page faults all make, usually skip the memset.
+   Reserved pages count as free: any allocation takes one once the
+   pool's bitmap is empty.
+
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
    kernel pool, but that's just fine for demonstration purposes. */
 
+/* Pre-zeroed pages kept in each pool. */
+#define ZERO_RESERVE 32
+
 /* A memory pool. */
 struct pool {
 	struct lock lock;               /* Mutual exclusion. */
 	struct bitmap *used_map;        /* Bitmap of free pages. */
 	uint8_t *base;                  /* Base of pool. */
+	size_t free_cnt;                /* Number of free pages. */
+	size_t usable_cnt;              /* Number of pages it ever had. */
+	void *zeroed[ZERO_RESERVE];     /* Pages zeroed ahead of time. */
+	size_t zeroed_cnt;              /* Number of them. */
 };
 
 /* Two pools: one for kernel data, one for user pages. */
@@ -38,10 +54,22 @@ static struct pool kernel_pool, user_pool;
 
 /* Maximum number of pages to put in user pool. */
 size_t user_page_limit = SIZE_MAX;
+
+/* Wakes the zeroing thread, once it is running. */
+static struct semaphore zero_sema;
+static bool zero_started;
+
+/* Statistics. */
+static long long zero_hit_cnt;          /* PAL_ZERO pages from a reserve. */
+static long long zero_miss_cnt;         /* ...zeroed on the spot. */
+static long long zeroed_cnt;            /* Pages zeroed ahead of time. */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
 static bool page_from_pool (const struct pool *, void *page);
+static void pool_count (struct pool *, long page_cnt);
+static void *reserve_take (struct pool *);
+static void zero_thread (void *aux);
 
 /* multiboot info */
 struct multiboot_info {
@@ -224,11 +252,15 @@ split:
 			if ((uint64_t) pool_end < end) {
 				page_cnt = ((uint64_t) pool_end - start) / PGSIZE;
 				bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+				pool->free_cnt += page_cnt;
+				pool->usable_cnt += page_cnt;
 				start = (uint64_t) pool_end;
 				goto split;
 			} else {
 				page_cnt = ((uint64_t) end - start) / PGSIZE;
 				bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+				pool->free_cnt += page_cnt;
+				pool->usable_cnt += page_cnt;
 			}
 		}
 	}
@@ -264,13 +296,27 @@ void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool; // 초기설정에는 False이므로, kernel로 설정.
 
+	/* 0으로 채운 한 페이지는 미리 채워 둔 것에서 먼저 꺼낸다 */
+	if (page_cnt == 1 && (flags & PAL_ZERO)) {
+		void *page = reserve_take (pool);
+
+		if (page != NULL) {
+			zero_hit_cnt++;
+			return page;
+		}
+		zero_miss_cnt++;
+	}
+
 	lock_acquire (&pool->lock);
 	size_t page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
 	lock_release (&pool->lock);
 	void *pages;
 
-	if (page_idx != BITMAP_ERROR)
+	if (page_idx != BITMAP_ERROR) {
 		pages = pool->base + PGSIZE * page_idx;
+		pool_count (pool, -(long) page_cnt);
+	} else if (page_cnt == 1)
+		pages = reserve_take (pool);
 	else
 		pages = NULL;
 
@@ -321,6 +367,7 @@ palloc_free_multiple (void *pages, size_t page_cnt) {
 #endif
 	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
 	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+	pool_count (pool, page_cnt);
 }
 
 /* Frees the page at PAGE. */
@@ -329,6 +376,91 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
+/* Starts the thread that keeps the reserves of zeroed pages
+   filled.  Called once threads are running. */
+void
+palloc_zero_init (void) {
+	sema_init (&zero_sema, 0);
+	zero_started = true;
+	thread_create ("zeroer", PRI_MIN, zero_thread, NULL);
+}
+
+/* Takes a zeroed page out of POOL's reserve and wakes the zeroing
+   thread to replace it.  Returns a null pointer if the reserve is
+   empty. */
+static void *
+reserve_take (struct pool *pool) {
+	void *page = NULL;
+
+	lock_acquire (&pool->lock);
+	if (pool->zeroed_cnt > 0)
+		page = pool->zeroed[--pool->zeroed_cnt];
+	lock_release (&pool->lock);
+
+	if (page != NULL) {
+		pool_count (pool, -1);
+		if (zero_started && zero_sema.value == 0)
+			sema_up (&zero_sema);
+	}
+	return page;
+}
+
+/* Zeroes a free page of POOL into its reserve.  Returns false if
+   the reserve is full or the pool has no free page. */
+static bool
+reserve_fill (struct pool *pool) {
+	size_t page_idx;
+	void *page;
+
+	lock_acquire (&pool->lock);
+	page_idx = pool->zeroed_cnt < ZERO_RESERVE
+		? bitmap_scan_and_flip (pool->used_map, 0, 1, false) : BITMAP_ERROR;
+	lock_release (&pool->lock);
+	if (page_idx == BITMAP_ERROR)
+		return false;
+
+	/* 페이지는 여전히 빈 것으로 센다 */
+	page = pool->base + PGSIZE * page_idx;
+	memset (page, 0, PGSIZE);
+	lock_acquire (&pool->lock);
+	pool->zeroed[pool->zeroed_cnt++] = page;
+	lock_release (&pool->lock);
+	zeroed_cnt++;
+	return true;
+}
+
+/* Refills the reserves whenever woken, at the lowest priority, so
+   that it only runs when nothing else would.  Under -stride it
+   gets the smallest share of the CPU instead. */
+static void
+zero_thread (void *aux UNUSED) {
+	/* -stride는 우선순위를 보지 않으므로 ticket을 최소로 둔다 */
+	thread_set_tickets (TICKETS_MIN);
+	for (;;) {
+		while (reserve_fill (&kernel_pool) | reserve_fill (&user_pool))
+			continue;
+		sema_down (&zero_sema);
+	}
+}
+
+/* Prints page allocator statistics. */
+void
+palloc_print_stats (void) {
+	printf ("Palloc: %lld of %lld zeroed pages from the reserve, "
+			"%lld pages zeroed ahead\n", zero_hit_cnt,
+			zero_hit_cnt + zero_miss_cnt, zeroed_cnt);
+}
+
+/* Returns the number of free pages in the user pool, and stores
+   the number of pages it has in all in *TOTAL if TOTAL is
+   nonnull. */
+size_t
+palloc_user_free (size_t *total) {
+	if (total != NULL)
+		*total = user_pool.usable_cnt;
+	return user_pool.free_cnt;
+}
+
 /* Initializes pool P as starting at START and ending at END */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
@@ -348,6 +480,16 @@ init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
 	*bm_base += bm_pages;
 }
 
+/* Adds PAGE_CNT, which may be negative, to POOL's count of free
+   pages.  Pages are freed without the pool's lock, even with
+   interrupts off, so the count is updated with them off. */
+static void
+pool_count (struct pool *pool, long page_cnt) {
+	enum intr_level old_level = intr_disable ();
+	pool->free_cnt += page_cnt;
+	intr_set_level (old_level);
+}
+
 /* Returns true if PAGE was allocated from POOL,
    false otherwise. */
 static bool
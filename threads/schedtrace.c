@@ -0,0 +1,100 @@
+#include "threads/schedtrace.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "intrinsic.h"
+
+/* Scheduler event trace.
+
+   Every scheduling decision is recorded in a fixed-size ring
+   together with the time-stamp counter, so that run-queue
+   latency and off-CPU time can be reconstructed afterwards by
+   utils/schedtrace-report without sprinkling printf() through
+   the scheduler (which is not allowed in schedule() anyway).
+   Once the ring is full the oldest events are overwritten. */
+
+/* Number of events kept.  Must be a power of 2. */
+#define SCHEDTRACE_SIZE 4096
+
+struct sched_event {
+	uint64_t tsc;               /* Time-stamp counter. */
+	int64_t arg;                /* Event-specific argument. */
+	int tid;                    /* Thread the event is about. */
+	char type;                  /* One of enum sched_event_type. */
+};
+
+static struct sched_event ring[SCHEDTRACE_SIZE];
+static uint64_t recorded;       /* Total number of events recorded. */
+static bool frozen;             /* Drop events while formatting. */
+
+bool schedtrace_dump;
+
+/* Records an event of the given TYPE for thread TID.
+   May be called from any context, including schedule() and
+   interrupt handlers. */
+void
+schedtrace_record (enum sched_event_type type, int tid, int64_t arg) {
+	enum intr_level old_level = intr_disable ();
+
+	if (!frozen) {
+		struct sched_event *e = &ring[recorded++ & (SCHEDTRACE_SIZE - 1)];
+		e->tsc = rdtsc ();
+		e->arg = arg;
+		e->tid = tid;
+		e->type = type;
+	}
+	intr_set_level (old_level);
+}
+
+/* Returns the number of bytes schedtrace_format() may need. */
+size_t
+schedtrace_format_size (void) {
+	return (SCHEDTRACE_SIZE + 1) * SCHEDTRACE_LINE_MAX;
+}
+
+static int
+format_event (const struct sched_event *e, char *buf, size_t size) {
+	return snprintf (buf, size, "st %016llx %c %d %lld\n",
+			(unsigned long long) e->tsc, e->type, e->tid, (long long) e->arg);
+}
+
+static int
+format_header (uint64_t first, char *buf, size_t size) {
+	return snprintf (buf, size, "# schedtrace: %llu events, %llu overwritten\n",
+			(unsigned long long) (recorded - first), (unsigned long long) first);
+}
+
+/* Writes the trace, oldest event first, into BUF of SIZE bytes
+   and returns the number of bytes written.  Events recorded
+   while formatting are dropped. */
+size_t
+schedtrace_format (char *buf, size_t size) {
+	uint64_t first, i;
+	size_t len;
+
+	frozen = true;
+	first = recorded > SCHEDTRACE_SIZE ? recorded - SCHEDTRACE_SIZE : 0;
+	len = format_header (first, buf, size);
+	for (i = first; i < recorded && len + SCHEDTRACE_LINE_MAX <= size; i++)
+		len += format_event (&ring[i & (SCHEDTRACE_SIZE - 1)],
+				buf + len, size - len);
+	frozen = false;
+	return len;
+}
+
+/* Dumps the trace to the console. */
+void
+schedtrace_print (void) {
+	char line[SCHEDTRACE_LINE_MAX];
+	uint64_t first, i;
+
+	frozen = true;
+	first = recorded > SCHEDTRACE_SIZE ? recorded - SCHEDTRACE_SIZE : 0;
+	format_header (first, line, sizeof line);
+	printf ("%s", line);
+	for (i = first; i < recorded; i++) {
+		format_event (&ring[i & (SCHEDTRACE_SIZE - 1)], line, sizeof line);
+		printf ("%s", line);
+	}
+	frozen = false;
+}
@@ -30,7 +30,20 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
+#include "threads/schedtrace.h"
 #include "threads/thread.h"
+#ifdef LOCKSTAT
+#include <stdlib.h>
+#include "intrinsic.h"
+
+/* This file defines the uninstrumented functions; the
+   instrumented wrappers are at the end of it. */
+#undef lock_init
+#undef lock_acquire
+#undef lock_try_acquire
+
+static void lockstat_release (struct lock *);
+#endif
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -179,6 +192,10 @@ lock_init (struct lock *lock) {
 
 	lock->holder = NULL;
 	sema_init (&lock->semaphore, 1);
+#ifdef LOCKSTAT
+	lock->class = NULL;
+	lock->stat = NULL;
+#endif
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -247,6 +264,9 @@ lock_release (struct lock *lock) {
 	ASSERT (lock != NULL);
 	ASSERT (lock_held_by_current_thread (lock));
 
+#ifdef LOCKSTAT
+	lockstat_release (lock);
+#endif
 	remove_with_lock(lock); // donations 리스트에서 해당 lock을 필요로하는 쓰레드를 없애준다.
 	refresh_priority(); 	// 현재 쓰레드의 우선순위를 업데이트
 
@@ -381,6 +401,9 @@ void donate_priority(void)
 		
 		struct thread *holder = curr->wait_on_lock->holder;
 		holder->priority = curr->priority; // 우선 순위를 donate
+		if (thread_stride)
+			thread_update_stride (holder); // stride 스케줄러에서는 ticket을 빌려준다
+		schedtrace_record (SCHED_DONATE, curr->tid, holder->tid);
 		curr = holder; // 다음 depth로 가기 위해 curr 갱신
 	}
 }
@@ -412,6 +435,8 @@ void refresh_priority(void)
 		if (front->priority > curr->priority) // 만약 초기 우선 순위보다 더 큰 값이라면.
 			curr->priority = front->priority;
 	}
+	if (thread_stride)
+		thread_update_stride (curr); // 빌린 ticket도 다시 계산
 }
 
 bool cmp_donation_priority (const struct list_elem *a, const struct list_elem *b, void *aux) {
@@ -421,3 +446,150 @@ bool cmp_donation_priority (const struct list_elem *a, const struct list_elem *b
 	return (thread_a->priority > thread_b->priority) ? 1 : 0;
 }
 
+#ifdef LOCKSTAT
+/* Contention statistics for one (lock class, acquisition site)
+   pair.  A lock's class is the place it was initialized at, so
+   e.g. all malloc descriptor locks share one class. */
+struct lockstat {
+	const char *class;          /* lock_init() site, null if unused. */
+	const char *site;           /* lock_acquire() site. */
+	uint64_t acquired;          /* Number of acquisitions. */
+	uint64_t contended;         /* Acquisitions that had to wait. */
+	uint64_t wait_total;        /* Cycles spent waiting. */
+	uint64_t wait_max;
+	uint64_t hold_total;        /* Cycles the lock was held. */
+	uint64_t hold_max;
+};
+
+/* Open-addressed table of statistics, keyed on the addresses of
+   the site strings.  Pairs that do not fit are lumped together
+   in lockstat_overflow. */
+#define LOCKSTAT_CNT 256
+static struct lockstat lockstats[LOCKSTAT_CNT];
+static struct lockstat lockstat_overflow = {
+	.class = "(overflow)", .site = "(overflow)",
+};
+
+/* Returns the statistics for CLASS and SITE.  Called with
+   interrupts off. */
+static struct lockstat *
+lockstat_lookup (const char *class, const char *site) {
+	size_t h = ((uintptr_t) class * 31 + (uintptr_t) site) % LOCKSTAT_CNT;
+	size_t i;
+
+	if (class == NULL)
+		class = "(no lock_init)";
+	for (i = 0; i < LOCKSTAT_CNT; i++) {
+		struct lockstat *s = &lockstats[(h + i) % LOCKSTAT_CNT];
+		if (s->class == NULL) {
+			s->class = class;
+			s->site = site;
+			return s;
+		}
+		if (s->class == class && s->site == site)
+			return s;
+	}
+	return &lockstat_overflow;
+}
+
+/* Records that LOCK was acquired at SITE after WAIT cycles. */
+static void
+lockstat_acquired (struct lock *lock, const char *site, bool contended,
+		uint64_t wait) {
+	enum intr_level old_level = intr_disable ();
+	struct lockstat *s = lockstat_lookup (lock->class, site);
+
+	s->acquired++;
+	if (contended) {
+		s->contended++;
+		s->wait_total += wait;
+		if (wait > s->wait_max)
+			s->wait_max = wait;
+	}
+	lock->stat = s;
+	lock->acquire_tsc = rdtsc ();
+	intr_set_level (old_level);
+}
+
+/* Charges the time LOCK was held to its acquisition site. */
+static void
+lockstat_release (struct lock *lock) {
+	enum intr_level old_level;
+	struct lockstat *s = lock->stat;
+	uint64_t hold;
+
+	if (s == NULL)
+		return;
+	hold = rdtsc () - lock->acquire_tsc;
+	old_level = intr_disable ();
+	s->hold_total += hold;
+	if (hold > s->hold_max)
+		s->hold_max = hold;
+	lock->stat = NULL;
+	intr_set_level (old_level);
+}
+
+void
+lock_init_at (struct lock *lock, const char *class) {
+	lock_init (lock);
+	lock->class = class;
+}
+
+void
+lock_acquire_at (struct lock *lock, const char *site) {
+	bool contended = lock->holder != NULL;
+	uint64_t start = rdtsc ();
+
+	lock_acquire (lock);
+	lockstat_acquired (lock, site, contended, rdtsc () - start);
+}
+
+bool
+lock_try_acquire_at (struct lock *lock, const char *site) {
+	if (!lock_try_acquire (lock))
+		return false;
+	lockstat_acquired (lock, site, false, 0);
+	return true;
+}
+
+/* Orders statistics by total wait, then by acquisitions. */
+static int
+lockstat_compare (const void *a_, const void *b_) {
+	const struct lockstat *a = a_;
+	const struct lockstat *b = b_;
+
+	if (a->wait_total != b->wait_total)
+		return a->wait_total < b->wait_total ? 1 : -1;
+	if (a->acquired != b->acquired)
+		return a->acquired < b->acquired ? 1 : -1;
+	return 0;
+}
+
+/* Prints lock statistics, most waited-for first. */
+void
+lockstat_print_stats (void) {
+	static struct lockstat snap[LOCKSTAT_CNT + 1];
+	enum intr_level old_level;
+	size_t cnt = 0, i;
+
+	/* Printing takes the console lock, so work on a copy. */
+	old_level = intr_disable ();
+	for (i = 0; i < LOCKSTAT_CNT; i++)
+		if (lockstats[i].class != NULL)
+			snap[cnt++] = lockstats[i];
+	if (lockstat_overflow.acquired > 0)
+		snap[cnt++] = lockstat_overflow;
+	intr_set_level (old_level);
+
+	qsort (snap, cnt, sizeof *snap, lockstat_compare);
+	printf ("Lockstat: %zu lock sites, times in cycles\n", cnt);
+	printf ("%10s %10s %12s %10s %12s %10s  %s\n", "acquired", "contended",
+			"wait-total", "wait-max", "hold-total", "hold-max", "class <- site");
+	for (i = 0; i < cnt; i++) {
+		struct lockstat *s = &snap[i];
+		printf ("%10llu %10llu %12llu %10llu %12llu %10llu  %s <- %s\n",
+				s->acquired, s->contended, s->wait_total, s->wait_max,
+				s->hold_total, s->hold_max, s->class, s->site);
+	}
+}
+#endif /* LOCKSTAT */
@@ -8,6 +8,7 @@
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
 #include "threads/palloc.h"
+#include "threads/schedtrace.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
 #include "intrinsic.h"
@@ -37,6 +38,22 @@ static struct list sleep_list;
 /* sleep_list의 쓰레드 중 최소 wakeup_tick을 저장 */
 static uint64_t next_tick_to_awake;
 
+/* Run queue of the stride scheduler, ordered by pass.  Used
+   instead of ready_list when thread_stride is set. */
+static struct heap stride_queue;
+
+/* Pass of the thread most recently dispatched by the stride
+   scheduler.  A thread that has been blocked catches up to it so
+   it cannot claim the CPU time it missed while sleeping. */
+static int64_t stride_global_pass;
+
+/* Pass increment per tick for a thread with one ticket. */
+#define STRIDE_ONE (1 << 20)
+
+/* Deepest chain of lock waiters whose tickets a lock holder
+   borrows, as deep as donate_priority() donates. */
+#define STRIDE_LEND_DEPTH 8
+
 /* Idle thread. */
 static struct thread *idle_thread;
 
@@ -44,13 +61,18 @@ static struct thread *idle_thread;
 // 초기 쓰레드 생성
 static struct thread *initial_thread;
 
-/* Lock used by allocate_tid(). */
-static struct lock tid_lock;
-
 /* Thread destruction requests */
 // 제거를 요청할 쓰레드의 앞, 뒤 정보를 담는 구조체
 static struct list destruction_req;
 
+/* Pages of destroyed threads kept for reuse by thread_create(),
+   linked through their dead `elem'.  Only the struct thread at
+   the bottom of a page needs clearing (init_thread() does it), so
+   reusing one skips both the allocator and zeroing the stack. */
+static struct list thread_page_cache;
+static size_t thread_page_cache_cnt;
+#define THREAD_PAGE_CACHE_MAX 16
+
 
 /* Statistics. */
 static long long idle_ticks;    /* idle thread가 수행되는데 걸리는 시간 */
@@ -66,6 +88,10 @@ static unsigned thread_ticks;   /* # of timer ticks since last yield. */
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* If true, use the stride scheduler.
+   Controlled by kernel command-line option "-stride". */
+bool thread_stride;
+
 static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
@@ -74,6 +100,12 @@ static void init_thread (struct thread *, const char *name, int priority);
 static void do_schedule(int status);
 static void schedule (void);
 static tid_t allocate_tid (void);
+static struct thread *alloc_thread_page (void);
+static bool stride_less (const struct heap_elem *, const struct heap_elem *,
+		void *aux);
+static void stride_enqueue (struct thread *);
+static bool stride_preempt (void);
+static void free_thread_page (struct thread *);
 
 /* 1. Alarm Call */
 void thread_sleep(int64_t ticks);				// 실행중인 쓰레드를 슬립으로 바꿈
@@ -129,9 +161,10 @@ void thread_init (void) {
 	lgdt (&gdt_ds);
 
 	/* Init the globla thread context */
-	lock_init (&tid_lock);
 	list_init (&ready_list);
+	heap_init (&stride_queue, stride_less, NULL);
 	list_init (&destruction_req);
+	list_init (&thread_page_cache);
 	list_init (&sleep_list);
 	next_tick_to_awake = INT64_MAX;
 
@@ -176,6 +209,10 @@ void thread_tick (void) {
 	else
 		kernel_ticks++;
 
+	/* Charge the tick to the running thread. */
+	if (thread_stride && t != idle_thread)
+		t->pass += t->stride;
+
 	/* Enforce preemption. */
 	if (++thread_ticks >= TIME_SLICE)
 		intr_yield_on_return ();
@@ -212,28 +249,21 @@ tid_t thread_create (const char *name, int priority,
 	ASSERT (function != NULL);
 
 	/* Allocate thread. */
-	t = palloc_get_page (PAL_ZERO);
+	t = alloc_thread_page ();
 	if (t == NULL)
 		return TID_ERROR;
 
 	/* Initialize thread. */
 	init_thread (t, name, priority);
 	tid = t->tid = allocate_tid ();
+	schedtrace_record (SCHED_CREATE, tid, thread_current ()->tid);
 	
 	struct thread *curr = thread_current();
 	list_push_back(&curr->child_list, &t->child_elem);
 
-	/* project 2 : system call */
-	t->file_descriptor_table = palloc_get_multiple(PAL_ZERO, FDT_PAGES);
-	if (t->file_descriptor_table == NULL) {
-		return TID_ERROR;
-	}
-	t->fdidx = 2; // 0은 stdin, 1은 stdout에 이미 할당
-	t->file_descriptor_table[0] = 1;	// stdin 자리
-	t->file_descriptor_table[1] = 2;	// stdout 자리
+	/* The file descriptor table is allocated by process_init() once
+	 * the thread actually becomes a user process. */
 
-	t->stdin_count = 1;
-	t->stdout_count = 1;
 	/* Call the kernel_thread if it scheduled.
 	 * Note) rdi is 1st argument, and rsi is 2nd argument. */
 	t->tf.rip = (uintptr_t) kernel_thread; // 다음에 자식이 cpu 잡으면 실행될 인스트럭션
@@ -267,6 +297,7 @@ void thread_block (void) {
 	ASSERT (!intr_context ());
 	ASSERT (intr_get_level () == INTR_OFF);
 	thread_current ()->status = THREAD_BLOCKED;
+	schedtrace_record (SCHED_BLOCK, thread_current ()->tid, 0);
 	schedule ();
 }
 
@@ -287,7 +318,14 @@ void thread_unblock (struct thread *t) {
 	// 리스트로 요소를 삽입하는 동안 인터럽트가 발생하지 않도록 인터럽트를 비활성화
 	old_level = intr_disable ();
 	ASSERT (t->status == THREAD_BLOCKED);
-	list_insert_ordered(&ready_list, &t->elem, cmp_priority, NULL);
+	if (thread_stride) {
+		/* Catch up with the threads that kept running. */
+		if (t->pass < stride_global_pass)
+			t->pass = stride_global_pass;
+		stride_enqueue (t);
+	} else
+		list_insert_ordered(&ready_list, &t->elem, cmp_priority, NULL);
+	schedtrace_record (SCHED_UNBLOCK, t->tid, thread_current ()->tid);
 	// 인터럽트 원복
 	intr_set_level (old_level);
 }
@@ -333,6 +371,7 @@ void thread_exit (void) {
 	/* Just set our status to dying and schedule another process.
 	   We will be destroyed during the call to schedule_tail(). */
 	intr_disable ();
+	schedtrace_record (SCHED_EXIT, thread_current ()->tid, 0);
 	do_schedule (THREAD_DYING);
 	NOT_REACHED ();
 }
@@ -347,9 +386,14 @@ void thread_yield (void) {
 	ASSERT (!intr_context ()); // 외부 인터럽트를 수행중이라면 종료. 외부 인터럽트는 인터럽트를 당하면 안된다
 
 	old_level = intr_disable (); // 인터럽트 중지 및 이전 인터럽트 상태 저장
-	if (curr != idle_thread) // 현재 쓰레드가 idle 쓰레드가 아니라면
+	if (curr != idle_thread) { // 현재 쓰레드가 idle 쓰레드가 아니라면
 		// list_push_back (&ready_list, &curr->elem); // 현재 스레드를 대기큐의 마지막으로 보냄
-		list_insert_ordered(&ready_list, &curr->elem, cmp_priority, NULL);
+		if (thread_stride)
+			stride_enqueue (curr);
+		else
+			list_insert_ordered(&ready_list, &curr->elem, cmp_priority, NULL);
+	}
+	schedtrace_record (SCHED_YIELD, curr->tid, 0);
 	do_schedule (THREAD_READY); // 대기큐 첫번째에 있는 쓰레드와 컨텍스트 스위칭
 	intr_set_level (old_level); // 인자로 전달된 인터럽트 상태로 인터럽트를 설정하고, 이전 인터럽트 상태를 반환
 }
@@ -381,6 +425,49 @@ thread_get_priority (void) {
 	return thread_current ()->priority;
 }
 
+/* Sets the current thread's stride scheduling tickets to
+   TICKETS.  Takes effect from the next tick. */
+void
+thread_set_tickets (int tickets) {
+	struct thread *curr = thread_current ();
+
+	ASSERT (TICKETS_MIN <= tickets && tickets <= TICKETS_MAX);
+
+	curr->tickets = tickets;
+	thread_update_stride (curr);
+}
+
+/* Returns T's tickets plus those of the threads waiting on locks
+   it holds, and of those waiting on them in turn, DEPTH links
+   down the chain. */
+static int
+stride_tickets (struct thread *t, int depth) {
+	int tickets = t->tickets;
+
+	if (depth < STRIDE_LEND_DEPTH)
+		for (struct list_elem *e = list_begin (&t->donations);
+				e != list_end (&t->donations); e = list_next (e))
+			tickets += stride_tickets (list_entry (e, struct thread,
+						donation_elem), depth + 1);
+	return tickets;
+}
+
+/* Recomputes T's stride.  Under the stride scheduler the threads
+   waiting on a lock lend their tickets to its holder, the way they
+   donate their priority otherwise, so that a holder with few
+   tickets does not keep them waiting long.  Called wherever
+   priority donation changes, with T's donations up to date. */
+void
+thread_update_stride (struct thread *t) {
+	t->stride = STRIDE_ONE / stride_tickets (t, 0);
+}
+
+/* Returns the current thread's stride scheduling tickets. */
+int
+thread_get_tickets (void) {
+	return thread_current ()->tickets;
+}
+
 /* Sets the current thread's nice value to NICE. */
 void
 thread_set_nice (int nice UNUSED) {
@@ -491,6 +578,9 @@ static void init_thread (struct thread *t, const char *name, int priority) {
 	sema_init(&t->fork_sema,0);
 	sema_init(&t->free_sema,0);
 
+	t->tickets = TICKETS_DEFAULT;
+	t->stride = STRIDE_ONE / TICKETS_DEFAULT;
+
 	t->running = NULL;
 	// t->stack_bottom = NULL;
 	t->stack_rsp = NULL;
@@ -506,6 +596,16 @@ static void init_thread (struct thread *t, const char *name, int priority) {
    idle_thread. */
 static struct thread *
 next_thread_to_run (void) {
+	if (thread_stride) {
+		struct thread *t;
+
+		if (heap_empty (&stride_queue))
+			return idle_thread;
+		t = heap_entry (heap_pop (&stride_queue), struct thread, stride_elem);
+		if (t->pass > stride_global_pass)
+			stride_global_pass = t->pass;
+		return t;
+	}
 	if (list_empty (&ready_list))
 		return idle_thread;
 	else
@@ -620,7 +720,7 @@ static void do_schedule(int status) {
 	while (!list_empty (&destruction_req)) {
 		struct thread *victim =
 			list_entry (list_pop_front (&destruction_req), struct thread, elem);
-		palloc_free_page(victim);
+		free_thread_page (victim);
 	}
 	thread_current ()->status = status;
 	schedule ();
@@ -660,6 +760,7 @@ static void schedule (void) {
 
 		/* Before switching the thread, we first save the information
 		 * of current running. */
+		schedtrace_record (SCHED_SWITCH, curr->tid, next->tid);
 		thread_launch (next);
 	}
 }
@@ -667,13 +768,40 @@ static void schedule (void) {
 /* Returns a tid to use for a new thread. */
 static tid_t allocate_tid (void) {
 	static tid_t next_tid = 1;
-	tid_t tid;
 
-	lock_acquire (&tid_lock);
-	tid = next_tid++;
-	lock_release (&tid_lock);
+	return __atomic_fetch_add (&next_tid, 1, __ATOMIC_RELAXED);
+}
 
-	return tid;
+/* Returns a page for a new thread, preferably one cached by
+   free_thread_page().  The page is not zeroed: init_thread()
+   clears the struct thread at its start, and the kernel stack
+   above it is only read after being written. */
+static struct thread *
+alloc_thread_page (void) {
+	struct thread *t = NULL;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if (!list_empty (&thread_page_cache)) {
+		t = list_entry (list_pop_front (&thread_page_cache), struct thread, elem);
+		thread_page_cache_cnt--;
+	}
+	intr_set_level (old_level);
+
+	return t != NULL ? t : palloc_get_page (0);
+}
+
+/* Releases the page of destroyed thread T.  Called by
+   do_schedule() with interrupts off. */
+static void
+free_thread_page (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (thread_page_cache_cnt < THREAD_PAGE_CACHE_MAX) {
+		list_push_front (&thread_page_cache, &t->elem);
+		thread_page_cache_cnt++;
+	} else
+		palloc_free_page (t);
 }
 // 다음에 깨워야할 tick의 최소값을 갱신하는 함수
 void update_next_tick_to_awake(int64_t ticks)
@@ -690,6 +818,7 @@ void thread_awake(int64_t ticks) {
 		t = list_entry(curr, struct thread, elem);
 		if (t->wakeup_tick <= ticks) { // 깨울시간이 되었거나 지났다면
 			curr = list_remove(&t->elem); // 해당 쓰레드를 sleep_queue에서 제거하고, curr을 삭제한 쓰레드가 가리키는 위치로 갱신
+			schedtrace_record (SCHED_WAKE, t->tid, ticks);
 			thread_unblock(t); // 해당 쓰레드를 unblock
 		} else { // 깨울시간이 되지 않았다면
 			curr = list_next(curr); // 큐의 다음을 검색
@@ -709,6 +838,7 @@ void thread_sleep(int64_t ticks) {
 	curr->wakeup_tick = ticks;
 	update_next_tick_to_awake(curr->wakeup_tick);
 	list_push_back(&sleep_list, &curr->elem);
+	schedtrace_record (SCHED_SLEEP, curr->tid, ticks);
 
 	thread_block();
 
@@ -732,6 +862,12 @@ bool cmp_priority (const struct list_elem *a, const struct list_elem *b, void *a
 // 만약 현재 쓰레드의 우선 순위가 더 작다면 CPU를 양보한다.
 void test_max_priority(void)
 {	
+	// stride 스케줄러는 우선순위 대신 pass를 비교한다
+	if (thread_stride) {
+		if (stride_preempt ())
+			thread_yield ();
+		return;
+	}
 	// ready_list가 비어있을 경우 실행하지 않고 return 
 	if (list_empty(&ready_list)){
 		return;
@@ -751,6 +887,39 @@ void test_max_priority(void)
 }
 
 bool check_preemption(void){
+    if (thread_stride)
+        return stride_preempt ();
     if(list_empty(&ready_list)) return false;
     return list_entry(list_front(&ready_list), struct thread, elem) -> priority > thread_current() -> priority;
-}
\ No newline at end of file
+}
+
+/* Orders threads in the stride run queue by pass. */
+static bool
+stride_less (const struct heap_elem *a_, const struct heap_elem *b_,
+		void *aux UNUSED) {
+	const struct thread *a = heap_entry (a_, struct thread, stride_elem);
+	const struct thread *b = heap_entry (b_, struct thread, stride_elem);
+
+	return a->pass < b->pass;
+}
+
+/* Returns true if a thread on the stride run queue is behind the
+   running thread in pass, and so should run before it. */
+static bool
+stride_preempt (void) {
+	enum intr_level old_level = intr_disable ();
+	bool behind = !heap_empty (&stride_queue)
+		&& heap_entry (heap_min (&stride_queue), struct thread,
+				stride_elem)->pass < thread_current ()->pass;
+
+	intr_set_level (old_level);
+	return behind;
+}
+
+/* Puts T on the stride run queue.  Interrupts must be off. */
+static void
+stride_enqueue (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	heap_push (&stride_queue, &t->stride_elem);
+}
@@ -0,0 +1,263 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+
+/* Kernel workqueues.
+
+   Work that must not run in interrupt context, or that should
+   not block the thread requesting it, is packaged in a struct
+   work and queued.  Each workqueue is served by a fixed pool of
+   worker threads created along with the queue, so the number of
+   threads stays bounded no matter how much work is queued.
+
+   Pending work is kept ordered by priority, FIFO among equal
+   priorities.  A worker that wakes up takes up to `batch' items
+   at once, so bursts of small items cost one wakeup instead of
+   one per item.  Delayed work sits on a single list ordered by
+   expiry and is moved to its queue by the timer interrupt.
+
+   The lists are protected by disabling interrupts, so work may
+   be queued and cancelled from interrupt handlers. */
+
+struct workqueue *system_wq;
+
+/* Delayed work of all queues, earliest expiry first. */
+static struct list delayed_list;
+
+/* Expiry of the front of delayed_list, INT64_MAX if empty. */
+static int64_t next_delayed_expiry = INT64_MAX;
+
+static void worker_main (void *wq_);
+
+static bool
+work_higher_priority (const struct list_elem *a_, const struct list_elem *b_,
+		void *aux UNUSED) {
+	const struct work *a = list_entry (a_, struct work, elem);
+	const struct work *b = list_entry (b_, struct work, elem);
+	return a->priority > b->priority;
+}
+
+static bool
+work_expires_earlier (const struct list_elem *a_, const struct list_elem *b_,
+		void *aux UNUSED) {
+	const struct work *a = list_entry (a_, struct work, elem);
+	const struct work *b = list_entry (b_, struct work, elem);
+	return a->expires < b->expires;
+}
+
+/* Initializes the workqueue subsystem and creates system_wq.
+   Must be called after thread_start(). */
+void
+workqueue_init (void) {
+	list_init (&delayed_list);
+	system_wq = workqueue_create ("events", 2, PRI_DEFAULT, 8);
+	if (system_wq == NULL)
+		PANIC ("cannot create system workqueue");
+}
+
+/* Creates a workqueue named NAME served by WORKERS threads of
+   the given PRIORITY, each taking up to BATCH items per wakeup.
+   Returns the new queue, or a null pointer if memory or threads
+   could not be allocated.  Workqueues are never destroyed. */
+struct workqueue *
+workqueue_create (const char *name, int workers, int priority, int batch) {
+	struct workqueue *wq;
+	int i;
+
+	ASSERT (!intr_context ());
+	ASSERT (workers > 0);
+	ASSERT (batch > 0 && batch <= WORKQUEUE_BATCH_MAX);
+
+	wq = malloc (sizeof *wq);
+	if (wq == NULL)
+		return NULL;
+	strlcpy (wq->name, name, sizeof wq->name);
+	list_init (&wq->pending);
+	sema_init (&wq->wakeup, 0);
+	wq->workers = workers;
+	wq->batch = batch;
+	wq->active = 0;
+	wq->flush_waiters = 0;
+	sema_init (&wq->flushed, 0);
+
+	for (i = 0; i < workers; i++) {
+		char worker_name[16];
+
+		snprintf (worker_name, sizeof worker_name, "%s/%d", name, i);
+		if (thread_create (worker_name, priority, worker_main, wq) == TID_ERROR)
+			return NULL;
+	}
+	return wq;
+}
+
+/* Waits until all work queued on WQ so far has finished.
+   Delayed work that has not expired yet is not waited for. */
+void
+workqueue_flush (struct workqueue *wq) {
+	enum intr_level old_level;
+
+	ASSERT (!intr_context ());
+
+	old_level = intr_disable ();
+	if (list_empty (&wq->pending) && wq->active == 0) {
+		intr_set_level (old_level);
+		return;
+	}
+	wq->flush_waiters++;
+	intr_set_level (old_level);
+	sema_down (&wq->flushed);
+}
+
+/* Initializes WORK to call FUNC with AUX at the given PRIORITY. */
+void
+work_init (struct work *work, work_func *func, void *aux, int priority) {
+	ASSERT (func != NULL);
+
+	work->func = func;
+	work->aux = aux;
+	work->priority = priority;
+	work->pending = false;
+	work->wq = NULL;
+}
+
+/* Puts WORK on WQ's pending list and wakes a worker.  Called with
+   interrupts off. */
+static void
+enqueue (struct workqueue *wq, struct work *work) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	list_insert_ordered (&wq->pending, &work->elem, work_higher_priority, NULL);
+	sema_up (&wq->wakeup);
+}
+
+/* Queues WORK on WQ.  Returns false, doing nothing, if WORK is
+   already pending.  May be called from an interrupt handler. */
+bool
+queue_work (struct workqueue *wq, struct work *work) {
+	enum intr_level old_level;
+	bool queued = false;
+
+	old_level = intr_disable ();
+	if (!work->pending) {
+		work->pending = true;
+		work->wq = wq;
+		enqueue (wq, work);
+		queued = true;
+	}
+	intr_set_level (old_level);
+	return queued;
+}
+
+/* Queues WORK on WQ after TICKS timer ticks.  Returns false,
+   doing nothing, if WORK is already pending.  May be called from
+   an interrupt handler. */
+bool
+queue_delayed_work (struct workqueue *wq, struct work *work, int64_t ticks) {
+	enum intr_level old_level;
+	bool queued = false;
+
+	if (ticks <= 0)
+		return queue_work (wq, work);
+
+	old_level = intr_disable ();
+	if (!work->pending) {
+		work->pending = true;
+		work->wq = wq;
+		work->expires = timer_ticks () + ticks;
+		list_insert_ordered (&delayed_list, &work->elem,
+				work_expires_earlier, NULL);
+		next_delayed_expiry = list_entry (list_front (&delayed_list),
+				struct work, elem)->expires;
+		queued = true;
+	}
+	intr_set_level (old_level);
+	return queued;
+}
+
+/* Removes WORK from its queue if it has not started yet.
+   Returns true if it was pending.  Work that is already running
+   is not waited for. */
+bool
+cancel_work (struct work *work) {
+	enum intr_level old_level;
+	bool was_pending;
+
+	old_level = intr_disable ();
+	was_pending = work->pending;
+	if (was_pending) {
+		list_remove (&work->elem);
+		work->pending = false;
+		next_delayed_expiry = list_empty (&delayed_list) ? INT64_MAX
+			: list_entry (list_front (&delayed_list), struct work, elem)->expires;
+	}
+	intr_set_level (old_level);
+	return was_pending;
+}
+
+/* Moves expired delayed work to its queue.  Called by the timer
+   interrupt handler at each tick. */
+void
+workqueue_tick (int64_t ticks) {
+	ASSERT (intr_context ());
+
+	if (next_delayed_expiry > ticks)
+		return;
+	while (!list_empty (&delayed_list)) {
+		struct work *work = list_entry (list_front (&delayed_list),
+				struct work, elem);
+		if (work->expires > ticks)
+			break;
+		list_pop_front (&delayed_list);
+		enqueue (work->wq, work);
+	}
+	next_delayed_expiry = list_empty (&delayed_list) ? INT64_MAX
+		: list_entry (list_front (&delayed_list), struct work, elem)->expires;
+}
+
+/* Worker thread.  Takes batches of work off WQ and runs them. */
+static void
+worker_main (void *wq_) {
+	struct workqueue *wq = wq_;
+
+	for (;;) {
+		work_func *funcs[WORKQUEUE_BATCH_MAX];
+		void *auxs[WORKQUEUE_BATCH_MAX];
+		enum intr_level old_level;
+		int cnt, i;
+
+		sema_down (&wq->wakeup);
+
+		/* Take a batch.  FUNC and AUX are copied out because the
+		   work item belongs to its submitter, which may reuse or
+		   free it as soon as it starts running. */
+		old_level = intr_disable ();
+		for (cnt = 0; cnt < wq->batch && !list_empty (&wq->pending); cnt++) {
+			struct work *work = list_entry (list_pop_front (&wq->pending),
+					struct work, elem);
+			work->pending = false;
+			funcs[cnt] = work->func;
+			auxs[cnt] = work->aux;
+		}
+		/* Each item upped WAKEUP once; consume the extra ups so
+		   other workers are not woken for work we already took. */
+		for (i = 1; i < cnt; i++)
+			sema_try_down (&wq->wakeup);
+		wq->active++;
+		intr_set_level (old_level);
+
+		for (i = 0; i < cnt; i++)
+			funcs[i] (auxs[i]);
+
+		old_level = intr_disable ();
+		wq->active--;
+		if (wq->active == 0 && list_empty (&wq->pending))
+			for (; wq->flush_waiters > 0; wq->flush_waiters--)
+				sema_up (&wq->flushed);
+		intr_set_level (old_level);
+	}
+}
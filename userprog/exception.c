@@ -5,6 +5,7 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "intrinsic.h"
+#include "userprog/uaccess.h"
 #include "vm/vm.h"
 
 /* Number of page faults processed. */
@@ -145,8 +146,11 @@ page_fault (struct intr_frame *f) {
 	/* For project 3 and later. */
 	if (vm_try_handle_fault (f, fault_addr, user, write, not_present))
 		return;
-	else
 #endif
+	/* 커널이 사용자 메모리를 복사하다 난 폴트면 실패를 알리는
+	   곳으로 돌아간다. */
+	if (!user && uaccess_fixup (f))
+		return;
 	/* Count page faults. */
 	exit(-1);
 	page_fault_cnt++;
@@ -21,6 +21,8 @@
 #include "userprog/syscall.h"
 #ifdef VM
 #include "vm/vm.h"
+#include "vm/ioring.h"
+#include "vm/shm.h"
 #endif
 
 /* project2 extra */
@@ -37,10 +39,27 @@ void argument_stack(char **argv, int argc, struct intr_frame *_if);
 struct thread * get_child (int pid);
 
 
-/* General process initializer for initd and other process. */
-static void
+/* General process initializer for initd and other process.
+ * Sets up the state only a user process needs, so that plain
+ * kernel threads do not pay for it in thread_create(). */
+static bool
 process_init (void) {
 	struct thread *current = thread_current ();
+
+#ifdef VM
+	/* process_cleanup()이 언제 불려도 되도록 가장 먼저 초기화 */
+	supplemental_page_table_init (&current->spt);
+#endif
+	current->file_descriptor_table = palloc_get_multiple(PAL_ZERO, FDT_PAGES);
+	if (current->file_descriptor_table == NULL)
+		return false;
+	current->fdidx = 2; // 0은 stdin, 1은 stdout에 이미 할당
+	current->file_descriptor_table[0] = 1;	// stdin 자리
+	current->file_descriptor_table[1] = 2;	// stdout 자리
+
+	current->stdin_count = 1;
+	current->stdout_count = 1;
+	return true;
 }
 
 /* Starts the first userland program, called "initd", loaded from FILE_NAME.
@@ -81,7 +100,8 @@ process_create_initd (const char *file_name) {
 /* 첫번째 사용자 프로세스를 시작하는 쓰레드 함수 */
 static void
 initd (void *f_name) {
-	process_init ();
+	if (!process_init ())
+		PANIC("Fail to launch initd\n");
 		
 	if (process_exec (f_name) < 0)
 		PANIC("Fail to launch initd\n");
@@ -185,6 +205,9 @@ __do_fork (void *aux) {
 
 	parent_if = &parent->parent_if; // 유저 스택의 정보(if_)를 부모의 인터럽트 프레임에 넣어주기
 
+	if (!process_init ())
+		goto error;
+
 	/* 1. Read the cpu context to local stack. */
 	memcpy (&if_, parent_if, sizeof (struct intr_frame)); // 자식의 인터럽트 프레임에 부모의 인터럽트 프레임을 복사해줌
 	if_.R.rax = 0; // 자식의 PID 리턴값은 0
@@ -197,7 +220,6 @@ __do_fork (void *aux) {
 
 	process_activate (current);
 #ifdef VM
-	supplemental_page_table_init (&current->spt);
 	if (!supplemental_page_table_copy (&current->spt, &parent->spt))
 		goto error;
 #else
@@ -221,7 +243,8 @@ __do_fork (void *aux) {
 		struct file *f = parent->file_descriptor_table[i];
 		if (f==NULL) continue;
 		bool is_exist = false;
-		for (int j = 0; j < DICTLEN; j++){
+		/* 스레드 페이지는 0으로 채워져 있지 않으므로 채운 칸만 본다 */
+		for (int j = 0; j < dup_idx; j++){
 			if (dup_file_dict[j].key == f){
 				current->file_descriptor_table[i] = dup_file_dict[j].value;
 				is_exist = true;
@@ -250,7 +273,6 @@ __do_fork (void *aux) {
 	
 	sema_up(&current->fork_sema);
 
-	// process_init ();
 	/* Finally, switch to the newly created process. */
 	if (succ)
 		do_iret (&if_); // 부모로부터 복사한 인터럽트 프레임을를 레지스터에 담는 작업
@@ -350,14 +372,22 @@ process_exit (void) {
 	 * TODO: Implement process termination message (see
 	 * TODO: project2/process_termination.html).
 	 * TODO: We recommend you to implement process resource cleanup here. */
-	for (int i = 0; i < FDCOUNT_LIMIT; i++){
-		close(i);
+	/* Kernel threads never went through process_init(). */
+	if (curr->file_descriptor_table != NULL) {
+		for (int i = 0; i < FDCOUNT_LIMIT; i++){
+			close(i);
+		}
+		palloc_free_multiple(curr->file_descriptor_table, FDT_PAGES);
+		curr->file_descriptor_table = NULL;
 	}
-	palloc_free_multiple(curr->file_descriptor_table, FDT_PAGES);
 
 	if (curr->running != NULL){
 		file_close(curr->running);
 	}
+#ifdef VM
+	if (curr->pml4 != NULL)
+		vm_usage_exit ();
+#endif
 	
 	process_cleanup();
 
@@ -374,6 +404,8 @@ process_cleanup (void) {
 
 #ifdef VM
 	supplemental_page_table_kill (&curr->spt);
+	ioring_exit ();
+	shm_exit ();
 #endif
 
 	uint64_t *pml4;
@@ -750,7 +782,7 @@ install_page (void *upage, void *kpage, bool writable) {
  * If you want to implement the function for only project 2, implement it on the
  * upper block. */
 
-static bool
+bool
 lazy_load_segment (struct page *page, void *aux) {
 	/* TODO: Load the segment from the file */
 	/* TODO: This called when the first page fault occurs on address VA. */
@@ -9,14 +9,26 @@
 #include "intrinsic.h"
 
 /* 추가해준 헤더 파일들 */
+#include "filesys/directory.h"
 #include "filesys/filesys.h"
 #include "filesys/file.h"
+#include "filesys/inode.h"
+#include "filesys/pipe.h"
 #include <list.h>
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
 #include "userprog/process.h"
+#include "userprog/uaccess.h"
 #include "threads/synch.h"
 #include "include/vm/vm.h"
+#include "include/vm/madvise.h"
+#include "include/vm/ioring.h"
+#include "include/vm/shm.h"
+#include <faultstat.h>
+#include <limits.h>
+#include <rusage.h>
+#include <uio.h>
 
 void syscall_entry (void);
 void syscall_handler (struct intr_frame *);
@@ -31,17 +43,36 @@ int filesize(int fd);
 int read(int fd, void *buffer, unsigned size);
 int write(int fd, const void *buffer, unsigned size);
 int _write (int fd UNUSED, const void *buffer, unsigned size);
+int pread(int fd, void *buffer, unsigned size, off_t offset);
+int pwrite(int fd, const void *buffer, unsigned size, off_t offset);
+int readv(int fd, const struct iovec *iov, int iovcnt);
+int writev(int fd, const struct iovec *iov, int iovcnt);
+int copy_file_range(int fd_in, off_t *off_in, int fd_out, off_t *off_out, unsigned size);
 void seek(int fd, unsigned position);
 unsigned tell(int fd);
 void close(int fd);
 tid_t fork (const char *thread_name);
 int exec (const char *file_name);
 int dup2(int oldfd, int newfd);
+int pipe(int *fds);
+int set_tickets (int tickets);
+#ifdef VM
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
+void munmap (void *addr);
+int msync (void *addr, size_t length);
+int madvise (void *addr, size_t length, int advice);
+int getrusage (struct rusage *usage);
+int faultstat (int who, struct faultstat *stats);
+int ioring_setup (void *addr, unsigned entries, size_t buf_size);
+int ioring_enter (void *ring, unsigned min_complete);
+int shm_create (size_t size);
+void *shm_attach (int id, void *addr);
+int shm_detach (void *addr);
+#endif
 
 
 /* syscall helper functions */
-void check_address(const uint64_t*);
+static bool get_user_string(char *buf, const char *ustr, size_t size);
 static struct file *process_get_file(int fd);
 int process_add_file(struct file *file);
 void process_close_file(int fd);
@@ -79,23 +110,15 @@ syscall_init (void) {
 }
 
 /* helper functions letsgo ! */
-void check_address(const uint64_t *uaddr){
-	struct thread *t = thread_current();
-#ifndef VM
-    /* is_user_vaddr : 포인터가 가리키는 주소가 유저영역의 주소인지 확인
-     * pml4_get_page : 유저 가상 주소에 연결된 물리 주소를 반환하는 함수. 
-                       만약 포인터가 가리키는 주소가 매핑되지 않은 영역이면 NULL을 반환함 */
-   /* 잘못된 접근인 경우, 프로세스 종료 */
-	if (uaddr == NULL || !(is_user_vaddr(uaddr)) || pml4_get_page(t->pml4, uaddr) == NULL)
-	{
-		exit(-1);
-	}
-#else
-	if (uaddr == NULL || !is_user_vaddr(uaddr))
-	{
-		exit(-1);
-	}
-#endif
+/* 사용자 문자열 USTR을 SIZE 바이트짜리 커널 버퍼 BUF로 복사한다.
+ * 주소가 잘못되었으면 프로세스를 끝내고, BUF에 다 들어가지 않으면
+ * false를 반환한다 */
+static bool get_user_string(char *buf, const char *ustr, size_t size){
+   long len = strncpy_from_user(buf, ustr, size);
+
+   if (len < 0)
+      exit(-1);
+   return (size_t) len < size;
 }
 
 
@@ -197,14 +220,65 @@ syscall_handler (struct intr_frame *f UNUSED) {
       case SYS_CLOSE:                /* Close a file. */
          close(f->R.rdi);
          break;
+      case SYS_PREAD:
+         f->R.rax = pread(f->R.rdi, (void *) f->R.rsi, f->R.rdx, f->R.r10);
+         break;
+      case SYS_PWRITE:
+         f->R.rax = pwrite(f->R.rdi, (const void *) f->R.rsi, f->R.rdx, f->R.r10);
+         break;
+      case SYS_READV:
+         f->R.rax = readv(f->R.rdi, (const struct iovec *) f->R.rsi, f->R.rdx);
+         break;
+      case SYS_WRITEV:
+         f->R.rax = writev(f->R.rdi, (const struct iovec *) f->R.rsi, f->R.rdx);
+         break;
+      case SYS_COPY_FILE_RANGE:
+         f->R.rax = copy_file_range(f->R.rdi, (off_t *) f->R.rsi, f->R.rdx, (off_t *) f->R.r10, f->R.r8);
+         break;
+#ifdef VM
       case SYS_MMAP:
-         mmap(f->R.rdi, f->R.rsi, f->R.rdx, f->R.r10, f->R.r8);
+         f->R.rax = (uint64_t) mmap((void *) f->R.rdi, f->R.rsi, f->R.rdx, f->R.r10, f->R.r8);
          break;
       case SYS_MUNMAP:
+         munmap((void *) f->R.rdi);
          break;
+      case SYS_MSYNC:
+         f->R.rax = msync((void *) f->R.rdi, f->R.rsi);
+         break;
+      case SYS_MADVISE:
+         f->R.rax = madvise((void *) f->R.rdi, f->R.rsi, f->R.rdx);
+         break;
+      case SYS_GETRUSAGE:
+         f->R.rax = getrusage((struct rusage *) f->R.rdi);
+         break;
+      case SYS_FAULTSTAT:
+         f->R.rax = faultstat(f->R.rdi, (struct faultstat *) f->R.rsi);
+         break;
+      case SYS_IORING_SETUP:
+         f->R.rax = ioring_setup((void *) f->R.rdi, f->R.rsi, f->R.rdx);
+         break;
+      case SYS_IORING_ENTER:
+         f->R.rax = ioring_enter((void *) f->R.rdi, f->R.rsi);
+         break;
+      case SYS_SHM_CREATE:
+         f->R.rax = shm_create(f->R.rdi);
+         break;
+      case SYS_SHM_ATTACH:
+         f->R.rax = (uint64_t) shm_attach(f->R.rdi, (void *) f->R.rsi);
+         break;
+      case SYS_SHM_DETACH:
+         f->R.rax = shm_detach((void *) f->R.rdi);
+         break;
+#endif
       case SYS_DUP2:
          f->R.rax = dup2(f->R.rdi, f->R.rsi);
          break;
+      case SYS_PIPE:
+         f->R.rax = pipe((int *) f->R.rdi);
+         break;
+      case SYS_SET_TICKETS:
+         f->R.rax = set_tickets(f->R.rdi);
+         break;
       default:                   /* call thread_exit() ? */
          exit(-1);
          break;
@@ -233,19 +307,26 @@ tid_t fork (const char *thread_name){
    /* create new process, which is the clone of current process with the name THREAD_NAME*/
    // 커널영역에서 실행중
    struct thread *curr = thread_current(); // 부모 쓰레드
-   return process_fork(thread_name, &curr->parent_if);
+   char name[sizeof curr->name];
+
+   /* 이름은 어차피 잘리므로 길어도 된다 */
+   get_user_string(name, thread_name, sizeof name);
+   name[sizeof name - 1] = '\0';
+   return process_fork(name, &curr->parent_if);
    /* must return pid of the child process */
 }
 
 int exec (const char *file){
-   check_address(file);
-   int size = strlen(file) + 1; // 마지막 null 문자를 포함해서 + 1
-   char *fn_copy = palloc_get_page(PAL_ZERO); // page 할당을 하는데, 페이지 전체를 0으로 초기화
+   char *fn_copy = palloc_get_page(0);
    
    if(fn_copy==NULL)
       exit(-1);
 
-   strlcpy(fn_copy, file, size);
+   if (strncpy_from_user(fn_copy, file, PGSIZE) < 0){
+      palloc_free_page(fn_copy);
+      exit(-1);
+   }
+   fn_copy[PGSIZE - 1] = '\0';
    if (process_exec(fn_copy) == -1)
       return -1;
 
@@ -260,24 +341,35 @@ int wait(tid_t pid){
 
  /* 파일을 생성하는 시스템 콜 */
 bool create(const char *file, unsigned initial_size){
-   check_address(file); // 포인터가 가리키는 주소가 유저영역의 주소인지 확인
-   return filesys_create(file, initial_size); // 파일 이름 & 크기에 해당하는 파일 생성
+   char name[NAME_MAX + 2];
+
+   /* NAME_MAX보다 긴 이름은 어차피 만들 수 없다 */
+   if (!get_user_string(name, file, sizeof name))
+      return false;
+   return filesys_create(name, initial_size); // 파일 이름 & 크기에 해당하는 파일 생성
 }
 
  /* Delete a file. */
 bool remove(const char *file){
-   check_address(file); // 포인터가 가리키는 주소가 유저영역의 주소인지 확인
-   return filesys_remove(file); // 파일 이름에 해당하는 파일을 제거
+   char name[NAME_MAX + 2];
+
+   if (!get_user_string(name, file, sizeof name))
+      return false;
+   return filesys_remove(name); // 파일 이름에 해당하는 파일을 제거
 }
 /* 파일을 열 때 사용하는 시스템콜*/
 int open (const char *file){
    /* 인자로 들어오는 file = 파일의 이름 및 경로 정보 */
+   char name[NAME_MAX + 2];
 
-   check_address(file);
+   if (!get_user_string(name, file, sizeof name))
+      return -1;
    lock_acquire(&filesys_lock); // 파일을 접근하는 동안 다른 곳에서 쓰면 안되므로 lock
-   struct file *f = filesys_open(file); // 열고자 하는 파일의 객체 정보를 받아오기
-   if (f == NULL)
+   struct file *f = filesys_open(name); // 열고자 하는 파일의 객체 정보를 받아오기
+   if (f == NULL){
+      lock_release(&filesys_lock);
       return -1;
+   }
    int fd = process_add_file(f); // 파일 객체를 가리키는 포인터를 FDT에 추가하고, FDT내의 해당 파일이 위치한 fdidx를 리턴
    if (fd == -1)
       file_close(f);
@@ -286,21 +378,46 @@ int open (const char *file){
 }
 /* 파일의 크기를 알려주는 시스템콜 */
 int filesize (int fd){
-   struct file *f = process_get_file(fd); // fd를 이용해서 파일 객체 검색
+   struct file *f = get_regular_file(fd); // fd를 이용해서 파일 객체 검색
    if (f == NULL) return -1;
    return file_length(f);
 }
+/* 사용자 버퍼와 파일 사이에 한 번에 옮기는 크기. 작은 입출력은
+ * 커널 스택의 버퍼를 거친다 */
+#define IO_SMALL 128
+#define IO_CHUNK PGSIZE
+
+/* SIZE 바이트를 옮길 커널 버퍼를 SMALL이나 새 페이지로 정하고 그
+ * 크기를 *CHUNK에 넣는다 */
+static void *io_buffer(void *small, unsigned size, size_t *chunk){
+   void *kbuf = small;
+
+   *chunk = IO_SMALL;
+   if (size > IO_SMALL){
+      kbuf = palloc_get_page(0);
+      *chunk = IO_CHUNK;
+   }
+   return kbuf;
+}
+
+static void io_buffer_free(void *kbuf, void *small){
+   if (kbuf != small)
+      palloc_free_page(kbuf);
+}
+
 /* 해당 파일로부터 값을 읽고, 버퍼에 넣는 시스템콜 */
+/* 커널 버퍼로 읽은 뒤 copy_to_user()로 옮기므로 파일 시스템 락을 쥔
+ * 채 사용자 메모리에서 폴트가 나지 않는다. 버퍼가 잘못되었으면
+ * 프로세스를 끝낸다 */
 int read (int fd, void *buffer,unsigned size){
-   check_address(buffer);
-   int readsize;
+   int readsize = 0;
    struct thread *curr = thread_current();
+   char small[IO_SMALL];
+   size_t chunk;
+   void *kbuf;
 
-   // project3 - stack growth
-#ifdef VM
-   struct page *page = spt_find_page(&curr->spt, buffer);
-   if (page && !page->writable) exit(-1); 
-#endif
+   if (buffer == NULL || !is_user_vaddr(buffer))
+      exit(-1);
    struct file *f = process_get_file(fd);
    if (f == NULL || f == STDOUT) return -1;
    // if (fd < 0 || fd>= FDCOUNT_LIMIT) return NULL;
@@ -313,65 +430,379 @@ int read (int fd, void *buffer,unsigned size){
       }
       else {
          // fd가 0일 경우 키보드 입력을 받아온다
-         int i;
-         unsigned char *buf = buffer;
+         unsigned i;
          for (i=0; i < size; i++){
             char c = input_getc();
-            *buf++ = c;
+            if (!copy_to_user((char *) buffer + i, &c, 1))
+               exit(-1);
             if (c == '\0')
                break;
          }
          readsize = i;
       }
+      return readsize;
    }
-   else{
+
+   kbuf = io_buffer(small, size, &chunk);
+   if (kbuf == NULL)
+      return -1;
+   if (file_is_pipe(f)){
+      // 파이프는 들어와 있는 만큼만, 많아야 한 페이지를 읽는다
+      readsize = pipe_read(f, kbuf, size < chunk ? size : chunk);
+      if (readsize > 0 && !copy_to_user(buffer, kbuf, readsize)){
+         io_buffer_free(kbuf, small);
+         exit(-1);
+      }
+      io_buffer_free(kbuf, small);
+      return readsize;
+   }
+   while ((unsigned) readsize < size){
+      size_t want = size - readsize < chunk ? size - readsize : chunk;
+      int n;
+
       lock_acquire(&filesys_lock); // 파일에 동시접근 일어날 수 있으므로 lock 사용
-      readsize = file_read(f, buffer, size);
+      n = file_read(f, kbuf, want);
       lock_release(&filesys_lock);
+      if (n > 0 && !copy_to_user((char *) buffer + readsize, kbuf, n)){
+         io_buffer_free(kbuf, small);
+         exit(-1);
+      }
+      readsize += n;
+      if ((size_t) n < want)
+         break;
    }
+   io_buffer_free(kbuf, small);
    return readsize;
 }
 
 /* 데이터를 기록하는 시스템 콜 */
+/* 사용자 버퍼를 copy_from_user()로 커널 버퍼에 먼저 옮겨 쓴다 */
 int write (int fd, const void *buffer, unsigned size){
-   check_address(buffer);
    struct file *f = process_get_file(fd);
-   int writesize;
+   int writesize = 0;
    struct thread *cur = thread_current();
+   char small[IO_SMALL];
+   size_t chunk;
+   void *kbuf;
 
+   if (buffer == NULL || !is_user_vaddr(buffer))
+      exit(-1);
    if (f == NULL) return -1;
    if (f == STDIN) return -1;
 
-   if (f == STDOUT){
-      if (cur->stdout_count == 0) {
-         NOT_REACHED();
-         process_close_file(fd);
-         writesize = -1;
+   if (f == STDOUT && cur->stdout_count == 0) {
+      NOT_REACHED();
+      process_close_file(fd);
+      return -1;
+   }
+
+   kbuf = io_buffer(small, size, &chunk);
+   if (kbuf == NULL)
+      return -1;
+   while ((unsigned) writesize < size){
+      size_t want = size - writesize < chunk ? size - writesize : chunk;
+      int n;
+
+      if (!copy_from_user(kbuf, (const char *) buffer + writesize, want)){
+         io_buffer_free(kbuf, small);
+         exit(-1);
+      }
+      if (f == STDOUT){
+         putbuf(kbuf, want);// buffer에 들은 size만큼을 한 번의 호출로 작성해준다.
+         n = want;
+      }
+      else if (file_is_pipe(f)){
+         // 읽는 쪽이 모두 닫혔으면 -1 이나 덜 쓴 크기가 돌아온다
+         n = pipe_write(f, kbuf, want);
+         if (n < 0){
+            io_buffer_free(kbuf, small);
+            return writesize > 0 ? writesize : -1;
+         }
       }
       else{
-         putbuf(buffer, size);// buffer에 들은 size만큼을, 한 번의 호출로 작성해준다.
-         writesize = size;
+         lock_acquire(&filesys_lock); // 파일에 동시접근 일어날 수 있으므로 lock 사용
+         n = file_write(f, kbuf, want);
+         lock_release(&filesys_lock);
+      }
+      writesize += n;
+      if ((size_t) n < want)
+         break;
+   }
+   io_buffer_free(kbuf, small);
+   return writesize;
+}
+
+/* 사용자 버퍼 IOV들을 이어 붙였을 때 SKIP 바이트 위치부터 SIZE
+ * 바이트를 커널 버퍼 KBUF와 주고받는다. TO_USER이면 KBUF에서 사용자
+ * 버퍼로 옮긴다. 버퍼가 잘못되었으면 false */
+static bool iov_bounce(void *kbuf, const struct iovec *iov, size_t skip, size_t size, bool to_user){
+   for (; size > 0; iov++){
+      size_t n;
+
+      if (skip >= iov->iov_len){
+         skip -= iov->iov_len;
+         continue;
       }
+      n = iov->iov_len - skip < size ? iov->iov_len - skip : size;
+      if (to_user ? !copy_to_user((char *) iov->iov_base + skip, kbuf, n)
+                  : !copy_from_user(kbuf, (const char *) iov->iov_base + skip, n))
+         return false;
+      kbuf = (char *) kbuf + n;
+      size -= n;
+      skip = 0;
+   }
+   return true;
+}
+
+/* 한 번의 락 구간에 옮기는 최대 페이지 수 */
+#define IO_BATCH IOV_MAX
+
+/* 커널 버퍼 KIOV의 KCNT개를 이어 붙인 것과 사용자 버퍼 IOV들의 SKIP
+ * 바이트 위치부터를 iov_bounce()로 주고받는다. 버퍼가 잘못되었으면
+ * false */
+static bool kiov_bounce(const struct iovec *kiov, int kcnt, const struct iovec *iov, size_t skip, bool to_user){
+   for (int i = 0; i < kcnt; i++){
+      if (!iov_bounce(kiov[i].iov_base, iov, skip, kiov[i].iov_len, to_user))
+         return false;
+      skip += kiov[i].iov_len;
+   }
+   return true;
+}
+
+/* 파일 F를 IOV의 IOVCNT개 버퍼로 읽어들이거나(WRITE가 false) 버퍼들의
+ * 내용을 써넣는다. OFFSET이 0 이상이면 그 위치에서 하고 파일의 pos는
+ * 그대로 둔다. 버퍼가 잘못되었으면 프로세스를 끝낸다.
+ * read()/write()처럼 커널 버퍼를 거치므로 파일 시스템 락을 쥔 채
+ * 사용자 메모리에서 폴트가 나지 않는다. 커널 페이지를 IO_BATCH개까지
+ * 잡아 그 안에 드는 만큼을 락을 한 번 쥐고 file_readv_at()이나
+ * file_writev_at()으로 옮기므로, 디스크에서 이어진 섹터는 버퍼 경계와
+ * 상관없이 한 번에 옮겨진다 */
+static int file_iov(struct file *f, const struct iovec *iov, int iovcnt, bool write, off_t offset){
+   struct iovec kiov[IO_BATCH];
+   char small[IO_SMALL];
+   size_t size = 0, done = 0, cap;
+   int kcnt = 0;
+   bool bad = false;
+
+   for (int i = 0; i < iovcnt; i++)
+      size += iov[i].iov_len;
+   if (size <= IO_SMALL){
+      kiov[kcnt++].iov_base = small;
+      cap = IO_SMALL;
    }
    else{
-      lock_acquire(&filesys_lock); // 파일에 동시접근 일어날 수 있으므로 lock 사용
-      writesize = file_write(f, buffer, size);
+      // 페이지가 모자라면 잡은 만큼으로 나누어 옮긴다
+      while (kcnt < IO_BATCH && (size_t) kcnt * PGSIZE < size){
+         void *page = palloc_get_page(0);
+         if (page == NULL)
+            break;
+         kiov[kcnt++].iov_base = page;
+      }
+      if (kcnt == 0)
+         return -1;
+      cap = PGSIZE;
+   }
+
+   while (done < size){
+      size_t want = 0;
+      int cnt;
+      off_t pos, n;
+
+      for (cnt = 0; cnt < kcnt && want < size - done; cnt++){
+         kiov[cnt].iov_len = size - done - want < cap ? size - done - want : cap;
+         want += kiov[cnt].iov_len;
+      }
+      if (write && !kiov_bounce(kiov, cnt, iov, done, false)){
+         bad = true;
+         break;
+      }
+      lock_acquire(&filesys_lock);
+      pos = offset >= 0 ? offset + (off_t) done : file_tell(f);
+      n = write ? file_writev_at(f, kiov, cnt, pos)
+                : file_readv_at(f, kiov, cnt, pos);
+      if (offset < 0)
+         file_seek(f, pos + n);
       lock_release(&filesys_lock);
+      if (!write && n > 0){
+         // 읽은 만큼만 사용자 버퍼로 옮긴다
+         size_t left = n;
+         for (cnt = 0; left > 0; cnt++){
+            if (kiov[cnt].iov_len > left)
+               kiov[cnt].iov_len = left;
+            left -= kiov[cnt].iov_len;
+         }
+         if (!kiov_bounce(kiov, cnt, iov, done, true)){
+            bad = true;
+            break;
+         }
+      }
+      done += n;
+      if ((size_t) n < want)
+         break;
    }
-   return writesize;
+
+   if (kiov[0].iov_base != small)
+      for (int i = 0; i < kcnt; i++)
+         palloc_free_page(kiov[i].iov_base);
+   if (bad)
+      exit(-1);
+   return done;
+}
+
+/* FDT 항목 F가 파일이 아니라 콘솔을 가리키는지 */
+static bool is_console(struct file *f){
+   return (uintptr_t) f == (uintptr_t) STDIN || (uintptr_t) f == (uintptr_t) STDOUT;
+}
+
+/* FD가 콘솔도 파이프도 아닌 열린 파일이면 그 파일을 반환한다 */
+struct file *get_regular_file(int fd){
+   struct file *f = process_get_file(fd);
+
+   if (f == NULL || is_console(f) || file_is_pipe(f))
+      return NULL;
+   return f;
+}
+
+/* OFFSET 위치에서 읽는 시스템콜. 파일의 pos는 바뀌지 않는다 */
+int pread(int fd, void *buffer, unsigned size, off_t offset){
+   struct file *f = get_regular_file(fd);
+   struct iovec iov = { buffer, size };
+
+   if (f == NULL || offset < 0 || size > INT_MAX)
+      return -1;
+   return file_iov(f, &iov, 1, false, offset);
+}
+
+/* OFFSET 위치에 쓰는 시스템콜. 파일의 pos는 바뀌지 않는다 */
+int pwrite(int fd, const void *buffer, unsigned size, off_t offset){
+   struct file *f = get_regular_file(fd);
+   struct iovec iov = { (void *) buffer, size };
+
+   if (f == NULL || offset < 0 || size > INT_MAX)
+      return -1;
+   return file_iov(f, &iov, 1, true, offset);
+}
+
+/* 사용자의 iovec 배열 UIOV에서 IOVCNT개를 IOV로 복사한다. 개수가
+ * 잘못되었거나 길이의 합이 int를 넘으면 false, 배열 주소가 잘못되었으면
+ * 프로세스를 끝낸다 */
+static bool get_user_iovec(struct iovec *iov, const struct iovec *uiov, int iovcnt){
+   size_t total = 0;
+
+   if (iovcnt < 0 || iovcnt > IOV_MAX)
+      return false;
+   if (!copy_from_user(iov, uiov, iovcnt * sizeof *iov))
+      exit(-1);
+   for (int i = 0; i < iovcnt; i++){
+      if (iov[i].iov_len > INT_MAX - total)
+         return false;
+      total += iov[i].iov_len;
+   }
+   return true;
+}
+
+/* 콘솔에 대한 readv()/writev(). 버퍼마다 read()나 write()를 부른다 */
+static int console_iov(int fd, const struct iovec *iov, int iovcnt, bool write_){
+   int total = 0;
+
+   for (int i = 0; i < iovcnt; i++){
+      int n = write_ ? write(fd, iov[i].iov_base, iov[i].iov_len)
+                     : read(fd, iov[i].iov_base, iov[i].iov_len);
+      if (n < 0)
+         return total > 0 ? total : -1;
+      total += n;
+      if ((size_t) n < iov[i].iov_len)
+         break;
+   }
+   return total;
+}
+
+/* IOVCNT개의 버퍼 UIOV를 차례로 채워 읽는 시스템콜 */
+int readv(int fd, const struct iovec *uiov, int iovcnt){
+   struct file *f = process_get_file(fd);
+   struct iovec iov[IOV_MAX];
+
+   if (f == NULL || !get_user_iovec(iov, uiov, iovcnt))
+      return -1;
+   if (is_console(f))
+      return console_iov(fd, iov, iovcnt, false);
+   if (file_is_pipe(f))
+      return -1;
+   return file_iov(f, iov, iovcnt, false, -1);
+}
+
+/* IOVCNT개의 버퍼 UIOV의 내용을 차례로 쓰는 시스템콜 */
+int writev(int fd, const struct iovec *uiov, int iovcnt){
+   struct file *f = process_get_file(fd);
+   struct iovec iov[IOV_MAX];
+
+   if (f == NULL || !get_user_iovec(iov, uiov, iovcnt))
+      return -1;
+   if (is_console(f))
+      return console_iov(fd, iov, iovcnt, true);
+   if (file_is_pipe(f))
+      return -1;
+   return file_iov(f, iov, iovcnt, true, -1);
+}
+
+/* 사용자 포인터 UOFS가 가리키는 오프셋을, NULL이면 F의 pos를 *OFS에
+ * 넣는다. 주소가 잘못되었으면 프로세스를 끝낸다 */
+static void get_offset(off_t *ofs, const off_t *uofs, struct file *f){
+   if (uofs == NULL)
+      *ofs = file_tell(f);
+   else if (!copy_from_user(ofs, uofs, sizeof *ofs))
+      exit(-1);
+}
+
+/* 복사한 뒤의 오프셋 OFS를 UOFS에, NULL이면 F의 pos에 돌려준다 */
+static void put_offset(off_t *uofs, off_t ofs, struct file *f){
+   if (uofs == NULL)
+      file_seek(f, ofs);
+   else if (!copy_to_user(uofs, &ofs, sizeof ofs))
+      exit(-1);
+}
+
+/* FD_IN의 파일에서 FD_OUT의 파일로 SIZE 바이트를 커널 안에서 바로
+ * 복사하는 시스템콜. OFF_IN이나 OFF_OUT이 NULL이면 그 파일의 pos에서
+ * 시작해 pos를 옮기고, 아니면 가리키는 오프셋에서 시작해 그 값을
+ * 옮긴다. 사용자 버퍼를 거치지 않으며, 같은 파일 안에서 겹치는 범위는
+ * 복사하지 않는다 */
+int copy_file_range(int fd_in, off_t *off_in, int fd_out, off_t *off_out, unsigned size){
+   struct file *in = get_regular_file(fd_in);
+   struct file *out = get_regular_file(fd_out);
+   off_t in_ofs, out_ofs, n;
+
+   if (in == NULL || out == NULL || size > INT_MAX)
+      return -1;
+   get_offset(&in_ofs, off_in, in);
+   get_offset(&out_ofs, off_out, out);
+   if (in_ofs < 0 || out_ofs < 0 || in_ofs > INT_MAX - (off_t) size
+         || out_ofs > INT_MAX - (off_t) size)
+      return -1;
+   if (file_get_inode(in) == file_get_inode(out)
+         && in_ofs < out_ofs + (off_t) size && out_ofs < in_ofs + (off_t) size)
+      return -1;
+
+   lock_acquire(&filesys_lock);
+   n = inode_copy_range(file_get_inode(out), out_ofs, file_get_inode(in), in_ofs, size);
+   lock_release(&filesys_lock);
+
+   put_offset(off_in, in_ofs + n, in);
+   put_offset(off_out, out_ofs + n, out);
+   return n;
 }
 
 /* 파일의 pos를 변경해주는 시스템콜 */
 void seek (int fd, unsigned position){
-   struct file *f = process_get_file(fd); // fdt에서 파일 객체 찾아오기
-   if (f > 2)
+   struct file *f = get_regular_file(fd); // fdt에서 파일 객체 찾아오기
+   if (f != NULL)
       file_seek(f, position);
 }
 /* 해당 파일의 pos를 반환해주는 시스템콜 */
 unsigned tell (int fd){
-   struct file *f = process_get_file(fd);
-   if (fd < 2)
-      return;
+   struct file *f = get_regular_file(fd);
+   if (f == NULL)
+      return -1;
    return file_tell(f);
 }
 
@@ -433,20 +864,59 @@ int dup2(int oldfd, int newfd)
    return newfd;
 }
 
+/* 파이프를 만들어 읽는 쪽 식별자를 FDS[0]에, 쓰는 쪽 식별자를 FDS[1]에
+ * 넣는 시스템콜. 두 식별자는 read/write/close/dup2에 그대로 쓸 수 있고
+ * fork()한 자식에게도 물려진다 */
+int pipe(int *fds){
+   struct file *read_end, *write_end;
+   int kfds[2];
+
+   if (!pipe_create(&read_end, &write_end))
+      return -1;
+   kfds[0] = process_add_file(read_end);
+   kfds[1] = kfds[0] < 0 ? -1 : process_add_file(write_end);
+   if (kfds[1] < 0){
+      if (kfds[0] >= 0)
+         process_close_file(kfds[0]);
+      file_close(read_end);
+      file_close(write_end);
+      return -1;
+   }
+   if (!copy_to_user(fds, kfds, sizeof kfds))
+      exit(-1);
+   return 0;
+}
+
+/* 현재 프로세스의 stride scheduling ticket 수를 TICKETS로 바꿈.
+ * 범위를 벗어나면 -1을 반환. */
+int set_tickets (int tickets)
+{
+   if (tickets < TICKETS_MIN || tickets > TICKETS_MAX)
+      return -1;
+   thread_set_tickets(tickets);
+   return 0;
+}
+
+#ifdef VM
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset)
 {
    /* 파일의 시작점이 페이지 정렬이 되지 않았을 경우  */
    if (offset%PGSIZE != 0){
       return NULL;
    }
-   struct file *file = process_get_file(fd);
-   
-   /* file이 제대로 열리지 않았을 경우, file의 길이가 0인 경우 */
-   if (file == NULL || file_length(file) == 0){
+   /* addr가 0이거나 페이지 정렬이 안 된 경우, length가 0인 경우 */
+   if (addr == NULL || pg_ofs(addr) != 0 || length == 0){
       return NULL;
    }
-   /* addr가 0인 경우, length가 0인 경우 */
-   if (addr == 0x0| length == 0){
+   /* 매핑 범위가 커널 영역에 걸치거나 주소가 한 바퀴 도는 경우 */
+   if (is_kernel_vaddr(addr) || is_kernel_vaddr(addr + length)
+         || addr + length < addr){
+      return NULL;
+   }
+   struct file *file = get_regular_file(fd);
+   
+   /* file이 제대로 열리지 않았을 경우, 콘솔이나 파이프인 경우, file의 길이가 0인 경우 */
+   if (file == NULL || file_length(file) == 0){
       return NULL;
    }
    
@@ -455,5 +925,91 @@ void *mmap (void *addr, size_t length, int writable, int fd, off_t offset)
 
 void munmap (void *addr)
 {
-   return do_munmap(addr);
+   do_munmap(addr);
+}
+
+/* ADDR부터 LENGTH 바이트 안의 수정된 매핑 페이지를 바로 파일에 쓴다 */
+int msync (void *addr, size_t length)
+{
+   if (addr == NULL || is_kernel_vaddr(addr) || is_kernel_vaddr(addr + length)
+         || addr + length < addr)
+      return -1;
+   return do_msync(addr, length) ? 0 : -1;
 }
+
+/* ADDR부터 LENGTH 바이트를 어떻게 쓸지 커널에 알려 준다 */
+int madvise (void *addr, size_t length, int advice)
+{
+   if (addr == NULL || pg_ofs(addr) != 0 || is_kernel_vaddr(addr)
+         || is_kernel_vaddr(addr + length) || addr + length < addr)
+      return -1;
+   return do_madvise(addr, length, advice) ? 0 : -1;
+}
+
+/* 현재 프로세스의 메모리 사용량을 USAGE에 채운다 */
+int getrusage (struct rusage *usage)
+{
+   struct rusage ru;
+
+   vm_getrusage(&ru);
+   if (!copy_to_user(usage, &ru, sizeof ru))
+      exit(-1);
+   return 0;
+}
+
+/* WHO가 FAULTSTAT_SELF면 현재 프로세스의, FAULTSTAT_ALL이면 부팅 뒤
+ * 모든 프로세스의 페이지 폴트 통계를 STATS에 채운다 */
+int faultstat (int who, struct faultstat *stats)
+{
+   struct faultstat *snap;
+
+   if (who != FAULTSTAT_SELF && who != FAULTSTAT_ALL)
+      return -1;
+
+   /* 사용자 버퍼에 쓰다 폴트가 나면 통계가 바뀌므로 먼저 떠 둔다 */
+   snap = malloc(sizeof *snap);
+   if (snap == NULL)
+      return -1;
+   vm_faultstat(snap, who == FAULTSTAT_ALL);
+   if (!copy_to_user(stats, snap, sizeof *stats)){
+      free(snap);
+      exit(-1);
+   }
+   free(snap);
+   return 0;
+}
+
+/* ADDR에 ENTRIES칸짜리 큐 두 개와 BUF_SIZE 바이트 버퍼 영역을 가진
+ * 링을 매핑한다 */
+int ioring_setup (void *addr, unsigned entries, size_t buf_size)
+{
+   return ioring_create(addr, entries, buf_size) ? 0 : -1;
+}
+
+/* 링에 쌓인 요청을 제출하고 MIN_COMPLETE개가 완료될 때까지 기다린다 */
+int ioring_enter (void *ring, unsigned min_complete)
+{
+   return ioring_submit(ring, min_complete);
+}
+
+/* SIZE 바이트짜리 공유 메모리 세그먼트를 만들어 그 id를 돌려준다.
+ * 만든 프로세스가 끝날 때까지, 그리고 붙어 있는 프로세스가 있는 동안
+ * 남아 있다 */
+int shm_create (size_t size)
+{
+   return shm_new(size);
+}
+
+/* 세그먼트 ID를 ADDR에 붙인다. 자식은 fork() 때 같은 세그먼트에
+ * 붙는다 */
+void *shm_attach (int id, void *addr)
+{
+   return shm_map_at(id, addr);
+}
+
+/* ADDR에 붙인 세그먼트를 뗀다 */
+int shm_detach (void *addr)
+{
+   return shm_unmap_at(addr) ? 0 : -1;
+}
+#endif
@@ -0,0 +1,86 @@
+/* uaccess.c: Copying to and from user memory.
+ *
+ * System calls used to check each user pointer before using it,
+ * which cost a page table walk, or an spt lookup, per call and
+ * still only covered the first byte of the buffer.  The functions
+ * here instead just copy, after checking with arithmetic alone
+ * that the whole range lies below KERN_BASE.  A fault on an
+ * unmapped or read-only page goes to page_fault() like any other;
+ * if the VM cannot handle it, page_fault() finds the faulting
+ * instruction in __ex_table and resumes at its fixup, and the
+ * copy reports failure instead of the kernel dying.  See
+ * userprog/uaccess-copy.S. */
+
+#include "userprog/uaccess.h"
+#include <stdint.h>
+#include "threads/interrupt.h"
+#include "threads/vaddr.h"
+
+/* An instruction that may fault on user memory, and where to go
+ * if it does. */
+struct ex_entry {
+	uintptr_t insn;
+	uintptr_t fixup;
+};
+
+/* Bounds of __ex_table, from kernel.lds.S. */
+extern const struct ex_entry __ex_table_start[], __ex_table_end[];
+
+size_t uaccess_copy (void *dst, const void *src, size_t size);
+long uaccess_strncpy (char *dst, const char *src, size_t size);
+
+/* Returns true if the SIZE bytes at UADDR all lie in user
+ * space. */
+static bool
+range_ok (const void *uaddr, size_t size) {
+	uintptr_t start = (uintptr_t) uaddr;
+
+	return start + size >= start && start + size <= KERN_BASE;
+}
+
+/* Copies SIZE bytes from user address USRC to DST.  Returns false
+ * if part of the source is not readable user memory. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size) {
+	return range_ok (usrc, size) && uaccess_copy (dst, usrc, size) == 0;
+}
+
+/* Copies SIZE bytes from SRC to user address UDST.  Returns false
+ * if part of the destination is not writable user memory. */
+bool
+copy_to_user (void *udst, const void *src, size_t size) {
+	return range_ok (udst, size) && uaccess_copy (udst, src, size) == 0;
+}
+
+/* Copies the null-terminated string at user address USRC to DST,
+ * which holds SIZE bytes.  Returns its length, or SIZE if it does
+ * not fit, in which case DST is not null-terminated, or -1 if part
+ * of it is not readable user memory. */
+long
+strncpy_from_user (char *dst, const char *usrc, size_t size) {
+	uintptr_t start = (uintptr_t) usrc;
+	size_t room;
+	long len;
+
+	if (start >= KERN_BASE)
+		return -1;
+	room = KERN_BASE - start;
+	len = uaccess_strncpy (dst, usrc, size < room ? size : room);
+	/* 끝나기 전에 커널 영역에 닿았다 */
+	if (len >= 0 && (size_t) len == room && room < size)
+		return -1;
+	return len;
+}
+
+/* If F is a fault in kernel mode at an instruction listed in
+ * __ex_table, makes F resume at the instruction's fixup and returns
+ * true. */
+bool
+uaccess_fixup (struct intr_frame *f) {
+	for (const struct ex_entry *e = __ex_table_start; e < __ex_table_end; e++)
+		if (e->insn == f->rip) {
+			f->rip = e->fixup;
+			return true;
+		}
+	return false;
+}
@@ -2,6 +2,17 @@
 
 #include "vm/vm.h"
 #include "devices/disk.h"
+#include <bitmap.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "vm/zswap.h"
+
+/* Sectors in one swap slot. */
+#define SECTORS_PER_SLOT (PGSIZE / DISK_SECTOR_SIZE)
 
 /* DO NOT MODIFY BELOW LINE */
 static struct disk *swap_disk;
@@ -9,6 +20,19 @@ static bool anon_swap_in (struct page *page, void *kva);
 static bool anon_swap_out (struct page *page);
 static void anon_destroy (struct page *page);
 
+/* Swap slots in use.  swap_lock also keeps a page from being read
+ * back in while it is still being written out, and serializes the
+ * compressed pool in front of the disk; see zswap.c. */
+static struct bitmap *swap_table;
+static struct lock swap_lock;
+
+/* Page that pool entries are expanded into on their way to disk. */
+static void *bounce_page;
+
+/* Statistics. */
+static long long swap_out_cnt;          /* Pages written to swap. */
+static long long swap_in_cnt;           /* Pages read back. */
+
 /* DO NOT MODIFY this struct */
 static const struct page_operations anon_ops = {
 	.swap_in = anon_swap_in,
@@ -20,12 +44,19 @@ static const struct page_operations anon_ops = {
 void
 vm_anon_init (void) {
 	/* TODO: Set up the swap_disk. */
-	swap_disk = NULL;
-	// struct page* cur_page = thread_current()->spt;
+	swap_disk = disk_get (1, 1);
+	lock_init (&swap_lock);
+	/* 스왑 디스크가 없으면 빈 테이블로 두어 내보내기가 항상 실패한다 */
+	swap_table = bitmap_create (swap_disk != NULL
+			? disk_size (swap_disk) / SECTORS_PER_SLOT : 0);
+	if (swap_table == NULL)
+		PANIC ("swap table creation failed");
+	bounce_page = palloc_get_page (PAL_ASSERT);
+	zswap_init ();
 }
 
 /* Initialize the file mapping */
-bool 
+bool
 anon_initializer (struct page *page, enum vm_type type, void *kva) {
 	/* Set up the handler */
 	page->operations = &anon_ops;
@@ -34,25 +65,227 @@ anon_initializer (struct page *page, enum vm_type type, void *kva) {
 
 	anon_page->aux_type = type & VM_MARKER_0 ? VM_MARKER_0 : type;
 	anon_page->slot_number = -1;
+	anon_page->zswap = NULL;
+	return true;
+}
+
+/* Reads slot SLOT into KVA.  swap_lock must be held. */
+static void
+swap_read (int slot, void *kva) {
+	for (int i = 0; i < SECTORS_PER_SLOT; i++)
+		disk_read (swap_disk, slot * SECTORS_PER_SLOT + i,
+				kva + i * DISK_SECTOR_SIZE);
+}
+
+/* Writes KVA to slot SLOT.  swap_lock must be held. */
+static void
+swap_write (int slot, const void *kva) {
+	for (int i = 0; i < SECTORS_PER_SLOT; i++)
+		disk_write (swap_disk, slot * SECTORS_PER_SLOT + i,
+				kva + i * DISK_SECTOR_SIZE);
+	swap_out_cnt++;
+}
+
+/* Moves the oldest entries of the compressed pool to swap slots
+ * until the pool is back under its size or the disk is full.
+ * swap_lock must be held. */
+static void
+zswap_shrink (void) {
+	struct zswap_entry *entry;
+
+	while ((entry = zswap_victim ()) != NULL) {
+		struct anon_page *anon_page = &entry->page->anon;
+		size_t slot = bitmap_scan_and_flip (swap_table, 0, 1, false);
+
+		if (slot == BITMAP_ERROR)
+			break;
+		zswap_load (entry, bounce_page);
+		swap_write (slot, bounce_page);
+		anon_page->slot_number = slot;
+		anon_page->zswap = NULL;
+		zswap_free (entry, true);
+	}
+}
+
+/* Moves PAGE's saved contents into KVA, freeing its slot or
+ * compressed copy, or zeroes KVA if it has none.  Returns true if
+ * it had one.  swap_lock must be held. */
+static bool
+swap_load (struct page *page, void *kva) {
+	struct anon_page *anon_page = &page->anon;
+
+	if (anon_page->zswap != NULL) {
+		zswap_load (anon_page->zswap, kva);
+		zswap_free (anon_page->zswap, false);
+		anon_page->zswap = NULL;
+	} else if (anon_page->slot_number != -1) {
+		swap_read (anon_page->slot_number, kva);
+		bitmap_reset (swap_table, anon_page->slot_number);
+		anon_page->slot_number = -1;
+		swap_in_cnt++;
+	} else {
+		memset (kva, 0, PGSIZE);
+		return false;
+	}
+	return true;
+}
+
+/* Saves KVA, the contents of PAGE, in the compressed pool or,
+ * failing that, in a swap slot.  Returns false if both are full.
+ * swap_lock must be held. */
+static bool
+swap_store (struct page *page, const void *kva) {
+	struct anon_page *anon_page = &page->anon;
+	size_t slot;
+
+	anon_page->zswap = zswap_store (page, kva);
+	if (anon_page->zswap != NULL) {
+		zswap_shrink ();
+		return true;
+	}
+
+	slot = bitmap_scan_and_flip (swap_table, 0, 1, false);
+	if (slot == BITMAP_ERROR)
+		return false;
+	anon_page->slot_number = slot;
+	swap_write (slot, kva);
+	return true;
+}
+
+/* Frees PAGE's swap slot or compressed copy, if it has one.
+ * Returns true if it did.  swap_lock must be held. */
+static bool
+swap_discard (struct page *page) {
+	struct anon_page *anon_page = &page->anon;
+
+	if (anon_page->zswap != NULL) {
+		zswap_free (anon_page->zswap, false);
+		anon_page->zswap = NULL;
+	} else if (anon_page->slot_number != -1) {
+		bitmap_reset (swap_table, anon_page->slot_number);
+		anon_page->slot_number = -1;
+	} else
+		return false;
 	return true;
 }
 
 /* Swap in the page by read contents from the swap disk. */
 static bool
 anon_swap_in (struct page *page, void *kva) {
-	struct anon_page *anon_page = &page->anon;
+	bool loaded;
+
+	lock_acquire (&swap_lock);
+	loaded = swap_load (page, kva);
+	lock_release (&swap_lock);
+
+	if (loaded)
+		vm_account (thread_current (), 0, -1, 0);
+	return true;
+}
+
+/* Copies PAGE, which is in swap, into KVA, leaving it in swap. */
+void
+anon_swap_read (struct page *page, void *kva) {
+	lock_acquire (&swap_lock);
+	if (page->anon.zswap != NULL)
+		zswap_load (page->anon.zswap, kva);
+	else if (page->anon.slot_number != -1)
+		swap_read (page->anon.slot_number, kva);
+	else
+		memset (kva, 0, PGSIZE);
+	lock_release (&swap_lock);
 }
 
-/* Swap out the page by writing contents to the swap disk. */
+/* Swap out the page by compressing it into memory or, failing
+ * that, writing contents to the swap disk. */
 static bool
 anon_swap_out (struct page *page) {
-	struct anon_page *anon_page = &page->anon;
+	struct frame *frame = page->frame;
+	uint64_t *pml4 = frame->owner->pml4;
+
+	/* 매핑을 먼저 지워 압축하거나 쓰는 동안 내용이 바뀌지 않게 한다.
+	 * 그 사이 다시 폴트가 나면 anon_swap_in()이 swap_lock에서
+	 * 기다린다 */
+	lock_acquire (&swap_lock);
+	page->frame = NULL;
+	pml4_clear_page (pml4, page->va);
+
+	if (!swap_store (page, frame->kva)) {
+		/* 둘 다 자리가 없으니 매핑을 되돌린다 */
+		page->frame = frame;
+		pml4_set_page (pml4, page->va, frame->kva, page->writable);
+		lock_release (&swap_lock);
+		return false;
+	}
+	lock_release (&swap_lock);
+	return true;
+}
+
+/* Frees PAGE's swap slot or compressed copy, if it has one.
+ * Returns true if it did. */
+bool
+anon_swap_discard (struct page *page) {
+	bool had_slot;
+
+	lock_acquire (&swap_lock);
+	had_slot = swap_discard (page);
+	lock_release (&swap_lock);
+
+	if (had_slot)
+		vm_account (thread_current (), 0, -1, 0);
+	return had_slot;
+}
+
+/* Saves KVA, the contents of PAGE, the way anon_swap_out() does,
+ * for a page that is not any one process's; see vm/shm.c.  The
+ * caller unmaps it first and charges the swap use to no one.
+ * Returns false if there is no room. */
+bool
+anon_swap_save (struct page *page, const void *kva) {
+	bool saved;
+
+	lock_acquire (&swap_lock);
+	saved = swap_store (page, kva);
+	lock_release (&swap_lock);
+	return saved;
+}
+
+/* Reads back into KVA what anon_swap_save() saved of PAGE, freeing
+ * the copy, or zeroes KVA if nothing was saved.  Returns true if
+ * the copy was on disk. */
+bool
+anon_swap_restore (struct page *page, void *kva) {
+	bool on_disk;
+
+	/* 풀의 항목은 다른 페이지를 넣을 때 디스크로 옮겨질 수 있다 */
+	lock_acquire (&swap_lock);
+	on_disk = page->anon.zswap == NULL && page->anon.slot_number != -1;
+	swap_load (page, kva);
+	lock_release (&swap_lock);
+	return on_disk;
+}
+
+/* Frees what anon_swap_save() saved of PAGE, if anything. */
+void
+anon_swap_drop (struct page *page) {
+	lock_acquire (&swap_lock);
+	swap_discard (page);
+	lock_release (&swap_lock);
 }
 
 /* Destroy the anonymous page. PAGE will be freed by the caller. */
+/* 프레임은 pml4_destroy()가 해제하므로 구조체만 놓는다 */
 static void
 anon_destroy (struct page *page) {
-	struct anon_page *anon_page = &page->anon;
-	free(page->frame);
-	return;
+	anon_swap_discard (page);
+	vm_frame_free (page, false);
+}
+
+/* Prints swap statistics. */
+void
+swap_print_stats (void) {
+	printf ("Swap: %zu of %zu slots used, %lld pages out, %lld in\n",
+			bitmap_count (swap_table, 0, bitmap_size (swap_table), true),
+			bitmap_size (swap_table), swap_out_cnt, swap_in_cnt);
+	zswap_print_stats ();
 }
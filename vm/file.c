@@ -1,8 +1,16 @@
 /* file.c: Implementation of memory backed file object (mmaped object). */
 
 #include "vm/vm.h"
+#include <round.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/synch.h"
 #include "include/threads/vaddr.h"
 #include "include/userprog/process.h"
+#include "vm/madvise.h"
+#include "vm/text.h"
 
 static bool file_backed_swap_in (struct page *page, void *kva);
 static bool file_backed_swap_out (struct page *page);
@@ -16,77 +24,253 @@ static const struct page_operations file_ops = {
 	.type = VM_FILE,
 };
 
+/* Held while an evicted page is written back, so that a fault on
+ * it does not read the file before the write is done. */
+static struct lock writeback_lock;
+
 /* The initializer of file vm */
 void
 vm_file_init (void) {
+	lock_init (&writeback_lock);
 }
 
 /* Initialize the file backed page */
 bool
 file_backed_initializer (struct page *page, enum vm_type type, void *kva) {
+	/* page->uninit과 page->file은 union이므로 덮어쓰기 전에 aux를 꺼낸다 */
+	struct segment *seg = page->uninit.aux;
+
 	/* Set up the handler */
 	page->operations = &file_ops;
 
 	struct file_page *file_page = &page->file;
+	file_page->file = seg->file;
+	file_page->offset = seg->offset;
+	file_page->page_read_bytes = seg->page_read_bytes;
+	file_page->page_zero_bytes = seg->page_zero_bytes;
+	return true;
+}
+
+/* Writes PAGE, held in KVA, back to its file if T, the process
+ * mapping it, dirtied it, and marks it clean. */
+static void
+file_backed_writeback (struct page *page, struct thread *t, void *kva) {
+	struct file_page *file_page = &page->file;
+	bool dirty = pml4_is_dirty (t->pml4, page->va);
+
+	if (dirty)
+		file_write_at (file_page->file, kva,
+				file_page->page_read_bytes, file_page->offset);
+	if (dirty)
+		pml4_set_dirty (t->pml4, page->va, false);
+}
+
+/* Writes PAGE, a private file page mapped in T at KVA, back to its
+ * file if it is dirty, ahead of its eviction, and leaves it
+ * mapped.  The caller must hold PAGE's frame with vm_frame_take(),
+ * so that T cannot free the page meanwhile.  Returns true if it
+ * wrote. */
+bool
+file_backed_clean (struct page *page, struct thread *t, void *kva) {
+	struct file_page *file_page = &page->file;
+	enum intr_level old_level;
+
+	/* 주인이 쓰는 동안에도 돌 수 있으므로 dirty 비트를 먼저 끈다.
+	 * 쓰는 사이에 바뀐 내용은 비트가 다시 켜져 다음에 쓰인다 */
+	old_level = intr_disable ();
+	if (!pml4_is_dirty (t->pml4, page->va)) {
+		intr_set_level (old_level);
+		return false;
+	}
+	pml4_set_dirty (t->pml4, page->va, false);
+	intr_set_level (old_level);
+
+	file_write_at (file_page->file, kva, file_page->page_read_bytes,
+			file_page->offset);
+	return true;
 }
 
 /* Swap in the page by read contents from the file. */
 static bool
 file_backed_swap_in (struct page *page, void *kva) {
 	struct file_page *file_page UNUSED = &page->file;
+
+	/* 쫓겨나는 중인 페이지라면 다 쓸 때까지 기다린다 */
+	lock_acquire (&writeback_lock);
+	lock_release (&writeback_lock);
+	if (file_read_at (file_page->file, kva, file_page->page_read_bytes,
+				file_page->offset) != (off_t) file_page->page_read_bytes)
+		return false;
+	memset (kva + file_page->page_read_bytes, 0, file_page->page_zero_bytes);
+	return true;
 }
 
 /* Swap out the page by writeback contents to the file. */
 static bool
 file_backed_swap_out (struct page *page) {
 	struct file_page *file_page UNUSED = &page->file;
+	struct frame *frame = page->frame;
+	struct thread *t = frame->owner;
+
+	/* 매핑을 지워도 dirty 비트는 PTE에 남는다 */
+	lock_acquire (&writeback_lock);
+	page->frame = NULL;
+	pml4_clear_page (t->pml4, page->va);
+	file_backed_writeback (page, t, frame->kva);
+	lock_release (&writeback_lock);
+	return true;
 }
 
 /* Destory the file backed page. PAGE will be freed by the caller. */
+/* 공유 프레임은 spt_free_page()가 이미 놓았으므로 여기서는 개인
+ * 프레임만 정리한다 */
 static void
 file_backed_destroy (struct page *page) {
 	struct file_page *file_page UNUSED = &page->file;
+	struct thread *t = thread_current ();
+
+	if (page->frame == NULL)
+		return;
+	/* pml4가 이미 없어졌다면 프레임도 pml4_destroy()가 해제했다 */
+	if (t->pml4 != NULL) {
+		file_backed_writeback (page, t, page->frame->kva);
+		pml4_clear_page (t->pml4, page->va);
+		vm_frame_free (page, true);
+	} else
+		vm_frame_free (page, false);
+}
+
+static bool
+page_absent (struct page *page UNUSED, void *aux UNUSED) {
+	return false;
 }
 
 /* Do the mmap */
+/* ADDR부터 LENGTH 바이트에 FILE의 OFFSET부터를 매핑한다.
+ * 파일 끝을 넘는 부분은 0으로 채운다. 실패하면 NULL */
 void *
 do_mmap (void *addr, size_t length, int writable, struct file *file, off_t offset) 
 {
-	struct file* reopen_file = file_reopen(file); // 파일 객체를 복제하여 복제된 객체의 주소 리턴
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	size_t page_cnt = DIV_ROUND_UP (length, PGSIZE);
+	off_t file_len = file_length (file);
+	size_t read_bytes = offset < file_len ? (size_t) (file_len - offset) : 0;
+	struct mmap_region *region;
+	void *upage = addr;
+
+	if (read_bytes > length)
+		read_bytes = length;
 
-	void *origin_addr = addr;
-	size_t read_bytes = length < PGSIZE ? PGSIZE : file_length(file);
-	size_t zero_bytes = PGSIZE - read_bytes%PGSIZE;
+	/* 이미 쓰고 있는 페이지와 겹치면 실패 */
+	if (!spt_for_each (spt, addr, addr + page_cnt * PGSIZE, page_absent, NULL))
+		return NULL;
 
-	while (read_bytes > 0 || zero_bytes > 0){
+	region = malloc (sizeof *region);
+	if (region == NULL)
+		return NULL;
+	region->file = file_reopen (file); // 파일 객체를 복제하여 복제된 객체의 주소 리턴
+	if (region->file == NULL) {
+		free (region);
+		return NULL;
+	}
+	region->addr = addr;
+	region->page_cnt = page_cnt;
+
+	for (size_t i = 0; i < page_cnt; i++) {
 		size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
 		size_t page_zero_bytes = PGSIZE - page_read_bytes;
 
 		struct segment *seg = calloc(1, sizeof(struct segment));
+		if (seg == NULL)
+			goto error;
 		seg->page_read_bytes = page_read_bytes;
 		seg->page_zero_bytes = page_zero_bytes;
 		seg->offset = offset;
-		seg->file = reopen_file;
+		seg->file = region->file;
 
-		void *aux = seg;
-		if (!vm_alloc_page_with_initializer(VM_FILE, addr, writable,lazy_load_segment,aux)){
+		if (!vm_alloc_page_with_initializer(VM_FILE, upage, writable, lazy_load_segment, seg)){
 			free(seg);
-			return false;
+			goto error;
 		}
-		
+
 		read_bytes -= page_read_bytes;
-		zero_bytes =- page_zero_bytes;
-		offset += page_read_bytes;
-		addr += PGSIZE;
+		offset += PGSIZE;
+		upage += PGSIZE;
 	}
 
-	return origin_addr;
+	list_push_back (&spt->regions, &region->elem);
+	return addr;
+
+error:
+	spt_remove_range (spt, addr, upage);
+	file_close (region->file);
+	free (region);
+	return NULL;
 }
 
 /* Do the munmap */
+/* ADDR에서 시작하는 매핑을 해제한다. 수정된 페이지만 파일에 쓴다 */
 void
 do_munmap (void *addr) {
-	
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct list_elem *e;
+
+	for (e = list_begin (&spt->regions); e != list_end (&spt->regions);
+			e = list_next (e)) {
+		struct mmap_region *region = list_entry (e, struct mmap_region, elem);
+		if (region->addr == addr) {
+			list_remove (e);
+			spt_remove_range (spt, addr, addr + region->page_cnt * PGSIZE);
+			madvise_clear (spt, addr, addr + region->page_cnt * PGSIZE);
+			file_close (region->file);
+			free (region);
+			return;
+		}
+	}
 }
 
+static bool
+msync_page (struct page *page, void *aux UNUSED) {
+	if (VM_TYPE (page->operations->type) != VM_FILE)
+		return true;
+	/* 공유 프레임은 매핑한 모든 프로세스의 dirty 비트를 모아 쓴다 */
+	if (page->text != NULL) {
+		text_writeback (page);
+		return true;
+	}
+	/* 쓰는 동안 쫓겨나지 않도록 프레임 테이블에서 잠시 뺀다 */
+	vm_frame_pin (page);
+	if (page->frame != NULL) {
+		file_backed_writeback (page, thread_current (), page->frame->kva);
+		vm_frame_register (page->frame);
+	}
+	return true;
+}
+
+/* Writes the dirty mapped pages in [ADDR, ADDR + LENGTH) back to
+ * their files without unmapping them.  Returns false if the range
+ * is not entirely mapped from files. */
+bool
+do_msync (void *addr, size_t length) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	void *start = pg_round_down (addr);
+	void *end = addr + length;
+
+	for (void *va = start; va < end; va += PGSIZE) {
+		struct page *page = spt_find_page (spt, va);
+		if (page == NULL || page_get_type (page) != VM_FILE)
+			return false;
+	}
+	spt_for_each (spt, start, end, msync_page, NULL);
+	return true;
+}
 
+/* Unmaps every region of SPT, writing back dirty pages. */
+void
+mmap_unmap_all (struct supplemental_page_table *spt) {
+	while (!list_empty (&spt->regions)) {
+		struct mmap_region *region =
+			list_entry (list_front (&spt->regions), struct mmap_region, elem);
+		do_munmap (region->addr);
+	}
+}
@@ -0,0 +1,398 @@
+/* ioring.c: Asynchronous file I/O through shared rings.
+ *
+ * A process that reads or writes a file waits in the system call
+ * until the disk is done.  A ring lets it queue the I/O instead and
+ * keep computing.  ioring_create() maps a control page, holding a
+ * submission and a completion queue (see <ioring.h>), and a buffer
+ * area into the process through its spt.  The process fills in
+ * submissions and calls ioring_submit(), which takes them off the
+ * queue and hands them to the "ioring" workqueue, and can also wait
+ * there for completions.  A worker carries each request out and
+ * posts its result to the completion queue, which the process can
+ * poll without a system call.
+ *
+ * The pages are user pool pages owned here and mapped pinned, so
+ * that workers, which run outside the process, reach the queues
+ * and buffers through their kernel addresses without faulting,
+ * and I/O may only use the buffer area.  A ring's requests run in
+ * the order they were submitted, one at a time, which makes an
+ * fsync a barrier for everything before it; different rings run
+ * side by side. */
+
+#include "vm/ioring.h"
+#include <debug.h>
+#include <ioring.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <uio.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "threads/workqueue.h"
+#include "userprog/syscall.h"
+#include "vm/vm.h"
+
+/* Worker threads serving all rings. */
+#define IORING_WORKERS 2
+
+/* A ring set up by a process.  The control page and buffer area
+ * are writable by the process, so the kernel keeps its own copy of
+ * what it must be able to trust. */
+struct ioring_ctx {
+	struct ioring_ctx *next;            /* Next ring of the same process. */
+	void *uaddr;                        /* Where the process maps it. */
+	struct ioring *ring;                /* Control page, kernel address. */
+	unsigned entries;                   /* Size of each queue. */
+	size_t buf_size;                    /* Bytes in the buffer area. */
+	size_t page_cnt;                    /* Pages, the control page first. */
+	void **pages;                       /* Kernel addresses of the pages. */
+	struct iovec *iov;                  /* Scratch for the running request. */
+
+	struct lock lock;                   /* Guards the members below. */
+	struct condition done;              /* Signalled on each completion. */
+	struct list queue;                  /* Requests not started, oldest first. */
+	unsigned inflight;                  /* Requests taken, not completed. */
+	bool busy;                          /* A worker is running the queue? */
+	struct work work;                   /* Runs the queue on ioring_wq. */
+};
+
+/* A request taken off a submission queue. */
+struct ioring_req {
+	struct list_elem elem;              /* Element in ioring_ctx's queue. */
+	struct ioring_sqe sqe;              /* Copy of the submission. */
+	struct file *file;                  /* The file, reopened. */
+};
+
+static struct workqueue *ioring_wq;
+
+/* Statistics. */
+static long long ring_cnt;              /* Rings set up. */
+static long long submit_cnt;            /* Calls to ioring_submit(). */
+static long long wait_cnt;              /* ...of them that had to wait. */
+static long long req_cnt;               /* Requests completed. */
+static long long fail_cnt;              /* ...of them with result -1. */
+static long long byte_cnt;              /* Bytes read and written. */
+
+static void ioring_work (void *ctx_);
+
+/* Starts the workers. */
+void
+ioring_init (void) {
+	ASSERT (sizeof (struct ioring) <= PGSIZE);
+
+	ioring_wq = workqueue_create ("ioring", IORING_WORKERS, PRI_DEFAULT, 1);
+	if (ioring_wq == NULL)
+		PANIC ("cannot create ioring workqueue");
+}
+
+/* Frees CTX and its pages, which must no longer be mapped or in
+ * use by a request. */
+static void
+ioring_free (struct ioring_ctx *ctx) {
+	for (size_t i = 0; i < ctx->page_cnt; i++)
+		if (ctx->pages[i] != NULL)
+			palloc_free_page (ctx->pages[i]);
+	free (ctx->pages);
+	free (ctx->iov);
+	free (ctx);
+}
+
+/* Sets up a ring with ENTRIES entries per queue and BUF_SIZE bytes
+ * of buffer area, and maps it at ADDR in the current process: the
+ * control page, then the buffer area.  Returns false if ADDR is
+ * misaligned or any of the pages it needs is taken, if ENTRIES or
+ * BUF_SIZE is out of range, or if memory runs out. */
+bool
+ioring_create (void *addr, unsigned entries, size_t buf_size) {
+	struct thread *t = thread_current ();
+	struct ioring_ctx *ctx;
+	size_t page_cnt, mapped;
+	uintptr_t start = (uintptr_t) addr;
+
+	if (entries == 0 || entries > IORING_MAX_ENTRIES
+			|| (entries & (entries - 1)) != 0 || buf_size > IORING_MAX_BUF)
+		return false;
+	page_cnt = 1 + DIV_ROUND_UP (buf_size, PGSIZE);
+	if (addr == NULL || pg_ofs (addr) != 0
+			|| start + page_cnt * PGSIZE > KERN_BASE)
+		return false;
+	for (size_t i = 0; i < page_cnt; i++)
+		if (spt_find_page (&t->spt, addr + i * PGSIZE) != NULL)
+			return false;
+
+	ctx = calloc (1, sizeof *ctx);
+	if (ctx == NULL)
+		return false;
+	ctx->uaddr = addr;
+	ctx->entries = entries;
+	ctx->buf_size = buf_size;
+	ctx->page_cnt = page_cnt;
+	ctx->pages = calloc (page_cnt, sizeof *ctx->pages);
+	ctx->iov = calloc (page_cnt, sizeof *ctx->iov);
+	if (ctx->pages == NULL || ctx->iov == NULL) {
+		ioring_free (ctx);
+		return false;
+	}
+
+	for (mapped = 0; mapped < page_cnt; mapped++) {
+		ctx->pages[mapped] = palloc_get_page (PAL_USER | PAL_ZERO);
+		if (ctx->pages[mapped] == NULL
+				|| !vm_map_pinned (addr + mapped * PGSIZE, ctx->pages[mapped]))
+			break;
+	}
+	if (mapped < page_cnt) {
+		while (mapped-- > 0)
+			spt_remove_page (&t->spt, spt_find_page (&t->spt,
+						addr + mapped * PGSIZE));
+		ioring_free (ctx);
+		return false;
+	}
+
+	ctx->ring = ctx->pages[0];
+	ctx->ring->entries = entries;
+	ctx->ring->buf_size = buf_size;
+	ctx->ring->buf = buf_size > 0 ? addr + PGSIZE : NULL;
+	lock_init (&ctx->lock);
+	cond_init (&ctx->done);
+	list_init (&ctx->queue);
+	work_init (&ctx->work, ioring_work, ctx, PRI_DEFAULT);
+
+	ctx->next = t->iorings;
+	t->iorings = ctx;
+	ring_cnt++;
+	return true;
+}
+
+/* Posts a completion with USER_DATA and RES to CTX's completion
+ * queue.  CTX's lock must be held, and the queue must have room,
+ * which ioring_submit() made sure of. */
+static void
+ioring_complete (struct ioring_ctx *ctx, uint64_t user_data, int res) {
+	struct ioring *ring = ctx->ring;
+	struct ioring_cqe *cqe = &ring->cqes[ring->cq_tail & (ctx->entries - 1)];
+	enum intr_level old_level;
+
+	ASSERT (lock_held_by_current_thread (&ctx->lock));
+
+	cqe->user_data = user_data;
+	cqe->res = res;
+	/* 항목을 다 쓴 뒤에 꼬리를 옮긴다 */
+	barrier ();
+	ring->cq_tail++;
+	cond_broadcast (&ctx->done, &ctx->lock);
+
+	old_level = intr_disable ();
+	req_cnt++;
+	if (res < 0)
+		fail_cnt++;
+	else
+		byte_cnt += res;
+	intr_set_level (old_level);
+}
+
+/* Checks SQE, a submission to CTX, and returns the file it reads
+ * or writes, reopened so that the process closing the descriptor
+ * meanwhile does no harm.  Returns a null pointer if SQE is
+ * bad. */
+static struct file *
+ioring_check (struct ioring_ctx *ctx, const struct ioring_sqe *sqe) {
+	uintptr_t buf = (uintptr_t) sqe->buf;
+	uintptr_t area = (uintptr_t) ctx->uaddr + PGSIZE;
+	struct file *file;
+
+	switch (sqe->opcode) {
+		case IORING_OP_READ:
+		case IORING_OP_WRITE:
+			if (sqe->off < 0 || buf < area || sqe->len > ctx->buf_size
+					|| buf - area > ctx->buf_size - sqe->len)
+				return NULL;
+			break;
+		case IORING_OP_FSYNC:
+			break;
+		default:
+			return NULL;
+	}
+
+	file = get_regular_file (sqe->fd);
+	if (file == NULL)
+		return NULL;
+	lock_acquire (&filesys_lock);
+	file = file_reopen (file);
+	lock_release (&filesys_lock);
+	return file;
+}
+
+/* Takes the submissions the current process queued on its ring at
+ * ADDR, as many as the completion queue has room for, and starts
+ * them.  Then, if MIN_COMPLETE is nonzero, waits until that many
+ * completions are waiting to be read, or until nothing is left in
+ * flight.  Returns the number of submissions taken, or -1 if there
+ * is no ring at ADDR. */
+int
+ioring_submit (void *addr, unsigned min_complete) {
+	struct ioring_ctx *ctx;
+	struct ioring *ring;
+	uint32_t tail;
+	int taken = 0;
+
+	for (ctx = thread_current ()->iorings; ctx != NULL; ctx = ctx->next)
+		if (ctx->uaddr == addr)
+			break;
+	if (ctx == NULL)
+		return -1;
+	ring = ctx->ring;
+	submit_cnt++;
+
+	tail = ring->sq_tail;
+	/* 꼬리를 읽은 뒤에 항목을 읽는다 */
+	barrier ();
+	lock_acquire (&ctx->lock);
+	while (ring->sq_head != tail
+			&& ring->cq_tail - ring->cq_head + ctx->inflight < ctx->entries) {
+		struct ioring_sqe sqe = ring->sqes[ring->sq_head & (ctx->entries - 1)];
+		struct ioring_req *req;
+
+		ring->sq_head++;
+		taken++;
+		if (sqe.opcode == IORING_OP_NOP) {
+			ioring_complete (ctx, sqe.user_data, 0);
+			continue;
+		}
+
+		/* 파일을 다시 여는 동안에는 링을 잠그지 않는다 */
+		lock_release (&ctx->lock);
+		req = malloc (sizeof *req);
+		if (req != NULL) {
+			req->sqe = sqe;
+			req->file = ioring_check (ctx, &sqe);
+			if (req->file == NULL) {
+				free (req);
+				req = NULL;
+			}
+		}
+		lock_acquire (&ctx->lock);
+		if (req == NULL)
+			ioring_complete (ctx, sqe.user_data, -1);
+		else {
+			list_push_back (&ctx->queue, &req->elem);
+			ctx->inflight++;
+		}
+	}
+	if (!list_empty (&ctx->queue))
+		queue_work (ioring_wq, &ctx->work);
+
+	if (min_complete > ctx->entries)
+		min_complete = ctx->entries;
+	if (ring->cq_tail - ring->cq_head < min_complete && ctx->inflight > 0)
+		wait_cnt++;
+	while (ring->cq_tail - ring->cq_head < min_complete && ctx->inflight > 0)
+		cond_wait (&ctx->done, &ctx->lock);
+	lock_release (&ctx->lock);
+	return taken;
+}
+
+/* Carries out REQ, a request of CTX, and returns its result. */
+static int
+ioring_do (struct ioring_ctx *ctx, struct ioring_req *req) {
+	const struct ioring_sqe *sqe = &req->sqe;
+	size_t ofs = (uintptr_t) sqe->buf - (uintptr_t) ctx->uaddr;
+	size_t left = sqe->len;
+	int iovcnt = 0;
+	off_t res = 0;
+
+	if (sqe->opcode == IORING_OP_FSYNC) {
+		/* 쓰기는 디스크까지 바로 가고, 앞선 요청은 모두 끝났다 */
+		lock_acquire (&filesys_lock);
+		file_close (req->file);
+		lock_release (&filesys_lock);
+		return 0;
+	}
+
+	/* 버퍼 영역은 프로세스에게만 연속이므로 페이지마다 나눈다 */
+	while (left > 0) {
+		size_t chunk = PGSIZE - ofs % PGSIZE;
+
+		if (chunk > left)
+			chunk = left;
+		ctx->iov[iovcnt].iov_base = (uint8_t *) ctx->pages[ofs / PGSIZE]
+			+ ofs % PGSIZE;
+		ctx->iov[iovcnt].iov_len = chunk;
+		iovcnt++;
+		ofs += chunk;
+		left -= chunk;
+	}
+
+	lock_acquire (&filesys_lock);
+	if (sqe->opcode == IORING_OP_READ)
+		res = file_readv_at (req->file, ctx->iov, iovcnt, sqe->off);
+	else
+		res = file_writev_at (req->file, ctx->iov, iovcnt, sqe->off);
+	file_close (req->file);
+	lock_release (&filesys_lock);
+	return res;
+}
+
+/* Runs the requests queued on ring CTX_, in order.  Does nothing if
+ * another worker is already at it, since that one will also run
+ * any requests queued meanwhile. */
+static void
+ioring_work (void *ctx_) {
+	struct ioring_ctx *ctx = ctx_;
+
+	lock_acquire (&ctx->lock);
+	if (ctx->busy) {
+		lock_release (&ctx->lock);
+		return;
+	}
+	ctx->busy = true;
+	while (!list_empty (&ctx->queue)) {
+		struct ioring_req *req = list_entry (list_pop_front (&ctx->queue),
+				struct ioring_req, elem);
+		int res;
+
+		lock_release (&ctx->lock);
+		res = ioring_do (ctx, req);
+		lock_acquire (&ctx->lock);
+		ioring_complete (ctx, req->sqe.user_data, res);
+		ctx->inflight--;
+		free (req);
+	}
+	ctx->busy = false;
+	cond_broadcast (&ctx->done, &ctx->lock);
+	lock_release (&ctx->lock);
+}
+
+/* Waits for the requests of the current process's rings to finish
+ * and frees the rings.  Called when its address space goes away,
+ * after its spt, which unmaps the rings' pages. */
+void
+ioring_exit (void) {
+	struct thread *t = thread_current ();
+
+	while (t->iorings != NULL) {
+		struct ioring_ctx *ctx = t->iorings;
+
+		t->iorings = ctx->next;
+		lock_acquire (&ctx->lock);
+		while (ctx->inflight > 0 || ctx->busy)
+			cond_wait (&ctx->done, &ctx->lock);
+		lock_release (&ctx->lock);
+		/* 큐에서 이미 꺼냈지만 아직 돌지 않은 작업이 CTX를 가리킬 수
+		 * 있다 */
+		cancel_work (&ctx->work);
+		workqueue_flush (ioring_wq);
+		ioring_free (ctx);
+	}
+}
+
+/* Prints ring statistics. */
+void
+ioring_print_stats (void) {
+	printf ("Ioring: %lld rings, %lld submits (%lld waited), "
+			"%lld requests (%lld failed), %lld bytes\n",
+			ring_cnt, submit_cnt, wait_cnt, req_cnt, fail_cnt, byte_cnt);
+}
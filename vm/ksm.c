@@ -0,0 +1,317 @@
+/* ksm.c: Merging anonymous pages with the same contents.
+ *
+ * Forked processes often keep many pages that their parent gave
+ * them and that none of them ever writes again.  The ksm thread
+ * walks the frame table a few frames at a time, at low priority,
+ * and hashes the contents of the anonymous pages it finds idle: it
+ * clears the accessed bit of each page it passes, and a page whose
+ * bit is still clear on the next walk was not used in between.
+ * A page whose hash is unchanged since the last walk is stable
+ * enough to merge: if a shared frame with the same contents
+ * exists, the page is mapped read-only to it and its own frame is
+ * freed; otherwise, if another stable page of the same hash was
+ * seen, the two are merged into a new shared frame made of the
+ * other page's frame.  The first write to a merged page faults
+ * and gives the page a copy of its own; see vm_handle_wp().
+ *
+ * Shared frames are kept in stable_table, keyed on their
+ * contents.  Candidate pages are kept in unstable_table, keyed on
+ * their hash only, and checked again before they are merged.
+ * ksm_lock protects both and the ksm fields of every page; the
+ * frame table lock is taken first when both are needed. */
+
+#include "vm/ksm.h"
+#include <debug.h>
+#include <hash.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/vm.h"
+
+/* Frames hashed per walk, and timer ticks between walks. */
+#define KSM_SCAN_PAGES 32
+#define KSM_SLEEP_TICKS 20
+
+struct ksm_frame {
+	struct hash_elem elem;      /* Element in stable_table. */
+	uint64_t sum;               /* Hash of the contents. */
+	void *kva;                  /* The frame. */
+	int ref_cnt;                /* Number of pages mapping it. */
+};
+
+static struct hash stable_table;
+static struct hash unstable_table;
+static struct lock ksm_lock;
+
+/* Statistics. */
+static long long scan_cnt;              /* Frames hashed. */
+static long long merge_cnt;             /* Pages merged. */
+static long long unshare_cnt;           /* ...given a copy back. */
+static long saved_cnt;                  /* Frames saved right now. */
+
+static void ksm_thread (void *aux);
+
+static uint64_t
+page_sum (const void *kva) {
+	return hash_bytes (kva, PGSIZE);
+}
+
+static uint64_t
+stable_hash (const struct hash_elem *e, void *aux UNUSED) {
+	return hash_entry (e, struct ksm_frame, elem)->sum;
+}
+
+static bool
+stable_less (const struct hash_elem *a_, const struct hash_elem *b_,
+		void *aux UNUSED) {
+	const struct ksm_frame *a = hash_entry (a_, struct ksm_frame, elem);
+	const struct ksm_frame *b = hash_entry (b_, struct ksm_frame, elem);
+
+	if (a->sum != b->sum)
+		return a->sum < b->sum;
+	return memcmp (a->kva, b->kva, PGSIZE) < 0;
+}
+
+static uint64_t
+unstable_hash (const struct hash_elem *e, void *aux UNUSED) {
+	return hash_entry (e, struct page, ksm_elem)->ksm_sum;
+}
+
+static bool
+unstable_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux UNUSED) {
+	return hash_entry (a, struct page, ksm_elem)->ksm_sum
+		< hash_entry (b, struct page, ksm_elem)->ksm_sum;
+}
+
+/* Initializes the tables and starts the ksm thread. */
+void
+ksm_init (void) {
+	hash_init (&stable_table, stable_hash, stable_less, NULL);
+	hash_init (&unstable_table, unstable_hash, unstable_less, NULL);
+	lock_init (&ksm_lock);
+	thread_create ("ksm", PRI_MIN, ksm_thread, NULL);
+}
+
+/* Returns the kernel virtual address of KSM's frame. */
+void *
+ksm_kva (const struct ksm_frame *ksm) {
+	return ksm->kva;
+}
+
+/* Takes PAGE out of unstable_table if it is there.  ksm_lock must
+ * be held. */
+static void
+unstable_remove (struct page *page) {
+	if (page->ksm_unstable) {
+		hash_delete (&unstable_table, &page->ksm_elem);
+		page->ksm_unstable = false;
+	}
+}
+
+/* Maps PAGE, whose frame FRAME is on the frame table, read-only
+ * to KSM's frame instead, if it still holds the same contents, and
+ * frees its own.  Both locks must be held. */
+static bool
+ksm_merge (struct page *page, struct frame *frame, struct ksm_frame *ksm) {
+	uint64_t *pml4 = frame->owner->pml4;
+	enum intr_level old_level;
+
+	/* 소유 프로세스가 비교와 매핑 사이에 쓰지 못하도록 인터럽트를
+	 * 끄고 한 번에 바꾼다. 페이지 테이블은 이미 있으므로 할당하지
+	 * 않는다 */
+	old_level = intr_disable ();
+	if (memcmp (frame->kva, ksm->kva, PGSIZE) != 0) {
+		intr_set_level (old_level);
+		return false;
+	}
+	pml4_clear_page (pml4, page->va);
+	pml4_set_page (pml4, page->va, ksm->kva, false);
+	intr_set_level (old_level);
+
+	vm_frame_unlink (frame);
+	palloc_free_page (frame->kva);
+	frame->kva = ksm->kva;
+	ksm->ref_cnt++;
+	page->ksm = ksm;
+	merge_cnt++;
+	saved_cnt++;
+	return true;
+}
+
+/* Turns the frame of PAGE, on the frame table, into a new shared
+ * frame with hash SUM, which PAGE then maps read-only.  Both locks
+ * must be held.  Returns the shared frame, or a null pointer if
+ * out of memory. */
+static struct ksm_frame *
+ksm_promote (struct page *page, uint64_t sum) {
+	struct frame *frame = page->frame;
+	uint64_t *pml4 = frame->owner->pml4;
+	struct ksm_frame *ksm = malloc (sizeof *ksm);
+	enum intr_level old_level;
+
+	if (ksm == NULL)
+		return NULL;
+	ksm->sum = sum;
+	ksm->kva = frame->kva;
+	ksm->ref_cnt = 1;
+
+	old_level = intr_disable ();
+	pml4_clear_page (pml4, page->va);
+	pml4_set_page (pml4, page->va, ksm->kva, false);
+	intr_set_level (old_level);
+
+	vm_frame_unlink (frame);
+	hash_insert (&stable_table, &ksm->elem);
+	page->ksm = ksm;
+	return ksm;
+}
+
+/* Returns true if PAGE, a candidate from unstable_table, still has
+ * a frame on the frame table holding contents of hash SUM. */
+static bool
+candidate_valid (struct page *page, uint64_t sum) {
+	return page->frame != NULL && page->frame->evictable
+		&& page->ksm == NULL && page_sum (page->frame->kva) == sum;
+}
+
+/* Hashes the page in FRAME and merges it if it can.  Called
+ * through vm_frame_scan(), with the frame table locked. */
+static void
+ksm_scan_frame (struct frame *frame, void *aux UNUSED) {
+	struct page *page = frame->page;
+	uint64_t *pml4;
+	struct ksm_frame key, *ksm;
+	struct hash_elem *e;
+	uint64_t sum;
+
+	/* 공유 메모리 프레임은 합치지 않는다 */
+	if (frame->owner == NULL)
+		return;
+	pml4 = frame->owner->pml4;
+	if (page_get_type (page) != VM_ANON || page->text != NULL
+			|| pml4 == NULL)
+		return;
+	/* 지난 바퀴 뒤로 쓰인 페이지는 곧 다시 바뀔 것이므로 건너뛰고,
+	 * 비트를 꺼서 다음 바퀴에 다시 본다.  시계 바늘이 참조를 놓치지
+	 * 않도록 ksm_young에 남겨 둔다 */
+	if (pml4_is_accessed (pml4, page->va)) {
+		pml4_set_accessed (pml4, page->va, false);
+		page->ksm_young = true;
+		return;
+	}
+
+	sum = page_sum (frame->kva);
+	scan_cnt++;
+
+	lock_acquire (&ksm_lock);
+	if (sum != page->ksm_sum) {
+		/* 지난번과 내용이 달라졌으니 다음 바퀴에 다시 본다 */
+		unstable_remove (page);
+		page->ksm_sum = sum;
+		goto done;
+	}
+
+	key.sum = sum;
+	key.kva = frame->kva;
+	e = hash_find (&stable_table, &key.elem);
+	if (e != NULL) {
+		unstable_remove (page);
+		ksm_merge (page, frame, hash_entry (e, struct ksm_frame, elem));
+		goto done;
+	}
+
+	if (page->ksm_unstable)
+		goto done;
+	e = hash_insert (&unstable_table, &page->ksm_elem);
+	if (e == NULL) {
+		page->ksm_unstable = true;
+		goto done;
+	}
+
+	/* 같은 해시의 후보가 있다. 아직 같은 내용이면 공유 프레임으로
+	 * 만들어 합치고, 아니면 이 페이지가 후보 자리를 대신한다 */
+	struct page *other = hash_entry (e, struct page, ksm_elem);
+	unstable_remove (other);
+	if (candidate_valid (other, sum)
+			&& memcmp (other->frame->kva, frame->kva, PGSIZE) == 0
+			&& (ksm = ksm_promote (other, sum)) != NULL)
+		ksm_merge (page, frame, ksm);
+	else {
+		hash_insert (&unstable_table, &page->ksm_elem);
+		page->ksm_unstable = true;
+	}
+
+done:
+	lock_release (&ksm_lock);
+}
+
+/* Walks the frame table a few frames at a time, forever. */
+static void
+ksm_thread (void *aux UNUSED) {
+	/* -stride는 우선순위를 보지 않으므로 ticket을 최소로 둔다 */
+	thread_set_tickets (TICKETS_MIN);
+	for (;;) {
+		timer_sleep (KSM_SLEEP_TICKS);
+		vm_frame_scan (KSM_SCAN_PAGES, ksm_scan_frame, NULL);
+	}
+}
+
+/* Drops PAGE's reference to its shared frame, which the caller
+ * has unmapped, freeing the frame along with the last one. */
+static void
+ksm_release (struct page *page) {
+	struct ksm_frame *ksm = page->ksm;
+	bool last;
+
+	lock_acquire (&ksm_lock);
+	page->ksm = NULL;
+	last = --ksm->ref_cnt == 0;
+	if (last)
+		hash_delete (&stable_table, &ksm->elem);
+	else
+		saved_cnt--;
+	lock_release (&ksm_lock);
+
+	if (last) {
+		palloc_free_page (ksm->kva);
+		free (ksm);
+	}
+}
+
+/* Unmaps PAGE, a page of the current process that maps a shared
+ * frame, and drops its reference to the frame.  PAGE's struct
+ * frame is left for the caller.  If UNSHARE, the caller is about
+ * to give PAGE a copy of its own. */
+void
+ksm_unmap (struct page *page, bool unshare) {
+	struct thread *t = thread_current ();
+
+	if (t->pml4 != NULL)
+		pml4_clear_page (t->pml4, page->va);
+	ksm_release (page);
+	if (unshare)
+		unshare_cnt++;
+}
+
+/* Takes PAGE, which is being freed, out of the ksm tables. */
+void
+ksm_forget (struct page *page) {
+	lock_acquire (&ksm_lock);
+	unstable_remove (page);
+	lock_release (&ksm_lock);
+}
+
+/* Prints ksm statistics. */
+void
+ksm_print_stats (void) {
+	printf ("KSM: %lld frames hashed, %lld pages merged, %lld unshared, "
+			"%ld frames saved\n", scan_cnt, merge_cnt, unshare_cnt, saved_cnt);
+}
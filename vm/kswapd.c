@@ -0,0 +1,153 @@
+/* kswapd.c: Reclaiming frames in the background.
+ *
+ * Without help, a process that faults with the user pool empty
+ * evicts a frame itself, and waits for the write to swap or to
+ * its file inside the fault.  The kswapd thread keeps the pool
+ * from running dry instead.  vm_get_frame() wakes it when fewer
+ * than low_wmark user pages are free; it then evicts frames until
+ * high_wmark are free again, and goes back to sleep.  Before each
+ * eviction it also writes back a few dirty file pages ahead of the
+ * clock hand, so that evicting them later costs no write.
+ *
+ * kswapd runs above the default priority, so that once woken it
+ * gets ahead of the processes allocating frames and they only
+ * evict for themselves when it falls behind.  Under -stride, which
+ * ignores priorities, it has KSWAPD_TICKETS tickets instead. */
+
+#include "vm/kswapd.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "vm/vm.h"
+
+/* Fraction of the user pool below which kswapd wakes, as a
+ * divisor.  It stops at twice as many free pages. */
+#define KSWAPD_LOW_DIV 32
+#define KSWAPD_LOW_MIN 4
+
+/* Tickets kswapd runs with under -stride. */
+#define KSWAPD_TICKETS (4 * TICKETS_DEFAULT)
+
+/* Frames looked at for dirty file pages per eviction. */
+#define KSWAPD_CLEAN_PAGES 8
+
+static size_t low_wmark, high_wmark;
+static struct semaphore kswapd_sema;
+static bool kswapd_awake;
+
+/* Statistics. */
+static long long wake_cnt;              /* Times woken. */
+static long long reclaim_cnt;           /* Frames evicted. */
+static long long clean_cnt;             /* Dirty pages written ahead. */
+
+static void kswapd_thread (void *aux);
+
+/* Sets the watermarks from the size of the user pool and starts
+ * kswapd. */
+void
+kswapd_init (void) {
+	size_t total;
+
+	palloc_user_free (&total);
+	low_wmark = total / KSWAPD_LOW_DIV;
+	if (low_wmark < KSWAPD_LOW_MIN)
+		low_wmark = KSWAPD_LOW_MIN;
+	high_wmark = 2 * low_wmark;
+	sema_init (&kswapd_sema, 0);
+	thread_create ("kswapd", PRI_DEFAULT + 1, kswapd_thread, NULL);
+}
+
+/* Wakes kswapd if the user pool is low and it is not already
+ * awake. */
+void
+kswapd_wake (void) {
+	enum intr_level old_level;
+
+	if (palloc_user_free (NULL) >= low_wmark)
+		return;
+	old_level = intr_disable ();
+	if (!kswapd_awake) {
+		kswapd_awake = true;
+		sema_up (&kswapd_sema);
+	}
+	intr_set_level (old_level);
+}
+
+/* Frames kswapd_clean_frame() picked to write back. */
+struct clean_batch {
+	struct frame *frames[KSWAPD_CLEAN_PAGES];
+	size_t cnt;
+};
+
+/* Picks the page in FRAME for writing back if it is a dirty
+ * private file page not used lately, taking FRAME off the frame
+ * table until it is written.  Called through vm_frame_scan(), with
+ * the frame table locked. */
+static void
+kswapd_clean_frame (struct frame *frame, void *batch_) {
+	struct clean_batch *batch = batch_;
+	struct page *page = frame->page;
+	uint64_t *pml4;
+
+	/* 공유 프레임은 쫓겨날 때 vm/text.c가 쓴다 */
+	if (frame->owner == NULL || page_get_type (page) != VM_FILE)
+		return;
+	pml4 = frame->owner->pml4;
+	if (pml4 == NULL || pml4_is_accessed (pml4, page->va)
+			|| !pml4_is_dirty (pml4, page->va))
+		return;
+	ASSERT (batch->cnt < KSWAPD_CLEAN_PAGES);
+	vm_frame_take (frame);
+	batch->frames[batch->cnt++] = frame;
+}
+
+/* Writes back a few dirty file pages ahead of the clock hand,
+ * without holding the frame table lock while writing. */
+static void
+kswapd_clean (void) {
+	struct clean_batch batch;
+
+	batch.cnt = 0;
+	vm_frame_scan (KSWAPD_CLEAN_PAGES, kswapd_clean_frame, &batch);
+	for (size_t i = 0; i < batch.cnt; i++) {
+		struct frame *frame = batch.frames[i];
+
+		if (file_backed_clean (frame->page, frame->owner, frame->kva))
+			clean_cnt++;
+		vm_frame_put_back (frame);
+	}
+}
+
+/* Evicts frames whenever woken, until enough are free. */
+static void
+kswapd_thread (void *aux UNUSED) {
+	thread_set_tickets (KSWAPD_TICKETS);
+	for (;;) {
+		enum intr_level old_level;
+
+		sema_down (&kswapd_sema);
+		wake_cnt++;
+		while (palloc_user_free (NULL) < high_wmark) {
+			kswapd_clean ();
+			if (!vm_reclaim_frame ())
+				break;
+			reclaim_cnt++;
+		}
+
+		old_level = intr_disable ();
+		kswapd_awake = false;
+		intr_set_level (old_level);
+	}
+}
+
+/* Prints kswapd statistics. */
+void
+kswapd_print_stats (void) {
+	printf ("Kswapd: watermarks %zu/%zu, woken %lld times, "
+			"%lld frames evicted, %lld dirty pages cleaned\n",
+			low_wmark, high_wmark, wake_cnt, reclaim_cnt, clean_cnt);
+}
@@ -0,0 +1,273 @@
+/* madvise.c: Access hints for ranges of user memory.
+ *
+ * MADV_RANDOM and MADV_SEQUENTIAL last: they are kept as regions
+ * in the supplemental page table, and the fault handler looks them
+ * up to turn fault-around off, or to run it at its widest and drop
+ * the pages a sequential walk has left behind.  MADV_WILLNEED and
+ * MADV_DONTNEED act once, on the pages in the range when they are
+ * given.
+ *
+ * MADV_WILLNEED does not wait for the disk.  It queues the pages
+ * that would be loaded from a file for the prefetch thread, which
+ * reads them into frames it parks in the shared frame table (see
+ * vm/text.c), where the faults on them will find them. */
+
+#include "vm/madvise.h"
+#include <debug.h>
+#include <round.h>
+#include <stdio.h>
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/text.h"
+#include "vm/vm.h"
+
+/* Requests queued past this many are dropped. */
+#define PREFETCH_QUEUE_MAX 256
+
+/* A page for the prefetch thread to read in. */
+struct prefetch {
+	struct text_key key;        /* The page; holds a reopened inode. */
+	struct list_elem elem;      /* Element in prefetch_queue. */
+};
+
+static struct list prefetch_queue;
+static size_t prefetch_queued;
+static struct lock prefetch_lock;
+static struct condition prefetch_cond;
+
+/* Statistics. */
+static long long madvise_cnt;           /* madvise() calls. */
+static long long willneed_cnt;          /* Pages queued for prefetch. */
+static long long prefetch_cnt;          /* ...read in by the thread. */
+static long long dontneed_cnt;          /* Frames dropped. */
+
+static void prefetch_thread (void *aux);
+
+/* Starts the prefetch thread. */
+void
+madvise_init (void) {
+	list_init (&prefetch_queue);
+	lock_init (&prefetch_lock);
+	cond_init (&prefetch_cond);
+	thread_create ("prefetch", PRI_DEFAULT, prefetch_thread, NULL);
+}
+
+/* Reads the page at KEY into a frame parked in the shared frame
+ * table, unless it is there already. */
+static void
+prefetch_page (const struct text_key *key) {
+	struct text_frame *text = text_get (key);
+
+	if (text == NULL)
+		return;
+	/* 이미 읽혀 있는 페이지는 다시 읽지 않고 붙잡아 두기만 한다 */
+	if (text_prefetch (text))
+		prefetch_cnt++;
+	text_park (text);
+}
+
+/* Serves prefetch requests, oldest first. */
+static void
+prefetch_thread (void *aux UNUSED) {
+	for (;;) {
+		struct prefetch *p;
+
+		lock_acquire (&prefetch_lock);
+		while (list_empty (&prefetch_queue))
+			cond_wait (&prefetch_cond, &prefetch_lock);
+		p = list_entry (list_pop_front (&prefetch_queue), struct prefetch,
+				elem);
+		prefetch_queued--;
+		lock_release (&prefetch_lock);
+
+		prefetch_page (&p->key);
+		inode_close (p->key.inode);
+		free (p);
+	}
+}
+
+/* Queues PAGE for the prefetch thread if it would be loaded from a
+ * file.  Called through spt_for_each(). */
+static bool
+willneed_page (struct page *page, void *aux UNUSED) {
+	struct text_key key;
+	struct prefetch *p;
+
+	if (page->frame != NULL || page->zero || !vm_text_key (page, &key))
+		return true;
+
+	p = malloc (sizeof *p);
+	if (p == NULL)
+		return false;
+	p->key = key;
+
+	lock_acquire (&prefetch_lock);
+	if (prefetch_queued >= PREFETCH_QUEUE_MAX) {
+		lock_release (&prefetch_lock);
+		free (p);
+		return false;
+	}
+	/* 요청이 처리될 때까지 파일이 닫혀도 inode는 남아 있어야 한다 */
+	inode_reopen (key.inode);
+	list_push_back (&prefetch_queue, &p->elem);
+	prefetch_queued++;
+	willneed_cnt++;
+	cond_signal (&prefetch_cond, &prefetch_lock);
+	lock_release (&prefetch_lock);
+	return true;
+}
+
+/* Drops PAGE's frame.  Called through spt_for_each(). */
+static bool
+dontneed_page (struct page *page, void *aux UNUSED) {
+	if (vm_drop_frame (page))
+		dontneed_cnt++;
+	return true;
+}
+
+/* Gives the pages of SPT in [START, END) the lasting hint ADVICE,
+ * replacing whatever hint they had.  Returns false if out of
+ * memory. */
+static bool
+madvise_set (struct supplemental_page_table *spt, void *start, void *end,
+		int advice) {
+	struct madvise_region *new = NULL, *tail;
+	struct list_elem *e;
+
+	/* 구간은 서로 겹치지 않으므로 [START, END)를 품어 둘로
+	 * 나뉘는 구간은 많아야 하나다 */
+	tail = malloc (sizeof *tail);
+	if (advice != MADV_NORMAL)
+		new = malloc (sizeof *new);
+	if (tail == NULL || (advice != MADV_NORMAL && new == NULL)) {
+		free (tail);
+		free (new);
+		return false;
+	}
+
+	for (e = list_begin (&spt->advice); e != list_end (&spt->advice);) {
+		struct madvise_region *r = list_entry (e, struct madvise_region, elem);
+
+		if (r->end <= start || r->start >= end)
+			e = list_next (e);
+		else if (r->start < start && r->end > end) {
+			tail->start = end;
+			tail->end = r->end;
+			tail->advice = r->advice;
+			list_insert (list_next (e), &tail->elem);
+			tail = NULL;
+			r->end = start;
+			e = list_next (e);
+		} else if (r->start < start) {
+			r->end = start;
+			e = list_next (e);
+		} else if (r->end > end) {
+			r->start = end;
+			e = list_next (e);
+		} else {
+			e = list_remove (e);
+			free (r);
+		}
+	}
+	free (tail);
+
+	if (new != NULL) {
+		new->start = start;
+		new->end = end;
+		new->advice = advice;
+		list_push_back (&spt->advice, &new->elem);
+	}
+	return true;
+}
+
+/* Forgets the hints for the pages of SPT in [START, END). */
+void
+madvise_clear (struct supplemental_page_table *spt, void *start, void *end) {
+	madvise_set (spt, start, end, MADV_NORMAL);
+}
+
+/* Applies ADVICE to the current process's pages in [ADDR, ADDR +
+ * LENGTH).  ADDR must be page-aligned.  Returns false if ADVICE is
+ * not a hint or if out of memory. */
+bool
+do_madvise (void *addr, size_t length, int advice) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	void *end = addr + ROUND_UP (length, PGSIZE);
+
+	ASSERT (pg_ofs (addr) == 0);
+
+	madvise_cnt++;
+	switch (advice) {
+		case MADV_NORMAL:
+		case MADV_RANDOM:
+		case MADV_SEQUENTIAL:
+			return madvise_set (spt, addr, end, advice);
+		case MADV_WILLNEED:
+			spt_for_each (spt, addr, end, willneed_page, NULL);
+			return true;
+		case MADV_DONTNEED:
+			spt_for_each (spt, addr, end, dontneed_page, NULL);
+			return true;
+		default:
+			return false;
+	}
+}
+
+/* Returns the hint region of SPT that VA lies in, or a null
+ * pointer if VA has no hint. */
+const struct madvise_region *
+madvise_find (struct supplemental_page_table *spt, const void *va) {
+	struct list_elem *e;
+
+	for (e = list_begin (&spt->advice); e != list_end (&spt->advice);
+			e = list_next (e)) {
+		struct madvise_region *r = list_entry (e, struct madvise_region, elem);
+		if (r->start <= va && va < r->end)
+			return r;
+	}
+	return NULL;
+}
+
+/* Returns the lasting hint for VA in SPT. */
+int
+madvise_get (struct supplemental_page_table *spt, const void *va) {
+	const struct madvise_region *r = madvise_find (spt, va);
+	return r != NULL ? r->advice : MADV_NORMAL;
+}
+
+/* Copies the hints of SRC into DST, which has none, for fork(). */
+bool
+madvise_copy (struct supplemental_page_table *dst,
+		struct supplemental_page_table *src) {
+	struct list_elem *e;
+
+	for (e = list_begin (&src->advice); e != list_end (&src->advice);
+			e = list_next (e)) {
+		struct madvise_region *r = list_entry (e, struct madvise_region, elem);
+		struct madvise_region *copy = malloc (sizeof *copy);
+		if (copy == NULL)
+			return false;
+		*copy = *r;
+		list_push_back (&dst->advice, &copy->elem);
+	}
+	return true;
+}
+
+/* Frees the hints of SPT. */
+void
+madvise_destroy (struct supplemental_page_table *spt) {
+	while (!list_empty (&spt->advice))
+		free (list_entry (list_pop_front (&spt->advice),
+					struct madvise_region, elem));
+}
+
+/* Prints madvise statistics. */
+void
+madvise_print_stats (void) {
+	printf ("madvise: %lld calls, %lld pages queued for prefetch "
+			"(%lld read), %lld frames dropped\n",
+			madvise_cnt, willneed_cnt, prefetch_cnt, dontneed_cnt);
+}
@@ -0,0 +1,482 @@
+/* shm.c: Anonymous shared memory segments.
+ *
+ * shm_new() makes a segment of zero-filled pages that any
+ * process may then attach by its id.  Attaching puts pages of the
+ * process's own in its spt, but every process's page for the same
+ * page of the segment maps the one frame that page has, so what
+ * one process writes the others see at once.  Pages are loaded on
+ * their first fault in each process.
+ *
+ * A segment's frames are on the frame table like any anonymous
+ * page's, but with no owner.  Evicting one unmaps it from every
+ * process that has it mapped and saves it through the anonymous
+ * swap path; the next fault in any of them reads it back.  The
+ * swap they use is charged to no process.
+ *
+ * A segment is held by the process that created it, until that
+ * process exits, and by every page attached to it, including the
+ * ones a child inherits through fork().  It is freed, along with
+ * its frames and saved copies, when the last of them lets go.
+ *
+ * shm_lock protects the segment list and every segment.  The frame
+ * table lock is taken first when both are needed, so no function
+ * here takes the frame table lock while holding shm_lock. */
+
+#include "vm/shm.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/vm.h"
+
+struct shm_segment {
+	struct list_elem elem;      /* Element in segment_list. */
+	int id;                     /* Passed to shm_map_at(). */
+	size_t page_cnt;            /* Number of pages. */
+	struct thread *creator;     /* Holds a reference until it exits. */
+	int ref_cnt;                /* Creator plus attached pages. */
+	struct shm_page *pages;     /* PAGE_CNT pages. */
+};
+
+/* One page of a segment. */
+struct shm_page {
+	struct page page;           /* Holds the frame or the saved copy. */
+	struct list maps;           /* Attached pages, as struct shm_map. */
+	struct shm_segment *seg;    /* Segment this is a page of. */
+};
+
+struct shm_map {
+	struct list_elem elem;      /* Element in the shm_page's maps. */
+	struct shm_page *sp;        /* Page of the segment. */
+	struct page *page;          /* Attached page. */
+	struct thread *owner;       /* Process whose page it is. */
+	bool mapped;                /* Has a PTE for the frame? */
+};
+
+static bool shm_swap_in (struct page *page, void *kva);
+static bool shm_swap_out (struct page *page);
+
+/* Operations of the pages that hold a segment's frames.  They are
+ * in no spt; vm_evict_frame() reaches them through the frame
+ * table. */
+static const struct page_operations shm_ops = {
+	.swap_in = shm_swap_in,
+	.swap_out = shm_swap_out,
+	.destroy = NULL,
+	.type = VM_ANON,
+};
+
+/* Returns the segment page whose frame-holding page is PAGE. */
+static struct shm_page *
+shm_page_of (struct page *page) {
+	return (struct shm_page *) ((uint8_t *) page
+			- offsetof (struct shm_page, page));
+}
+
+static struct list segment_list;
+static struct lock shm_lock;
+static int next_id;
+
+/* Statistics. */
+static long long create_cnt;            /* Segments created. */
+static long long attach_cnt;            /* Pages attached. */
+static long long swap_out_cnt;          /* Frames evicted. */
+static long long swap_in_cnt;           /* ...and read back by a fault. */
+
+/* Initializes shared memory segments. */
+void
+shm_init (void) {
+	list_init (&segment_list);
+	lock_init (&shm_lock);
+	next_id = 1;
+}
+
+/* Returns the segment with ID, or a null pointer.  shm_lock must be
+ * held. */
+static struct shm_segment *
+shm_find (int id) {
+	struct list_elem *e;
+
+	for (e = list_begin (&segment_list); e != list_end (&segment_list);
+			e = list_next (e)) {
+		struct shm_segment *seg = list_entry (e, struct shm_segment, elem);
+		if (seg->id == id)
+			return seg;
+	}
+	return NULL;
+}
+
+/* Creates a segment of SIZE bytes, rounded up to whole pages, all
+ * zeros, held by the current process until it exits.  Returns its
+ * id, or -1 if SIZE is 0 or too big or memory is short. */
+int
+shm_new (size_t size) {
+	size_t page_cnt = DIV_ROUND_UP (size, PGSIZE);
+	struct shm_segment *seg;
+	int id;
+
+	if (page_cnt == 0 || page_cnt > SHM_MAX_PAGES)
+		return -1;
+	seg = malloc (sizeof *seg);
+	if (seg == NULL)
+		return -1;
+	seg->pages = calloc (page_cnt, sizeof *seg->pages);
+	if (seg->pages == NULL) {
+		free (seg);
+		return -1;
+	}
+	seg->page_cnt = page_cnt;
+	seg->creator = thread_current ();
+	seg->ref_cnt = 1;
+	for (size_t i = 0; i < page_cnt; i++) {
+		struct shm_page *sp = &seg->pages[i];
+
+		sp->page.operations = &shm_ops;
+		sp->page.writable = true;
+		sp->page.anon.slot_number = -1;
+		list_init (&sp->maps);
+		sp->seg = seg;
+	}
+
+	lock_acquire (&shm_lock);
+	id = seg->id = next_id++;
+	list_push_back (&segment_list, &seg->elem);
+	create_cnt++;
+	lock_release (&shm_lock);
+	return id;
+}
+
+/* Frees SEG, which no one holds any more, with its frames and
+ * saved copies. */
+static void
+shm_free (struct shm_segment *seg) {
+	for (size_t i = 0; i < seg->page_cnt; i++) {
+		struct page *page = &seg->pages[i].page;
+
+		/* 쫓겨나는 중이면 끝날 때까지 기다린 뒤 프레임이 남았는지 본다 */
+		vm_frame_pin (page);
+		if (page->frame != NULL) {
+			palloc_free_page (page->frame->kva);
+			free (page->frame);
+			page->frame = NULL;
+		} else
+			anon_swap_drop (page);
+	}
+	free (seg->pages);
+	free (seg);
+}
+
+/* Drops a reference to SEG, with shm_lock held.  Returns true if
+ * that was the last one, in which case SEG is off the segment list
+ * and the caller must free it with shm_free() after releasing
+ * shm_lock. */
+static bool
+shm_unref (struct shm_segment *seg) {
+	ASSERT (lock_held_by_current_thread (&shm_lock));
+	ASSERT (seg->ref_cnt > 0);
+	if (--seg->ref_cnt > 0)
+		return false;
+	list_remove (&seg->elem);
+	return true;
+}
+
+/* Attaches the current process's page at VA to SP, taking a
+ * reference to SP's segment.  Returns false if VA is taken or
+ * memory is short. */
+static bool
+shm_map_page (struct shm_page *sp, void *va) {
+	struct thread *t = thread_current ();
+	struct shm_map *map;
+	struct page *page;
+
+	map = malloc (sizeof *map);
+	if (map == NULL)
+		return false;
+	if (!vm_alloc_page (VM_ANON | VM_MARKER_0, va, true)) {
+		free (map);
+		return false;
+	}
+	/* 읽어 올 내용이 없으니 프레임 없이 anon 페이지로 바꾼다 */
+	page = spt_find_page (&t->spt, va);
+	swap_in (page, NULL);
+	map->sp = sp;
+	map->page = page;
+	map->owner = t;
+	map->mapped = false;
+	page->shm = map;
+
+	lock_acquire (&shm_lock);
+	list_push_back (&sp->maps, &map->elem);
+	sp->seg->ref_cnt++;
+	attach_cnt++;
+	lock_release (&shm_lock);
+	return true;
+}
+
+/* Attaches segment ID to the current process at ADDR, which must
+ * be page-aligned, with every page of the range unused.  Returns
+ * ADDR, or a null pointer on failure. */
+void *
+shm_map_at (int id, void *addr) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct shm_segment *seg;
+	size_t i = 0;
+	bool last;
+
+	if (addr == NULL || pg_ofs (addr) != 0 || !is_user_vaddr (addr))
+		return NULL;
+
+	/* 붙이는 동안 세그먼트가 사라지지 않도록 참조를 잡아 둔다 */
+	lock_acquire (&shm_lock);
+	seg = shm_find (id);
+	if (seg != NULL)
+		seg->ref_cnt++;
+	lock_release (&shm_lock);
+	if (seg == NULL)
+		return NULL;
+
+	if ((uint64_t) addr + seg->page_cnt * PGSIZE <= KERN_BASE)
+		for (; i < seg->page_cnt; i++)
+			if (!shm_map_page (&seg->pages[i], addr + i * PGSIZE))
+				break;
+	if (i < seg->page_cnt) {
+		/* 이미 붙인 페이지만 떼어 낸다 */
+		spt_remove_range (spt, addr, addr + i * PGSIZE);
+		addr = NULL;
+	}
+
+	lock_acquire (&shm_lock);
+	last = shm_unref (seg);
+	lock_release (&shm_lock);
+	if (last)
+		shm_free (seg);
+	return addr;
+}
+
+/* Detaches the segment attached at ADDR from the current process.
+ * Returns false if no segment is attached there. */
+bool
+shm_unmap_at (void *addr) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct page *page = spt_find_page (spt, addr);
+	struct shm_segment *seg;
+
+	if (page == NULL || page->shm == NULL || page->va != addr)
+		return false;
+	seg = page->shm->sp->seg;
+	if (page->shm->sp != &seg->pages[0])
+		return false;
+	/* 붙인 뒤로 뒤쪽 페이지가 그대로 남아 있는지 확인한다 */
+	for (size_t i = 1; i < seg->page_cnt; i++) {
+		page = spt_find_page (spt, addr + i * PGSIZE);
+		if (page == NULL || page->shm == NULL
+				|| page->shm->sp != &seg->pages[i])
+			return false;
+	}
+	spt_remove_range (spt, addr, addr + seg->page_cnt * PGSIZE);
+	return true;
+}
+
+/* Attaches the current process, a child being forked, at the same
+ * address to the segment page that SRC, its parent's page, is
+ * attached to. */
+bool
+shm_copy (struct page *src) {
+	return shm_map_page (src->shm->sp, src->va);
+}
+
+/* Maps SP's frame at MAP's page in the current process.  shm_lock
+ * must be held. */
+static bool
+shm_install (struct shm_map *map) {
+	struct thread *t = thread_current ();
+	struct page *page = map->page;
+
+	if (!pml4_set_page (t->pml4, page->va, map->sp->page.frame->kva,
+				page->writable))
+		return false;
+	map->mapped = true;
+	return true;
+}
+
+/* Handles a fault on PAGE, an attached page of the current process
+ * with no PTE.  Maps the segment page's frame, first loading it
+ * into a new frame if it has none.  Stores in *IO whether it was
+ * read from disk. */
+bool
+shm_fault (struct page *page, bool *io) {
+	struct shm_map *map = page->shm;
+	struct shm_page *sp = map->sp;
+	struct frame *frame;
+	bool ok;
+
+	*io = false;
+	lock_acquire (&shm_lock);
+	if (sp->page.frame != NULL) {
+		ok = shm_install (map);
+		lock_release (&shm_lock);
+		return ok;
+	}
+	lock_release (&shm_lock);
+
+	/* 프레임을 얻다가 쫓아내기를 할 수 있으므로 락을 놓고 얻는다 */
+	frame = vm_get_frame (false);
+	lock_acquire (&shm_lock);
+	if (sp->page.frame != NULL) {
+		/* 그 사이 다른 프로세스가 읽어 들였다 */
+		palloc_free_page (frame->kva);
+		free (frame);
+		ok = shm_install (map);
+		lock_release (&shm_lock);
+		return ok;
+	}
+	if (sp->page.anon.zswap != NULL || sp->page.anon.slot_number != -1)
+		swap_in_cnt++;
+	*io = swap_in (&sp->page, frame->kva);
+	frame->page = &sp->page;
+	frame->owner = NULL;
+	sp->page.frame = frame;
+	ok = shm_install (map);
+	lock_release (&shm_lock);
+
+	/* 이 프로세스가 붙어 있는 동안 세그먼트는 남아 있다 */
+	vm_frame_register (frame);
+	return ok;
+}
+
+/* Reads back what shm_swap_out() saved of PAGE into KVA, or zeroes
+ * KVA on the first load.  Returns true if it read the disk. */
+static bool
+shm_swap_in (struct page *page, void *kva) {
+	return anon_swap_restore (page, kva);
+}
+
+/* Evicts PAGE, a segment page, from its frame: unmaps it from every
+ * process and saves its contents.  Called by vm_evict_frame(),
+ * with the frame off the frame table. */
+static bool
+shm_swap_out (struct page *page) {
+	struct shm_page *sp = shm_page_of (page);
+	struct frame *frame = page->frame;
+	struct list_elem *e;
+	bool saved;
+
+	lock_acquire (&shm_lock);
+	/* 매핑을 모두 지워 저장하는 동안 내용이 바뀌지 않게 한다 */
+	for (e = list_begin (&sp->maps); e != list_end (&sp->maps);
+			e = list_next (e)) {
+		struct shm_map *map = list_entry (e, struct shm_map, elem);
+		if (map->mapped)
+			pml4_clear_page (map->owner->pml4, map->page->va);
+	}
+	saved = anon_swap_save (page, frame->kva);
+	for (e = list_begin (&sp->maps); e != list_end (&sp->maps);
+			e = list_next (e)) {
+		struct shm_map *map = list_entry (e, struct shm_map, elem);
+		if (!map->mapped)
+			continue;
+		if (saved)
+			map->mapped = false;
+		else
+			/* 자리가 없으니 되돌린다. 페이지 테이블은 남아 있다 */
+			pml4_set_page (map->owner->pml4, map->page->va, frame->kva,
+					map->page->writable);
+	}
+	if (saved) {
+		page->frame = NULL;
+		swap_out_cnt++;
+	}
+	lock_release (&shm_lock);
+	return saved;
+}
+
+/* Returns true if any process accessed PAGE, a segment page, since
+ * the last call, clearing the accessed bits.  Called with the frame
+ * table locked. */
+bool
+shm_test_accessed (struct page *page) {
+	struct shm_page *sp = shm_page_of (page);
+	struct list_elem *e;
+	bool accessed = false;
+
+	lock_acquire (&shm_lock);
+	for (e = list_begin (&sp->maps); e != list_end (&sp->maps);
+			e = list_next (e)) {
+		struct shm_map *map = list_entry (e, struct shm_map, elem);
+		uint64_t *pml4 = map->owner->pml4;
+
+		if (map->mapped && pml4_is_accessed (pml4, map->page->va)) {
+			pml4_set_accessed (pml4, map->page->va, false);
+			accessed = true;
+		}
+	}
+	lock_release (&shm_lock);
+	return accessed;
+}
+
+/* Detaches PAGE, an attached page of the current process that is
+ * going away, and drops its reference to the segment.  Unmaps it
+ * first, since the frame is not the process's to free. */
+void
+shm_release (struct page *page) {
+	struct thread *t = thread_current ();
+	struct shm_map *map = page->shm;
+	struct shm_segment *seg = map->sp->seg;
+	bool last;
+
+	lock_acquire (&shm_lock);
+	if (map->mapped && t->pml4 != NULL)
+		pml4_clear_page (t->pml4, page->va);
+	list_remove (&map->elem);
+	last = shm_unref (seg);
+	lock_release (&shm_lock);
+
+	free (map);
+	page->shm = NULL;
+	if (last)
+		shm_free (seg);
+}
+
+/* Drops the references of the current process, which is exiting
+ * or replacing its image, to the segments it created.  Its attached
+ * pages went with its spt. */
+void
+shm_exit (void) {
+	struct thread *t = thread_current ();
+	struct list dead;
+	struct list_elem *e, *next;
+
+	list_init (&dead);
+	lock_acquire (&shm_lock);
+	for (e = list_begin (&segment_list); e != list_end (&segment_list);
+			e = next) {
+		struct shm_segment *seg = list_entry (e, struct shm_segment, elem);
+
+		next = list_next (e);
+		if (seg->creator != t)
+			continue;
+		seg->creator = NULL;
+		if (shm_unref (seg))
+			list_push_back (&dead, &seg->elem);
+	}
+	lock_release (&shm_lock);
+
+	while (!list_empty (&dead))
+		shm_free (list_entry (list_pop_front (&dead), struct shm_segment,
+					elem));
+}
+
+/* Prints shared memory statistics. */
+void
+shm_print_stats (void) {
+	printf ("Shm: %lld segments created, %lld pages attached, "
+			"%lld frames evicted, %lld read back\n",
+			create_cnt, attach_cnt, swap_out_cnt, swap_in_cnt);
+}
@@ -3,3 +3,10 @@ vm_SRC += vm/uninit.c     # Uninitialized page
 vm_SRC += vm/anon.c       # Anonymous page
 vm_SRC += vm/file.c       # File mapped page
 vm_SRC += vm/inspect.c    # Testing utility
+vm_SRC += vm/text.c       # Shared executable text
+vm_SRC += vm/madvise.c    # Access hints
+vm_SRC += vm/ksm.c        # Same-page merging
+vm_SRC += vm/zswap.c      # Compressed swap cache
+vm_SRC += vm/kswapd.c     # Background reclaim
+vm_SRC += vm/ioring.c     # Asynchronous I/O rings
+vm_SRC += vm/shm.c        # Shared memory segments
@@ -0,0 +1,622 @@
+/* text.c: Frames shared between processes running the same executable.
+ *
+ * Read-only pages loaded from an executable are the same in every
+ * process that runs it, so they are kept here, keyed on the inode
+ * and offset each page comes from.  Every process's page for the
+ * same one is attached to the one text frame, and its faults map
+ * the frame that text frame is loaded in instead of reading the
+ * file again.  A text frame is freed when the last page attached
+ * to it lets go.
+ *
+ * Pages of mmap'd files are shared the same way, under a separate
+ * key so that a mapping never aliases an executable's text.  They
+ * may be written, so such a text frame also remembers whether any
+ * mapper dirtied it, and is written back when it is evicted, on
+ * msync() and when the last mapper lets go.
+ *
+ * The frames are on the frame table with no owner, like those of
+ * shared memory segments.  Evicting one unmaps it from every
+ * process that has it mapped and writes it back if it is dirty;
+ * the next fault in any of them reads it from the file again.
+ *
+ * A text frame read in ahead of any fault, by madvise
+ * (MADV_WILLNEED), is parked: the table itself holds its reference
+ * until a fault looks it up and adopts it.  At most TEXT_PARK_MAX
+ * text frames are parked; past that the oldest one is let go.
+ *
+ * text_lock protects the table and every text frame.  The frame
+ * table lock is taken first when both are needed, so no function
+ * here takes the frame table lock while holding text_lock.  A text
+ * frame is read from its file without text_lock, marked as loading
+ * meanwhile; other faults on it wait on text_cond until it is in.
+ * Fault-around never waits: it would hold text frames of its own
+ * as loading while it did, so it leaves such a page alone. */
+
+#include "vm/text.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/vm.h"
+
+#define TEXT_PARK_MAX 64
+
+struct text_frame {
+	struct hash_elem elem;      /* Element in text_table. */
+	struct inode *inode;        /* File the page is read from. */
+	off_t offset;               /* Offset of the page in the file. */
+	bool mapping;               /* Page of an mmap'd file? */
+	size_t read_bytes;          /* Bytes read; the rest is zeroed. */
+	struct page page;           /* Holds the frame while loaded. */
+	struct list maps;           /* Attached pages, as struct text_map. */
+	int ref_cnt;                /* Attached pages, plus one if parked. */
+	bool dirty;                 /* Written by a mapper since written back. */
+	bool parked;                /* One reference held by park_list? */
+	bool loading;               /* Being read in without text_lock? */
+	struct list_elem park_elem; /* Element in park_list. */
+};
+
+struct text_map {
+	struct list_elem elem;      /* Element in the text frame's maps. */
+	struct text_frame *text;    /* Text frame attached to. */
+	struct page *page;          /* Attached page. */
+	struct thread *owner;       /* Process whose page it is. */
+	bool mapped;                /* Has a PTE for the frame? */
+};
+
+static bool text_swap_in (struct page *page, void *kva);
+static bool text_swap_out (struct page *page);
+
+/* Operations of the pages that hold the text frames' frames.  They
+ * are in no spt; vm_evict_frame() reaches them through the frame
+ * table. */
+static const struct page_operations text_ops = {
+	.swap_in = text_swap_in,
+	.swap_out = text_swap_out,
+	.destroy = NULL,
+	.type = VM_FILE,
+};
+
+/* Returns the text frame whose frame-holding page is PAGE. */
+static struct text_frame *
+text_of (struct page *page) {
+	return (struct text_frame *) ((uint8_t *) page
+			- offsetof (struct text_frame, page));
+}
+
+static struct hash text_table;
+static struct lock text_lock;
+static struct condition text_cond; /* Signaled when a load ends. */
+static struct list park_list;   /* Parked text frames, oldest first. */
+static size_t park_cnt;         /* Number of parked text frames. */
+
+/* Statistics. */
+static long long text_hits;     /* Faults served from a loaded frame. */
+static long long text_loads;    /* Frames read from their files. */
+static long long text_evicts;   /* Frames evicted. */
+static long long text_parks;    /* Text frames parked. */
+static long long text_adopts;   /* ...and adopted by a fault. */
+
+static uint64_t
+text_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct text_frame *t = hash_entry (e, struct text_frame, elem);
+	return hash_bytes (&t->inode, sizeof t->inode)
+		^ hash_int ((int) t->offset) ^ t->mapping;
+}
+
+static bool
+text_less (const struct hash_elem *a_, const struct hash_elem *b_,
+		void *aux UNUSED) {
+	const struct text_frame *a = hash_entry (a_, struct text_frame, elem);
+	const struct text_frame *b = hash_entry (b_, struct text_frame, elem);
+
+	if (a->inode != b->inode)
+		return a->inode < b->inode;
+	if (a->offset != b->offset)
+		return a->offset < b->offset;
+	return a->mapping < b->mapping;
+}
+
+/* Initializes the shared text table. */
+void
+text_init (void) {
+	hash_init (&text_table, text_hash, text_less, NULL);
+	lock_init (&text_lock);
+	cond_init (&text_cond);
+	list_init (&park_list);
+}
+
+/* Returns the text frame for the page at KEY, with a reference
+ * taken for the caller, creating it with no frame if there is none.
+ * Returns a null pointer if memory is short, or if the page is
+ * there with a different split between file data and zeros, which
+ * means different contents. */
+struct text_frame *
+text_get (const struct text_key *key) {
+	struct text_frame probe = {
+		.inode = key->inode, .offset = key->offset, .mapping = key->mapping
+	};
+	struct text_frame *text;
+	struct hash_elem *e;
+
+	lock_acquire (&text_lock);
+	e = hash_find (&text_table, &probe.elem);
+	if (e != NULL) {
+		text = hash_entry (e, struct text_frame, elem);
+		if (text->read_bytes != key->read_bytes)
+			text = NULL;
+		else if (text->parked) {
+			/* A parked text frame's reference passes to the caller. */
+			list_remove (&text->park_elem);
+			park_cnt--;
+			text->parked = false;
+			text_adopts++;
+		} else
+			text->ref_cnt++;
+		lock_release (&text_lock);
+		return text;
+	}
+
+	text = calloc (1, sizeof *text);
+	if (text != NULL) {
+		/* Keep the inode, and so its identity, for as long as the
+		 * text frame is in the table. */
+		text->inode = inode_reopen (key->inode);
+		text->offset = key->offset;
+		text->mapping = key->mapping;
+		text->read_bytes = key->read_bytes;
+		text->page.operations = &text_ops;
+		text->page.writable = key->mapping;
+		list_init (&text->maps);
+		text->ref_cnt = 1;
+		hash_insert (&text_table, &text->elem);
+	}
+	lock_release (&text_lock);
+	return text;
+}
+
+/* Drops a reference to TEXT, with text_lock held.  Returns true
+ * if that was the last one, in which case TEXT is out of the table
+ * and the caller must free it with text_free() after releasing
+ * text_lock. */
+static bool
+text_unref (struct text_frame *text) {
+	ASSERT (lock_held_by_current_thread (&text_lock));
+	ASSERT (text->ref_cnt > 0);
+	if (--text->ref_cnt > 0)
+		return false;
+	hash_delete (&text_table, &text->elem);
+	return true;
+}
+
+/* Frees TEXT, which text_unref() took out of the table, writing
+ * its frame back first if it is dirty. */
+static void
+text_free (struct text_frame *text) {
+	struct frame *frame;
+
+	/* 쫓겨나는 중이면 끝날 때까지 기다린 뒤 프레임이 남았는지 본다 */
+	vm_frame_pin (&text->page);
+	frame = text->page.frame;
+	if (frame != NULL) {
+		if (text->dirty)
+			inode_write_at (text->inode, frame->kva, text->read_bytes,
+					text->offset);
+		palloc_free_page (frame->kva);
+		free (frame);
+	}
+	inode_close (text->inode);
+	free (text);
+}
+
+/* Drops the caller's reference to TEXT, freeing it if that was the
+ * last one. */
+static void
+text_put (struct text_frame *text) {
+	bool last;
+
+	lock_acquire (&text_lock);
+	last = text_unref (text);
+	lock_release (&text_lock);
+	if (last)
+		text_free (text);
+}
+
+/* Attaches PAGE, a page of the current process, to TEXT, handing
+ * over the caller's reference to TEXT.  PAGE is mapped by
+ * text_fault().  Returns false, dropping the reference, if memory
+ * is short. */
+bool
+text_attach (struct page *page, struct text_frame *text) {
+	struct text_map *map = malloc (sizeof *map);
+
+	if (map == NULL) {
+		text_put (text);
+		return false;
+	}
+	map->text = text;
+	map->page = page;
+	map->owner = thread_current ();
+	map->mapped = false;
+	page->text = map;
+
+	lock_acquire (&text_lock);
+	list_push_back (&text->maps, &map->elem);
+	lock_release (&text_lock);
+	return true;
+}
+
+/* Attaches DST, a page of the current process, a child being
+ * forked, to the text frame that SRC, its parent's page, is
+ * attached to. */
+bool
+text_copy (struct page *dst, struct page *src) {
+	struct text_frame *text = src->text->text;
+
+	lock_acquire (&text_lock);
+	ASSERT (text->ref_cnt > 0);
+	text->ref_cnt++;
+	lock_release (&text_lock);
+	return text_attach (dst, text);
+}
+
+/* Reads the page of PAGE, a text frame's page, from its file into
+ * KVA. */
+static bool
+text_swap_in (struct page *page, void *kva) {
+	struct text_frame *text = text_of (page);
+
+	if (inode_read_at (text->inode, kva, text->read_bytes, text->offset)
+			!= (off_t) text->read_bytes)
+		return false;
+	memset (kva + text->read_bytes, 0, PGSIZE - text->read_bytes);
+	return true;
+}
+
+/* Returns a new frame from the user pool, or a null pointer if the
+ * pool is empty or memory is short, without evicting anything. */
+static struct frame *
+text_frame_ahead (void) {
+	void *kva = palloc_get_page (PAL_USER);
+	struct frame *frame;
+
+	if (kva == NULL)
+		return NULL;
+	frame = calloc (1, sizeof *frame);
+	if (frame == NULL) {
+		palloc_free_page (kva);
+		return NULL;
+	}
+	frame->kva = kva;
+	return frame;
+}
+
+/* Makes FRAME, into which TEXT has been read, TEXT's frame.
+ * text_lock must be held. */
+static void
+text_loaded (struct text_frame *text, struct frame *frame) {
+	frame->page = &text->page;
+	frame->owner = NULL;
+	text->page.frame = frame;
+	text_loads++;
+}
+
+/* Loads TEXT into a frame, unless it has one already, waiting if
+ * another process is loading it.  If AHEAD, gives up instead of
+ * evicting when the user pool is empty, and instead of waiting.
+ * Returns with text_lock held, and true if TEXT has a frame.
+ * Stores in *LOADED the frame it loaded, if it did, which the
+ * caller must put on the frame table after releasing text_lock. */
+static bool
+text_load (struct text_frame *text, bool ahead, struct frame **loaded) {
+	struct frame *frame;
+	bool ok;
+
+	*loaded = NULL;
+	lock_acquire (&text_lock);
+	while (text->loading) {
+		if (ahead)
+			return false;
+		cond_wait (&text_cond, &text_lock);
+	}
+	if (text->page.frame != NULL)
+		return true;
+	text->loading = true;
+	lock_release (&text_lock);
+
+	/* 프레임을 얻다가 쫓아내기를 할 수 있고 읽기는 디스크를 기다리므로
+	 * 락을 놓고 한다. 같은 페이지의 다른 폴트는 위에서 기다린다 */
+	frame = ahead ? text_frame_ahead () : vm_get_frame (false);
+	ok = frame != NULL && swap_in (&text->page, frame->kva);
+
+	lock_acquire (&text_lock);
+	text->loading = false;
+	cond_broadcast (&text_cond, &text_lock);
+	if (!ok) {
+		if (frame != NULL) {
+			palloc_free_page (frame->kva);
+			free (frame);
+		}
+		return false;
+	}
+	text_loaded (text, frame);
+	*loaded = frame;
+	return true;
+}
+
+/* Maps MAP's text frame's frame at its page.  text_lock must be
+ * held. */
+static bool
+text_install (struct text_map *map) {
+	struct page *page = map->page;
+
+	if (!pml4_set_page (map->owner->pml4, page->va,
+				map->text->page.frame->kva, page->writable))
+		return false;
+	map->mapped = true;
+	vm_account (map->owner, 1, 0, map->text->mapping ? 1 : 0);
+	return true;
+}
+
+/* Unmaps MAP's page, noting in its text frame whether the page was
+ * written.  text_lock must be held. */
+static void
+text_unmap (struct text_map *map) {
+	uint64_t *pml4 = map->owner->pml4;
+	void *va = map->page->va;
+
+	if (pml4 != NULL) {
+		if (pml4_is_dirty (pml4, va))
+			map->text->dirty = true;
+		pml4_clear_page (pml4, va);
+	}
+	map->mapped = false;
+	vm_account (map->owner, -1, 0, map->text->mapping ? -1 : 0);
+}
+
+/* Writes TEXT's frame back to its file if a mapper dirtied it.
+ * text_lock must be held. */
+static void
+text_flush (struct text_frame *text) {
+	if (!text->dirty || text->page.frame == NULL)
+		return;
+	text->dirty = false;
+	inode_write_at (text->inode, text->page.frame->kva, text->read_bytes,
+			text->offset);
+}
+
+/* Handles a fault on PAGE, a page of the current process attached
+ * to a text frame, with no PTE.  Maps the text frame's frame, first
+ * loading it if it has none.  If AHEAD, PAGE is claimed by
+ * fault-around and is left unmapped when the user pool is empty or
+ * another process is loading the text frame.
+ * Stores in *IO whether the file was read. */
+bool
+text_fault (struct page *page, bool ahead, bool *io) {
+	struct text_map *map = page->text;
+	struct frame *loaded;
+	bool ok;
+
+	ok = text_load (map->text, ahead, &loaded) && text_install (map);
+	if (ok && loaded == NULL)
+		text_hits++;
+	lock_release (&text_lock);
+
+	/* 이 페이지가 붙어 있는 동안 text frame은 남아 있다 */
+	if (loaded != NULL)
+		vm_frame_register (loaded);
+	*io = loaded != NULL && map->text->read_bytes > 0;
+	return ok;
+}
+
+/* Starts loading the text frame PAGE, a page of the current
+ * process, is attached to, for fault-around to read along with its
+ * neighbours: if the text frame has no frame and no process is
+ * loading it, marks it as loading and returns a new frame from the
+ * user pool for the caller to read the page's bytes into, then pass
+ * to text_load_end().  Otherwise, or if the user pool is empty,
+ * returns a null pointer, and text_fault() is what maps PAGE. */
+struct frame *
+text_load_begin (struct page *page) {
+	struct text_frame *text = page->text->text;
+	struct frame *frame = NULL;
+
+	lock_acquire (&text_lock);
+	if (text->page.frame == NULL && !text->loading) {
+		frame = text_frame_ahead ();
+		text->loading = frame != NULL;
+	}
+	lock_release (&text_lock);
+	return frame;
+}
+
+/* Ends the load text_load_begin() started for PAGE.  If OK, FRAME
+ * holds the page's bytes from the file: zeroes the rest of it,
+ * makes it the text frame's frame and maps it at PAGE.  Otherwise
+ * frees FRAME.  Returns true if PAGE was mapped. */
+bool
+text_load_end (struct page *page, struct frame *frame, bool ok) {
+	struct text_map *map = page->text;
+	struct text_frame *text = map->text;
+	bool loaded = ok;
+
+	lock_acquire (&text_lock);
+	text->loading = false;
+	cond_broadcast (&text_cond, &text_lock);
+	if (loaded) {
+		memset (frame->kva + text->read_bytes, 0, PGSIZE - text->read_bytes);
+		text_loaded (text, frame);
+		ok = text_install (map);
+	}
+	lock_release (&text_lock);
+
+	if (loaded)
+		vm_frame_register (frame);
+	else {
+		palloc_free_page (frame->kva);
+		free (frame);
+	}
+	return ok;
+}
+
+/* Loads TEXT, to which the caller holds a reference, into a frame
+ * if it has none and the user pool has one free.  Returns true if
+ * it read the file. */
+bool
+text_prefetch (struct text_frame *text) {
+	struct frame *loaded;
+
+	text_load (text, true, &loaded);
+	lock_release (&text_lock);
+	if (loaded != NULL)
+		vm_frame_register (loaded);
+	return loaded != NULL;
+}
+
+/* Evicts PAGE, a text frame's page, from its frame: unmaps it from
+ * every process and writes it back if any of them dirtied it.
+ * Called by vm_evict_frame(), with the frame off the frame table. */
+static bool
+text_swap_out (struct page *page) {
+	struct text_frame *text = text_of (page);
+	struct list_elem *e;
+
+	lock_acquire (&text_lock);
+	/* 매핑을 모두 지워 쓰는 동안 내용이 바뀌지 않게 한다 */
+	for (e = list_begin (&text->maps); e != list_end (&text->maps);
+			e = list_next (e)) {
+		struct text_map *map = list_entry (e, struct text_map, elem);
+		if (map->mapped)
+			text_unmap (map);
+	}
+	text_flush (text);
+	page->frame = NULL;
+	text_evicts++;
+	lock_release (&text_lock);
+	return true;
+}
+
+/* Returns true if any process accessed PAGE, a text frame's page,
+ * since the last call, clearing the accessed bits.  Called with the
+ * frame table locked. */
+bool
+text_test_accessed (struct page *page) {
+	struct text_frame *text = text_of (page);
+	struct list_elem *e;
+	bool accessed = false;
+
+	lock_acquire (&text_lock);
+	for (e = list_begin (&text->maps); e != list_end (&text->maps);
+			e = list_next (e)) {
+		struct text_map *map = list_entry (e, struct text_map, elem);
+		uint64_t *pml4 = map->owner->pml4;
+
+		if (map->mapped && pml4_is_accessed (pml4, map->page->va)) {
+			pml4_set_accessed (pml4, map->page->va, false);
+			accessed = true;
+		}
+	}
+	lock_release (&text_lock);
+	return accessed;
+}
+
+/* Writes the text frame PAGE is attached to back to its file if
+ * any mapper dirtied it, leaving it mapped, for msync(). */
+void
+text_writeback (struct page *page) {
+	struct text_frame *text = page->text->text;
+	struct list_elem *e;
+
+	lock_acquire (&text_lock);
+	for (e = list_begin (&text->maps); e != list_end (&text->maps);
+			e = list_next (e)) {
+		struct text_map *map = list_entry (e, struct text_map, elem);
+		uint64_t *pml4 = map->owner->pml4;
+
+		if (map->mapped && pml4_is_dirty (pml4, map->page->va)) {
+			pml4_set_dirty (pml4, map->page->va, false);
+			text->dirty = true;
+		}
+	}
+	text_flush (text);
+	lock_release (&text_lock);
+}
+
+/* Detaches PAGE, a page of the current process that is going away
+ * or dropping its frame, from its text frame and drops its
+ * reference.  Unmaps it first, since the frame is not the process's
+ * to free.  Frees the text frame when that was the last reference,
+ * writing it back first if it is dirty. */
+void
+text_release (struct page *page) {
+	struct text_map *map = page->text;
+	struct text_frame *text = map->text;
+	bool last;
+
+	lock_acquire (&text_lock);
+	if (map->mapped)
+		text_unmap (map);
+	list_remove (&map->elem);
+	last = text_unref (text);
+	lock_release (&text_lock);
+
+	free (map);
+	page->text = NULL;
+	if (last)
+		text_free (text);
+}
+
+/* Hands the caller's reference to TEXT over to the table, keeping
+ * it for the next fault on its page.  If TEXT is parked already,
+ * the caller's reference is dropped instead.  May let go of the
+ * oldest parked text frame. */
+void
+text_park (struct text_frame *text) {
+	struct text_frame *victim = NULL;
+
+	lock_acquire (&text_lock);
+	if (text->parked) {
+		/* 이미 맡겨 둔 프레임이면 맨 뒤로 옮기기만 한다 */
+		list_remove (&text->park_elem);
+		list_push_back (&park_list, &text->park_elem);
+		if (!text_unref (text))
+			text = NULL;
+	} else {
+		text->parked = true;
+		list_push_back (&park_list, &text->park_elem);
+		text_parks++;
+		text = NULL;
+		if (++park_cnt > TEXT_PARK_MAX) {
+			victim = list_entry (list_pop_front (&park_list),
+					struct text_frame, park_elem);
+			victim->parked = false;
+			park_cnt--;
+			if (!text_unref (victim))
+				victim = NULL;
+		}
+	}
+	lock_release (&text_lock);
+
+	if (text != NULL)
+		text_free (text);
+	if (victim != NULL)
+		text_free (victim);
+}
+
+/* Prints shared text statistics. */
+void
+text_print_stats (void) {
+	printf ("Text: %lld frames loaded, %lld faults served from them, "
+			"%lld evicted\n", text_loads, text_hits, text_evicts);
+	printf ("Text: %lld frames read ahead, %lld adopted by a fault\n",
+			text_parks, text_adopts);
+}
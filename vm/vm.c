@@ -3,12 +3,86 @@
 #include "threads/malloc.h"
 #include "vm/vm.h"
 #include "vm/inspect.h"
+#include "vm/ksm.h"
+#include "vm/ioring.h"
+#include "vm/kswapd.h"
+#include "vm/madvise.h"
+#include "vm/shm.h"
+#include "vm/text.h"
 #include "include/threads/vaddr.h"
 #include "include/threads/mmu.h"
+#include "threads/interrupt.h"
+#include "filesys/inode.h"
 #include "userprog/process.h"
+#include <faultstat.h>
+#include <intrinsic.h>
+#include <rusage.h>
+#include <stdio.h>
 #include <string.h>
 
-// struct list frame_table;
+/* Fault-around.  When a page that is still to be loaded from a
+ * file faults, up to ra_window following pages backed by the
+ * following part of the same file are claimed as well, so that a
+ * sequential walk takes one fault per window instead of one per
+ * page.  The window doubles while faults land right past the
+ * previous window and halves when they do not.  Under
+ * MADV_SEQUENTIAL the window is always the widest, and the pages
+ * of mmap'd files more than a window behind a fault are dropped;
+ * under MADV_RANDOM there is no fault-around.  The pages of a
+ * window that are read from the file are read together, with one
+ * disk command per run of consecutive sectors.  FAULT_AROUND_MAX
+ * pages are DISK_READ_MAX sectors, as many as one command reads. */
+#define FAULT_AROUND_INIT 4
+#define FAULT_AROUND_MAX 32
+
+static long long fault_around_cnt;      /* Faults that mapped ahead. */
+static long long mapped_ahead_cnt;      /* Pages mapped ahead. */
+static long long mapped_ahead_used;     /* ...and touched before freed. */
+static long long reclaim_behind_cnt;    /* Frames dropped behind a walk. */
+
+/* The zero page.  A read fault on an anonymous page that would
+ * start out zeroed maps this frame read-only instead of a frame
+ * of its own; the first write to the page gives it one. */
+static void *zero_kva;
+
+static long long zero_map_cnt;          /* Read faults on the zero page. */
+static long long zero_promote_cnt;      /* ...later written. */
+
+/* Frame table.  Each frame that holds a page of a single process
+ * is on frame_table, in the order the clock hand sweeps them, from
+ * when the page is loaded until it is evicted or freed.  Frames
+ * shared through vm/text.c or by shared memory segments are on it
+ * with no owner; see vm/text.c and vm/shm.c.  frame_lock protects
+ * the table and, for frames on it, the link between frame and page.
+ * A frame being evicted, or written back by kswapd, is off the table
+ * and its page is marked busy while the I/O runs without frame_lock;
+ * vm_frame_pin() waits on frame_cond until that is over.
+ *
+ * The hand clears the accessed bits it passes, so the pages whose
+ * bits it finds set during one revolution are the working set of
+ * their process over that revolution. */
+static struct list frame_table;
+static struct lock frame_lock;
+static struct condition frame_cond;     /* Signaled when I/O ends. */
+static struct list_elem *clock_hand;
+static unsigned clock_epoch;            /* Revolutions the hand began. */
+static struct list_elem *scan_hand;     /* Next frame for vm_frame_scan(). */
+
+/* Page faults of every process since boot; see fault_record(). */
+static struct faultstat fault_stats;
+static const char *fault_names[FAULT_TYPE_CNT] = {
+	"lazy", "zero", "stack", "swap", "file", "cow", "shm", "invalid",
+};
+
+static long long evict_cnt;             /* Frames evicted. */
+static long long direct_evict_cnt;      /* ...by the faulting process. */
+
+/* Usage of the processes that have exited, for the shutdown
+ * report. */
+static int exit_cnt;
+static long long exit_minflt, exit_majflt;
+static long peak_rss;
+static char peak_name[16];
 
 /* Initializes the virtual memory subsystem by invoking each subsystem's
  * intialize codes. */
@@ -22,7 +96,18 @@ vm_init (void) {
 	register_inspect_intr ();
 	/* DO NOT MODIFY UPPER LINES. */
 	/* TODO: Your code goes here. */
-	// list_init(&frame_table);
+	list_init (&frame_table);
+	lock_init (&frame_lock);
+	cond_init (&frame_cond);
+	clock_hand = list_end (&frame_table);
+	scan_hand = list_end (&frame_table);
+	text_init ();
+	madvise_init ();
+	ksm_init ();
+	kswapd_init ();
+	ioring_init ();
+	shm_init ();
+	zero_kva = palloc_get_page (PAL_ASSERT | PAL_ZERO);
 }
 
 /* Get the type of the page. This function is useful if you want to know the
@@ -43,6 +128,24 @@ page_get_type (struct page *page) {
 static struct frame *vm_get_victim (void);
 static bool vm_do_claim_page (struct page *page);
 static struct frame *vm_evict_frame (void);
+static bool spt_copy_page (struct page *src_cur, void *dst_);
+static bool vm_install_frame (struct page *page, struct frame *frame);
+static bool vm_claim (struct page *page, bool *io);
+static bool vm_is_zero_fill (struct page *page);
+static bool vm_handle_fault (struct intr_frame *f, void *addr, bool user,
+		bool write, bool not_present, enum fault_type *type);
+static void fault_record (enum fault_type type, uint64_t cycles);
+static void fault_print_stats (void);
+static bool vm_map_zero (struct page *page);
+static void vm_fault_around (struct supplemental_page_table *spt,
+		void *va, struct file *file, off_t offset, bool sequential);
+static void vm_reclaim_behind (struct supplemental_page_table *spt,
+		void *va);
+static struct segment *lazy_segment (struct page *page);
+static bool vm_attach_text (struct page *page, struct text_frame *text);
+static bool drop_segment (struct page *page, void *aux);
+static bool vm_reads_disk (struct page *page);
+static void spt_free_page (struct page *page);
 
 /* Create the pending page object with initializer. If you want to create a
  * page, do not create it directly and make it through this function or `vm_alloc_page`. */
@@ -86,60 +189,519 @@ err:
 	return false;
 }
 
+/* Radix tree geometry; see struct supplemental_page_table.  Five
+ * levels of 64 entries index va bits 12 to 41, which covers all of
+ * user space. */
+#define SPT_BITS 6
+#define SPT_FANOUT (1 << SPT_BITS)
+#define SPT_LEVELS 5
+#define SPT_VA_LIMIT (1ULL << (PGBITS + SPT_LEVELS * SPT_BITS))
+
+/* Returns the lowest va bit that LEVEL's index is taken from. */
+static int
+spt_shift (int level) {
+	return PGBITS + (SPT_LEVELS - 1 - level) * SPT_BITS;
+}
+
+static unsigned
+spt_index (uint64_t va, int level) {
+	return (va >> spt_shift (level)) & (SPT_FANOUT - 1);
+}
+
+/* Returns a new, empty tree node, or NULL if out of memory. */
+static void **
+spt_new_node (void) {
+	return calloc (SPT_FANOUT, sizeof (void *));
+}
+
+/* Returns the leaf slot for VA in SPT.  If the nodes on the way
+ * do not exist, creates them if CREATE is true and returns NULL
+ * otherwise.  Also returns NULL if out of memory, or if VA is past
+ * the end of user space. */
+static struct page **
+spt_slot (struct supplemental_page_table *spt, const void *va, bool create) {
+	void **node;
+
+	if ((uint64_t) va >= SPT_VA_LIMIT)
+		return NULL;
+	if (spt->root == NULL) {
+		if (!create || (spt->root = spt_new_node ()) == NULL)
+			return NULL;
+	}
+	node = spt->root;
+	for (int level = 0; level < SPT_LEVELS - 1; level++) {
+		void **slot = &node[spt_index ((uint64_t) va, level)];
+		if (*slot == NULL) {
+			if (!create || (*slot = spt_new_node ()) == NULL)
+				return NULL;
+		}
+		node = *slot;
+	}
+	return (struct page **) &node[spt_index ((uint64_t) va, SPT_LEVELS - 1)];
+}
+
+/* Frees the nodes under NODE, a node at LEVEL covering the
+ * addresses from BASE up, that cover part of [START, END) and hold
+ * no pages.  Returns true if NODE itself is left empty. */
+static bool
+spt_prune_node (void **node, int level, uint64_t base, uint64_t start,
+		uint64_t end) {
+	uint64_t span = 1ULL << spt_shift (level);
+	unsigned i = start > base ? (start - base) / span : 0;
+
+	if (level < SPT_LEVELS - 1)
+		for (; i < SPT_FANOUT && base + i * span < end; i++)
+			if (node[i] != NULL && spt_prune_node (node[i], level + 1,
+						base + i * span, start, end)) {
+				free (node[i]);
+				node[i] = NULL;
+			}
+	for (i = 0; i < SPT_FANOUT; i++)
+		if (node[i] != NULL)
+			return false;
+	return true;
+}
+
+/* Frees the nodes of SPT covering part of [START, END) that pages
+ * were removed from and that are now empty. */
+static void
+spt_prune (struct supplemental_page_table *spt, void *start, void *end) {
+	if (spt->root != NULL && spt_prune_node (spt->root, 0, 0,
+				(uint64_t) start, (uint64_t) end)) {
+		free (spt->root);
+		spt->root = NULL;
+	}
+}
+
 /* Find VA from spt and return page. On error, return NULL. */
 /* va(가상 주소)에 해당하는 페이지 번호를 spt에서 검색하여 페이지 번호를 추출하는 함수 */
 struct page *
 spt_find_page (struct supplemental_page_table *spt UNUSED, void *va UNUSED) {
-	struct page page;
-	struct hash_elem *e;
-	page.va = pg_round_down(va);
-	e = hash_find(spt->pages, &page.hash_elem);
-	return e != NULL ? hash_entry (e, struct page, hash_elem) : NULL;
-}
-// struct page *
-// spt_find_page (struct supplemental_page_table *spt UNUSED, void *va UNUSED) {
-// 	struct page *page = calloc(1, sizeof(struct page));
-// 	page->va = pg_round_down(va);
-// 	struct hash_elem *e = hash_find(spt->pages, &page->hash_elem);
-// 	if (e == NULL){
-// 		return NULL;
-// 	}
-// 	struct page *tmp = hash_entry(e, struct page, hash_elem);
-// 	return tmp;
-// }
+	struct page **slot = spt_slot (spt, pg_round_down (va), false);
+	return slot != NULL ? *slot : NULL;
+}
 
 /* Insert PAGE into spt with validation. */
 bool
 spt_insert_page (struct supplemental_page_table *spt UNUSED, struct page *page UNUSED) {
-	int succ = false;
-	/* TODO: Fill this function. */
-	if (!hash_insert(spt->pages, &page->hash_elem)) // NULL이면 true
-		succ = true;
-	return succ;
+	struct page **slot = spt_slot (spt, page->va, true);
+
+	/* 이미 같은 va의 페이지가 있으면 실패 */
+	if (slot == NULL || *slot != NULL)
+		return false;
+	*slot = page;
+	spt->page_cnt++;
+	return true;
+}
+
+/* Frees PAGE, a page of the current process, noting whether
+ * fault-around saved a fault on it. */
+static void
+spt_free_page (struct page *page) {
+	struct thread *t = thread_current ();
+
+	vm_frame_pin (page);
+	ksm_forget (page);
+	if (page->ksm != NULL) {
+		ksm_unmap (page, false);
+		vm_frame_free (page, false);
+	}
+	if (page->mapped_ahead && t->pml4 != NULL
+			&& pml4_is_accessed (t->pml4, page->va))
+		mapped_ahead_used++;
+	if (page->zero && t->pml4 != NULL)
+		pml4_clear_page (t->pml4, page->va);
+	if (page->text != NULL)
+		text_release (page);
+	/* 고정된 프레임은 주인이 해제하므로 pml4_destroy()가 해제하지
+	 * 않도록 매핑만 지운다 */
+	if (page->pinned && t->pml4 != NULL)
+		pml4_clear_page (t->pml4, page->va);
+	if (page->shm != NULL)
+		shm_release (page);
+	vm_dealloc_page (page);
+}
+
+/* Takes PAGE's frame away, so that PAGE is loaded again on its
+ * next fault.  A page of an mmap'd file is written back first; an
+ * anonymous page loses its contents and reads as zeros from then
+ * on.  Shared executable text is left alone, since it could not
+ * be loaded again.  Returns true if a frame was dropped. */
+bool
+vm_drop_frame (struct page *page) {
+	struct thread *t = thread_current ();
+	struct frame *frame;
+
+	if (page->zero || page->pinned || page->shm != NULL)
+		return false;
+	vm_frame_pin (page);
+	frame = page->frame;
+	switch (VM_TYPE (page->operations->type)) {
+		case VM_FILE:
+			/* 공유 프레임은 떼어 내기만 하고 다음 fault에 다시 붙는다 */
+			if (page->text != NULL) {
+				text_release (page);
+				return true;
+			}
+			if (frame == NULL)
+				return false;
+			/* 써 보낸 뒤 프레임을 다시 이어 해제한다 */
+			swap_out (page);
+			page->frame = frame;
+			vm_frame_free (page, true);
+			return true;
+		case VM_ANON:
+			if (page->text != NULL)
+				return false;
+			if (page->ksm != NULL) {
+				ksm_unmap (page, false);
+				vm_frame_free (page, false);
+			} else if (frame != NULL) {
+				pml4_clear_page (t->pml4, page->va);
+				vm_frame_free (page, true);
+			} else if (!anon_swap_discard (page))
+				return false;
+			/* 페이지 테이블은 남아 있으므로 실패하지 않는다 */
+			page->zero = pml4_set_page (t->pml4, page->va, zero_kva, false);
+			return true;
+		default:
+			return false;
+	}
 }
 
+/* Takes PAGE out of its leaf slot in SPT and frees it, leaving the
+ * tree nodes in place for spt_prune(). */
+static void
+spt_unlink_page (struct supplemental_page_table *spt, struct page *page) {
+	struct page **slot = spt_slot (spt, page->va, false);
+
+	ASSERT (slot != NULL && *slot == page);
+	*slot = NULL;
+	spt->page_cnt--;
+	spt_free_page (page);
+}
+
+/* Removes PAGE from SPT and frees it, along with any tree nodes
+ * that are left empty. */
 void
 spt_remove_page (struct supplemental_page_table *spt, struct page *page) {
-	vm_dealloc_page (page);
+	void *va = page->va;
+
+	spt_unlink_page (spt, page);
+	spt_prune (spt, va, va + PGSIZE);
+}
+
+/* Calls FUNC on the pages under NODE, a node at LEVEL covering
+ * the addresses from BASE up, whose va lies in [START, END), in
+ * address order.  Stops and returns false as soon as FUNC does. */
+static bool
+spt_walk (void **node, int level, uint64_t base, uint64_t start,
+		uint64_t end, spt_page_func *func, void *aux) {
+	uint64_t span = 1ULL << spt_shift (level);
+	unsigned i = start > base ? (start - base) / span : 0;
+
+	for (; i < SPT_FANOUT && base + i * span < end; i++) {
+		/* FUNC may remove the page, so read the slot only once. */
+		void *child = node[i];
+		if (child == NULL)
+			continue;
+		if (level == SPT_LEVELS - 1) {
+			if (!func (child, aux))
+				return false;
+		} else if (!spt_walk (child, level + 1, base + i * span, start, end,
+					func, aux))
+			return false;
+	}
 	return true;
 }
 
+/* Calls FUNC with AUX on each page of SPT whose va lies in
+ * [START, END), in increasing address order.  FUNC may take the
+ * page it is given out of SPT, but not with spt_remove_page(),
+ * which may free the node being walked.  Returns false if FUNC
+ * returned false, true otherwise.  Only the tree nodes that cover
+ * the range are visited. */
+bool
+spt_for_each (struct supplemental_page_table *spt, void *start, void *end,
+		spt_page_func *func, void *aux) {
+	if (spt->root == NULL || start >= end)
+		return true;
+	return spt_walk (spt->root, 0, 0, (uint64_t) start, (uint64_t) end,
+			func, aux);
+}
+
+static bool
+spt_remove_func (struct page *page, void *spt) {
+	spt_unlink_page (spt, page);
+	return true;
+}
+
+/* Removes and frees every page of SPT whose va lies in
+ * [START, END), then the tree nodes that are left empty. */
+void
+spt_remove_range (struct supplemental_page_table *spt, void *start,
+		void *end) {
+	spt_for_each (spt, start, end, spt_remove_func, spt);
+	spt_prune (spt, start, end);
+}
+
+/* Puts FRAME on the frame table.  frame_lock must be held. */
+static void
+frame_link (struct frame *frame) {
+	ASSERT (!frame->evictable);
+	frame->evictable = true;
+	list_push_back (&frame_table, &frame->frame_elem);
+}
+
+/* Takes FRAME off the frame table, if it is on it.  frame_lock
+ * must be held. */
+static void
+frame_unlink (struct frame *frame) {
+	if (!frame->evictable)
+		return;
+	if (clock_hand == &frame->frame_elem)
+		clock_hand = list_next (clock_hand);
+	if (scan_hand == &frame->frame_elem)
+		scan_hand = list_next (scan_hand);
+	list_remove (&frame->frame_elem);
+	frame->evictable = false;
+}
+
+/* Waits until no I/O is under way on PAGE outside frame_lock.
+ * frame_lock must be held. */
+static void
+frame_wait (struct page *page) {
+	while (page->busy)
+		cond_wait (&frame_cond, &frame_lock);
+}
+
+/* Takes FRAME off the frame table, for a frame scan function that
+ * stops it from holding a page of a single process.  The frame
+ * table must be locked. */
+void
+vm_frame_unlink (struct frame *frame) {
+	ASSERT (lock_held_by_current_thread (&frame_lock));
+	frame_unlink (frame);
+}
+
+/* Takes FRAME off the frame table, for a frame scan function that
+ * writes its page out once vm_frame_scan() returns.  Until
+ * vm_frame_put_back(), vm_frame_pin() on the page waits, so that
+ * its process cannot free it meanwhile.  The frame table must be
+ * locked. */
+void
+vm_frame_take (struct frame *frame) {
+	ASSERT (lock_held_by_current_thread (&frame_lock));
+	frame_unlink (frame);
+	frame->page->busy = true;
+}
+
+/* Puts FRAME, taken by vm_frame_take(), back on the frame table. */
+void
+vm_frame_put_back (struct frame *frame) {
+	lock_acquire (&frame_lock);
+	frame->page->busy = false;
+	frame_link (frame);
+	cond_broadcast (&frame_cond, &frame_lock);
+	lock_release (&frame_lock);
+}
+
+/* Calls FUNC with AUX on up to CNT frames of the frame table, with
+ * the table locked, picking up where the last call left off and
+ * wrapping around at the end.  FUNC may take frames off the table
+ * with vm_frame_unlink() but must not free them. */
+void
+vm_frame_scan (size_t cnt, frame_scan_func *func, void *aux) {
+	lock_acquire (&frame_lock);
+	for (size_t i = 0; i < cnt && !list_empty (&frame_table); i++) {
+		struct frame *frame;
+
+		if (scan_hand == list_end (&frame_table))
+			scan_hand = list_begin (&frame_table);
+		frame = list_entry (scan_hand, struct frame, frame_elem);
+		scan_hand = list_next (scan_hand);
+		func (frame, aux);
+	}
+	lock_release (&frame_lock);
+}
+
+/* Puts FRAME, just loaded with a page of the current process, on
+ * the frame table, where it may be evicted. */
+void
+vm_frame_register (struct frame *frame) {
+	lock_acquire (&frame_lock);
+	frame_link (frame);
+	lock_release (&frame_lock);
+}
+
+/* Takes PAGE's frame, if any, off the frame table, so that it
+ * stays until registered again or freed.  Waits for an eviction
+ * of PAGE or a write-back of it under way; after an eviction PAGE
+ * has no frame. */
+void
+vm_frame_pin (struct page *page) {
+	lock_acquire (&frame_lock);
+	frame_wait (page);
+	if (page->frame != NULL)
+		frame_unlink (page->frame);
+	lock_release (&frame_lock);
+}
+
+/* Unlinks PAGE from its frame, if any, and frees the frame, and
+ * the page in it if FREE_KVA. */
+void
+vm_frame_free (struct page *page, bool free_kva) {
+	struct frame *frame;
+
+	lock_acquire (&frame_lock);
+	frame = page->frame;
+	if (frame != NULL) {
+		frame_unlink (frame);
+		page->frame = NULL;
+		vm_account (frame->owner, -1, 0,
+				page_get_type (page) == VM_FILE ? -1 : 0);
+		if (free_kva)
+			palloc_free_page (frame->kva);
+		free (frame);
+	}
+	lock_release (&frame_lock);
+}
+
+/* Adds RSS, SWAP and FILE pages to the memory use of T. */
+void
+vm_account (struct thread *t, long rss, long swap, long file) {
+	/* 다른 프로세스가 쫓아낼 때도 세므로 인터럽트를 끄고 고친다 */
+	enum intr_level old_level = intr_disable ();
+	t->usage.rss += rss;
+	t->usage.swap += swap;
+	t->usage.file += file;
+	if (t->usage.rss > t->usage.max_rss)
+		t->usage.max_rss = t->usage.rss;
+	intr_set_level (old_level);
+}
+
+/* Notes that the clock hand found a page of the process using U
+ * referenced.  frame_lock must be held. */
+static void
+ws_note (struct vm_usage *u) {
+	if (u->ws_epoch != clock_epoch) {
+		u->ws = u->ws_epoch + 1 == clock_epoch ? u->ws_cur : 0;
+		u->ws_cur = 0;
+		u->ws_epoch = clock_epoch;
+	}
+	u->ws_cur++;
+}
+
+/* Returns the working set of the process using U, as of the last
+ * full revolution of the clock hand.  frame_lock must be held. */
+static long
+ws_get (const struct vm_usage *u) {
+	if (u->ws_epoch == clock_epoch)
+		return u->ws;
+	if (u->ws_epoch + 1 == clock_epoch)
+		return u->ws_cur;
+	return 0;
+}
+
 /* Get the struct frame, that will be evicted. */
+/* 시계 바늘을 돌리며 accessed 비트가 꺼진 프레임을 고른다. 지나가는
+ * 프레임의 비트는 끈다. frame_lock을 잡고 부른다 */
 static struct frame *
 vm_get_victim (void) {
-	struct frame *victim = NULL;
-	 /* TODO: The policy for eviction is up to you. */
+	size_t frame_cnt = list_size (&frame_table);
 
-	return victim;
+	/* 두 바퀴 안에는 비트가 모두 꺼진다 */
+	for (size_t i = 0; i < 2 * frame_cnt + 1; i++) {
+		struct frame *frame;
+		uint64_t *pml4;
+
+		if (clock_hand == list_end (&frame_table)) {
+			clock_hand = list_begin (&frame_table);
+			clock_epoch++;
+			if (clock_hand == list_end (&frame_table))
+				return NULL;
+		}
+		frame = list_entry (clock_hand, struct frame, frame_elem);
+		clock_hand = list_next (clock_hand);
+
+		/* 공유 프레임은 매핑한 모든 프로세스의 비트를 본다 */
+		if (frame->owner == NULL) {
+			bool accessed = page_get_type (frame->page) == VM_FILE
+				? text_test_accessed (frame->page)
+				: shm_test_accessed (frame->page);
+			if (accessed)
+				continue;
+			return frame;
+		}
+		pml4 = frame->owner->pml4;
+		/* ksm이 대신 꺼 둔 비트도 참조로 센다 */
+		if (pml4_is_accessed (pml4, frame->page->va)
+				|| frame->page->ksm_young) {
+			pml4_set_accessed (pml4, frame->page->va, false);
+			frame->page->ksm_young = false;
+			ws_note (&frame->owner->usage);
+			continue;
+		}
+		return frame;
+	}
+	return NULL;
 }
 
 /* Evict one page and return the corresponding frame.
  * Return NULL on error.*/
 static struct frame *
 vm_evict_frame (void) {
-	struct frame *victim UNUSED = vm_get_victim ();
-	/* TODO: swap out the victim and return the evicted frame. */
-	return NULL;
+	struct frame *victim;
+	struct page *page;
+	bool file, saved;
+
+	lock_acquire (&frame_lock);
+	victim = vm_get_victim ();
+	if (victim == NULL) {
+		lock_release (&frame_lock);
+		return NULL;
+	}
+	page = victim->page;
+	file = page_get_type (page) == VM_FILE;
+	frame_unlink (victim);
+	/* 쓰는 동안 다른 프로세스가 프레임 테이블을 쓸 수 있도록 락을
+	 * 놓는다. 그 사이 페이지를 해제하려는 쪽은 vm_frame_pin()에서
+	 * 기다린다 */
+	page->busy = true;
+	lock_release (&frame_lock);
+
+	saved = swap_out (page);
+
+	lock_acquire (&frame_lock);
+	page->busy = false;
+	cond_broadcast (&frame_cond, &frame_lock);
+	if (!saved) {
+		/* 스왑이 가득 찼다 */
+		frame_link (victim);
+		lock_release (&frame_lock);
+		return NULL;
+	}
+	if (victim->owner != NULL)
+		vm_account (victim->owner, -1, file ? 0 : 1, file ? -1 : 0);
+	evict_cnt++;
+	lock_release (&frame_lock);
+
+	victim->page = NULL;
+	victim->owner = NULL;
+	return victim;
+}
+
+/* Evicts a frame and frees it, for kswapd.  Returns false if no
+ * frame could be evicted. */
+bool
+vm_reclaim_frame (void) {
+	struct frame *frame = vm_evict_frame ();
+
+	if (frame == NULL)
+		return false;
+	palloc_free_page (frame->kva);
+	free (frame);
+	return true;
 }
 
 /* palloc() and get frame. If there is no available page, evict the page
@@ -150,44 +712,189 @@ vm_evict_frame (void) {
  * 사용 가능한 페이지가 없으면 페이지를 제거하고 반환합니다.
  * 이것은 항상 유효한 주소를 반환합니다.
  * 즉, 사용자 풀 메모리가 가득 찬 경우 이 함수는 프레임을 제거하여 사용 가능한 메모리 공간을 확보합니다. */
-static struct frame *vm_get_frame (void) {
+/* ZERO이면 0으로 채운 프레임을 준다 */
+struct frame *vm_get_frame (bool zero) {
 	struct frame *frame = (struct frame*)calloc(1,sizeof(struct frame));
+	enum palloc_flags flags = PAL_USER | (zero ? PAL_ZERO : 0);
 	/* TODO: Fill this function. */
 	ASSERT (frame != NULL);
 	ASSERT (frame->page == NULL);
 
-	frame->kva = palloc_get_page(PAL_USER); // 물리메모리의 USER_POOL 내의 프레임을 프로세스의 커널 가상 메모리로 할당 및 매핑
+	frame->kva = palloc_get_page(flags); // 물리메모리의 USER_POOL 내의 프레임을 프로세스의 커널 가상 메모리로 할당 및 매핑
+	/* 남은 프레임이 적으면 kswapd가 미리 비워 두게 한다. 우선순위가
+	 * 높아 바로 돌므로 그 사이 빈 프레임이 생겼을 수 있다 */
+	kswapd_wake ();
+	if (frame->kva == NULL)
+		frame->kva = palloc_get_page (flags);
 	if (frame->kva == NULL){
-		PANIC("to do");
+		free (frame);
+		frame = vm_evict_frame ();
+		if (frame == NULL)
+			PANIC ("out of user frames and swap slots");
+		direct_evict_cnt++;
+		/* 쫓겨난 프레임에는 다른 프로세스의 내용이 남아 있다 */
+		if (zero)
+			memset (frame->kva, 0, PGSIZE);
 	}
-	// list_push_back(&frame_table, &frame->frame_elem);
-
-	// frame->page = NULL;
 
 	return frame;
 }
 
 /* Growing the stack. */
-static void vm_stack_growth(void *addr UNUSED)
+/* If WRITE is false, the new page maps the zero page until it is
+ * first written. */
+static void vm_stack_growth(void *addr UNUSED, bool write)
 {
 	addr = pg_round_down(addr);
 	if (addr > (void *) USER_STACK-0x100000) {
 		if (vm_alloc_page(VM_ANON | VM_MARKER_0, addr, true)){
-			vm_claim_page(addr);
+			if (write)
+				vm_claim_page(addr);
+			else
+				vm_map_zero (spt_find_page (&thread_current ()->spt, addr));
 		}
 	}
 	
 }
 /* Handle the fault on write_protected page */
+/* zero page나 ksm이 합친 프레임을 읽기 전용으로 매핑하고 있던
+ * 페이지에 처음 쓸 때 내용을 복사한 자기 프레임을 준다 */
 static bool
 vm_handle_wp (struct page *page UNUSED) {
+	struct thread *t = thread_current ();
+	struct frame *frame;
+
+	if ((!page->zero && page->ksm == NULL) || !page->writable)
+		return false;
+
+	frame = vm_get_frame (page->ksm == NULL);
+	if (page->ksm != NULL) {
+		/* 합쳐 둔 프레임의 구조체는 더 쓰지 않는다 */
+		memcpy (frame->kva, ksm_kva (page->ksm), PGSIZE);
+		ksm_unmap (page, true);
+		free (page->frame);
+		page->frame = NULL;
+	} else {
+		pml4_clear_page (t->pml4, page->va);
+		vm_account (t, 1, 0, 0);
+		zero_promote_cnt++;
+	}
+	if (!pml4_set_page (t->pml4, page->va, frame->kva, true)) {
+		palloc_free_page (frame->kva);
+		free (frame);
+		return false;
+	}
+	frame->page = page;
+	frame->owner = t;
+	page->frame = frame;
+	page->zero = false;
+	vm_frame_register (frame);
+	return true;
+}
+
+/* Returns true if PAGE is an anonymous page that has not been
+ * claimed yet and would start out all zeros. */
+static bool
+vm_is_zero_fill (struct page *page) {
+	struct segment *seg;
+
+	if (VM_TYPE (page->operations->type) != VM_UNINIT
+			|| VM_TYPE (page->uninit.type) != VM_ANON)
+		return false;
+	if (page->uninit.init == NULL)
+		return true;
+	/* bss: a segment page with nothing to read. */
+	seg = lazy_segment (page);
+	return seg != NULL && seg->page_read_bytes == 0;
+}
+
+/* Maps the zero page read-only at PAGE, a page for which
+ * vm_is_zero_fill() is true, and turns it into an anonymous page
+ * without a frame. */
+static bool
+vm_map_zero (struct page *page) {
+	struct thread *t = thread_current ();
+
+	if (page == NULL || pml4_get_page (t->pml4, page->va) != NULL
+			|| !pml4_set_page (t->pml4, page->va, zero_kva, false))
+		return false;
+
+	/* 읽을 내용이 없으니 초기화 함수 없이 anon 페이지로 바꾼다 */
+	if (page->uninit.init != NULL) {
+		free (page->uninit.aux);
+		page->uninit.init = NULL;
+		page->uninit.aux = NULL;
+	}
+	page->zero = true;
+	zero_map_cnt++;
+	return swap_in (page, zero_kva);
 }
 
 /* Return true on success */
 bool
 vm_try_handle_fault (struct intr_frame *f UNUSED, void *addr UNUSED,
 		bool user UNUSED, bool write UNUSED, bool not_present UNUSED) {
-	struct supplemental_page_table *spt UNUSED = &thread_current ()->spt;
+	uint64_t start = rdtsc ();
+	enum fault_type type = FAULT_INVALID;
+	bool handled = vm_handle_fault (f, addr, user, write, not_present, &type);
+
+	fault_record (handled ? type : FAULT_INVALID, rdtsc () - start);
+	return handled;
+}
+
+/* Adds a fault of TYPE that took CYCLES to STATS. */
+static void
+fault_add (struct faultstat *stats, enum fault_type type, uint64_t cycles) {
+	int bucket = cycles > 0 ? 63 - __builtin_clzll (cycles) : 0;
+
+	if (bucket >= FAULT_HIST_CNT)
+		bucket = FAULT_HIST_CNT - 1;
+	stats->count[type]++;
+	stats->cycles[type] += cycles;
+	if ((long long) cycles > stats->max[type])
+		stats->max[type] = cycles;
+	stats->hist[type][bucket]++;
+}
+
+/* Counts a fault of TYPE that took CYCLES, for the current process
+ * and for the shutdown report. */
+static void
+fault_record (enum fault_type type, uint64_t cycles) {
+	struct thread *t = thread_current ();
+	enum intr_level old_level;
+
+	/* 프로세스별 통계는 첫 폴트 때 만든다. 만들지 못하면 전체만 센다 */
+	if (t->usage.faults == NULL && t->pml4 != NULL)
+		t->usage.faults = calloc (1, sizeof *t->usage.faults);
+
+	old_level = intr_disable ();
+	fault_add (&fault_stats, type, cycles);
+	if (t->usage.faults != NULL)
+		fault_add (t->usage.faults, type, cycles);
+	intr_set_level (old_level);
+}
+
+/* Returns the kind of fault that loads PAGE, which has no frame. */
+static enum fault_type
+fault_classify (struct page *page) {
+	switch (VM_TYPE (page->operations->type)) {
+		case VM_UNINIT:
+			if (VM_TYPE (page->uninit.type) == VM_FILE)
+				return FAULT_FILE;
+			return lazy_segment (page) != NULL ? FAULT_LAZY : FAULT_ZERO;
+		case VM_ANON:
+			return FAULT_SWAP;
+		default:
+			return FAULT_FILE;
+	}
+}
+
+/* Handles a fault as vm_try_handle_fault() does, and stores its
+ * kind in *TYPE. */
+static bool
+vm_handle_fault (struct intr_frame *f, void *addr, bool user, bool write,
+		bool not_present, enum fault_type *type) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
 	struct page *page = NULL;
 	struct thread *t = thread_current();
 	if (is_kernel_vaddr(addr))
@@ -204,16 +911,404 @@ vm_try_handle_fault (struct intr_frame *f UNUSED, void *addr UNUSED,
 		page = spt_find_page(spt, addr);
 		if (page == NULL){
 			if (rsp_- addr == 0x8 || ( addr > rsp_ && USER_STACK > addr)){
-				vm_stack_growth(addr);
+				vm_stack_growth(addr, write);
+				*type = FAULT_STACK;
+				t->usage.minflt++;
 				return true;
 			}
 			return false;
 		}
-		return vm_do_claim_page (page);
+
+		/* 공유 메모리 페이지는 세그먼트의 프레임을 매핑한다 */
+		if (page->shm != NULL) {
+			bool io;
+
+			*type = FAULT_SHM;
+			if (!shm_fault (page, &io))
+				return false;
+			if (io)
+				t->usage.majflt++;
+			else
+				t->usage.minflt++;
+			return true;
+		}
+
+		/* 공유 파일 페이지는 text frame의 프레임을 매핑한다 */
+		if (page->text != NULL) {
+			bool io;
+
+			*type = page_get_type (page) == VM_FILE ? FAULT_FILE : FAULT_LAZY;
+			if (!text_fault (page, false, &io))
+				return false;
+			if (io)
+				t->usage.majflt++;
+			else
+				t->usage.minflt++;
+			return true;
+		}
+
+		/* 아직 0으로 채워질 페이지를 읽기만 하면 zero page를 매핑 */
+		if (!write && vm_is_zero_fill (page)) {
+			*type = FAULT_ZERO;
+			t->usage.minflt++;
+			return vm_map_zero (page);
+		}
+
+		/* claim 하면 aux가 해제되므로 파일 정보를 미리 가져온다 */
+		struct segment *seg = lazy_segment (page);
+		struct file *file = seg != NULL ? seg->file : NULL;
+		off_t offset = seg != NULL ? seg->offset : 0;
+		bool io;
+
+		*type = fault_classify (page);
+		if (!vm_claim (page, &io))
+			return false;
+		if (io)
+			t->usage.majflt++;
+		else
+			t->usage.minflt++;
+
+		int advice = madvise_get (spt, page->va);
+		if (file != NULL && advice != MADV_RANDOM)
+			vm_fault_around (spt, page->va, file, offset,
+					advice == MADV_SEQUENTIAL);
+		if (advice == MADV_SEQUENTIAL)
+			vm_reclaim_behind (spt, page->va);
+		return true;
+	}
+	if (write && (page = spt_find_page (spt, addr)) != NULL
+			&& vm_handle_wp (page)) {
+		*type = FAULT_COW;
+		t->usage.minflt++;
+		return true;
+	}
+	return false;
+}
+
+/* Returns the segment PAGE is to be loaded from, or NULL if PAGE
+ * is not a file page that is still waiting to be loaded. */
+static struct segment *
+lazy_segment (struct page *page) {
+	struct segment *seg;
+
+	if (VM_TYPE (page->operations->type) != VM_UNINIT
+			|| page->uninit.init != lazy_load_segment)
+		return NULL;
+	seg = page->uninit.aux;
+	return seg != NULL && seg->file != NULL ? seg : NULL;
+}
+
+/* A page of a fault-around window, claimed but not mapped yet. */
+struct fault_around_page {
+	struct page *page;          /* The page. */
+	struct frame *frame;        /* Frame to read it into, if any. */
+	off_t offset;               /* Offset of its bytes in the file. */
+	size_t read_bytes;          /* Bytes to read; the rest is zeroed. */
+	bool ok;                    /* Read in, or mapped if no FRAME? */
+};
+
+/* Fault-around window walk state. */
+struct fault_around {
+	void *next;                 /* Page expected next. */
+	struct inode *inode;        /* Backing file. */
+	off_t offset;               /* File offset expected next. */
+	size_t cnt;                 /* Pages claimed. */
+	struct fault_around_page pages[FAULT_AROUND_MAX];
+	struct iovec iov[FAULT_AROUND_MAX];
+};
+
+/* Claims PAGE ahead of any fault on it, if it directly follows
+ * the pages claimed so far in the file and in memory, and gives it
+ * a frame to be read into along with the rest of the window.  A
+ * page attached to a text frame that is in memory already is
+ * mapped at once instead.  Returns false to end the window.
+ * Called through spt_for_each(). */
+static bool
+fault_around_page (struct page *page, void *fa_) {
+	struct fault_around *fa = fa_;
+	struct segment *seg = lazy_segment (page);
+	struct fault_around_page *p = &fa->pages[fa->cnt];
+	struct text_key key;
+	struct text_frame *text = NULL;
+	bool io;
+
+	if (page->va != fa->next || seg == NULL
+			|| file_get_inode (seg->file) != fa->inode
+			|| seg->offset != fa->offset)
+		return false;
+	fa->next += PGSIZE;
+	fa->offset += PGSIZE;
+	/* 붙이고 나면 segment가 해제되므로 미리 가져온다 */
+	p->page = page;
+	p->offset = seg->offset;
+	p->read_bytes = seg->page_read_bytes;
+
+	/* 미리 매핑하는 페이지 때문에 메모리가 부족해지면 안 되므로
+	 * 프레임이 없으면 그냥 멈춘다 */
+	if (vm_text_key (page, &key))
+		text = text_get (&key);
+	if (text != NULL) {
+		if (!vm_attach_text (page, text))
+			return false;
+		p->frame = text_load_begin (page);
+		if (p->frame == NULL) {
+			p->ok = text_fault (page, true, &io);
+			fa->cnt++;
+			return p->ok;
+		}
+	} else {
+		void *kva = palloc_get_page (PAL_USER);
+
+		if (kva == NULL)
+			return false;
+		p->frame = calloc (1, sizeof *p->frame);
+		if (p->frame == NULL) {
+			palloc_free_page (kva);
+			return false;
+		}
+		p->frame->kva = kva;
+	}
+	fa->cnt++;
+	return true;
+}
+
+/* Reads the pages of FA that have frames to be read into from its
+ * file: each run of them that continues in the file, up to one
+ * with less than a page to read, with one inode_read_iov()
+ * scattered over their frames. */
+static void
+fault_around_read (struct fault_around *fa) {
+	size_t i = 0;
+
+	while (i < fa->cnt) {
+		size_t start = i;
+		size_t size = 0;
+		int n = 0;
+
+		if (fa->pages[i].frame == NULL) {
+			i++;
+			continue;
+		}
+		do {
+			struct fault_around_page *p = &fa->pages[i++];
+
+			fa->iov[n].iov_base = p->frame->kva;
+			fa->iov[n++].iov_len = p->read_bytes;
+			size += p->read_bytes;
+		} while (i < fa->cnt && fa->pages[i].frame != NULL
+				&& fa->pages[i - 1].read_bytes == PGSIZE);
+
+		bool ok = inode_read_iov (fa->inode, fa->iov, n,
+				fa->pages[start].offset) == (off_t) size;
+		while (start < i)
+			fa->pages[start++].ok = ok;
 	}
+}
+
+/* Maps P's page, a page of its own, at its frame if it was read
+ * in, or frees the frame.  Returns true if it was mapped. */
+static bool
+fault_around_install (struct fault_around_page *p) {
+	struct page *page = p->page;
+
+	if (p->ok) {
+		memset (p->frame->kva + p->read_bytes, 0, PGSIZE - p->read_bytes);
+		/* 내용은 이미 읽었으므로 segment만 해제한다 */
+		page->uninit.init = drop_segment;
+		if (vm_install_frame (page, p->frame)) {
+			vm_frame_register (p->frame);
+			return true;
+		}
+		page->uninit.init = lazy_load_segment;
+		page->frame = NULL;
+	}
+	palloc_free_page (p->frame->kva);
+	free (p->frame);
 	return false;
 }
 
+/* Maps the pages of FA that were read in and frees the frames of
+ * those that were not.  Returns the first page past the pages
+ * mapped in a row. */
+static void *
+fault_around_finish (struct fault_around *fa, void *va) {
+	void *next = va;
+
+	for (size_t i = 0; i < fa->cnt; i++) {
+		struct fault_around_page *p = &fa->pages[i];
+		struct page *page = p->page;
+		bool ok = p->ok;
+
+		if (p->frame != NULL && page->text != NULL)
+			ok = text_load_end (page, p->frame, ok);
+		else if (p->frame != NULL)
+			ok = fault_around_install (p);
+		if (ok) {
+			page->mapped_ahead = true;
+			mapped_ahead_cnt++;
+			if (next == page->va)
+				next = page->va + PGSIZE;
+		}
+	}
+	return next;
+}
+
+/* Adjusts the fault-around window of SPT after a fault on VA, a
+ * page loaded from FILE at OFFSET, and claims the pages in the
+ * window that continue VA in FILE.  If SEQUENTIAL, the window is
+ * the widest there is. */
+static void
+vm_fault_around (struct supplemental_page_table *spt, void *va,
+		struct file *file, off_t offset, bool sequential) {
+	struct fault_around *fa;
+
+	if (sequential)
+		spt->ra_window = FAULT_AROUND_MAX;
+	else if (va == spt->ra_next) {
+		spt->ra_window = spt->ra_window ? spt->ra_window * 2 : 1;
+		if (spt->ra_window > FAULT_AROUND_MAX)
+			spt->ra_window = FAULT_AROUND_MAX;
+	} else if (spt->ra_next != NULL)
+		spt->ra_window /= 2;
+
+	/* 커널 스택이 작으므로 창의 상태는 힙에 둔다 */
+	if (spt->ra_window == 0 || (fa = malloc (sizeof *fa)) == NULL) {
+		spt->ra_next = va + PGSIZE;
+		return;
+	}
+	fa->next = va + PGSIZE;
+	fa->inode = file_get_inode (file);
+	fa->offset = offset + PGSIZE;
+	fa->cnt = 0;
+	spt_for_each (spt, fa->next, va + (spt->ra_window + 1) * PGSIZE,
+			fault_around_page, fa);
+	fault_around_read (fa);
+	spt->ra_next = fault_around_finish (fa, va + PGSIZE);
+	if (spt->ra_next != va + PGSIZE)
+		fault_around_cnt++;
+	free (fa);
+}
+
+static bool
+reclaim_page (struct page *page, void *aux UNUSED) {
+	if (page_get_type (page) == VM_FILE && vm_drop_frame (page))
+		reclaim_behind_cnt++;
+	return true;
+}
+
+/* Drops the frames of mmap'd pages of SPT in the window that lies
+ * one fault-around window behind VA, within VA's MADV_SEQUENTIAL
+ * region.  They are written back first if dirty. */
+static void
+vm_reclaim_behind (struct supplemental_page_table *spt, void *va) {
+	const struct madvise_region *r = madvise_find (spt, va);
+	uintptr_t lag = FAULT_AROUND_MAX * PGSIZE;
+	uintptr_t start, end;
+
+	if ((uintptr_t) va < (uintptr_t) r->start + lag)
+		return;
+	end = (uintptr_t) va - lag;
+	start = end - (uintptr_t) r->start > lag ? end - lag
+		: (uintptr_t) r->start;
+	spt_for_each (spt, (void *) start, (void *) end, reclaim_page, NULL);
+}
+
+/* Prints fault-around statistics. */
+void
+vm_print_stats (void) {
+	printf ("Fault-around: %lld faults, %lld pages mapped ahead, %lld used\n",
+			fault_around_cnt, mapped_ahead_cnt, mapped_ahead_used);
+	printf ("Reclaim-behind: %lld frames dropped\n", reclaim_behind_cnt);
+	madvise_print_stats ();
+	text_print_stats ();
+	printf ("Zero page: %lld read faults mapped it, %lld later written\n",
+			zero_map_cnt, zero_promote_cnt);
+	printf ("Frames: %zu on the frame table, %lld evicted, "
+			"%lld of them inside faults\n",
+			list_size (&frame_table), evict_cnt, direct_evict_cnt);
+	kswapd_print_stats ();
+	ksm_print_stats ();
+	swap_print_stats ();
+	ioring_print_stats ();
+	shm_print_stats ();
+	printf ("Memory: %d processes exited, %lld minor and %lld major faults\n",
+			exit_cnt, exit_minflt, exit_majflt);
+	if (exit_cnt > 0)
+		printf ("Memory: peak RSS %ld pages, by %s\n", peak_rss, peak_name);
+	fault_print_stats ();
+}
+
+/* Prints the count, mean and maximum latency of each kind of page
+ * fault, and the nonempty buckets of its latency histogram, as
+ * log2 of TSC cycles and count. */
+static void
+fault_print_stats (void) {
+	for (int type = 0; type < FAULT_TYPE_CNT; type++) {
+		long long cnt = fault_stats.count[type];
+
+		if (cnt == 0)
+			continue;
+		printf ("Faults: %-7s %8lld, mean %lld, max %lld cycles;",
+				fault_names[type], cnt, fault_stats.cycles[type] / cnt,
+				fault_stats.max[type]);
+		for (int i = 0; i < FAULT_HIST_CNT; i++)
+			if (fault_stats.hist[type][i] != 0)
+				printf (" %d:%u", i, fault_stats.hist[type][i]);
+		printf ("\n");
+	}
+}
+
+/* Fills in STATS with the page faults of the current process or,
+ * if ALL, of every process since boot. */
+void
+vm_faultstat (struct faultstat *stats, bool all) {
+	struct faultstat *src = all ? &fault_stats
+		: thread_current ()->usage.faults;
+	enum intr_level old_level = intr_disable ();
+
+	if (src != NULL)
+		*stats = *src;
+	else
+		memset (stats, 0, sizeof *stats);
+	intr_set_level (old_level);
+}
+
+/* Fills in USAGE with the memory use of the current process. */
+void
+vm_getrusage (struct rusage *usage) {
+	struct vm_usage *u = &thread_current ()->usage;
+
+	lock_acquire (&frame_lock);
+	usage->ru_rss = u->rss;
+	usage->ru_maxrss = u->max_rss;
+	usage->ru_swap = u->swap;
+	usage->ru_file = u->file;
+	usage->ru_ws = ws_get (u);
+	usage->ru_minflt = u->minflt;
+	usage->ru_majflt = u->majflt;
+	lock_release (&frame_lock);
+}
+
+/* Adds the memory use of the current process, which is exiting,
+ * to the shutdown report. */
+void
+vm_usage_exit (void) {
+	struct thread *t = thread_current ();
+	enum intr_level old_level = intr_disable ();
+
+	exit_cnt++;
+	exit_minflt += t->usage.minflt;
+	exit_majflt += t->usage.majflt;
+	if (t->usage.max_rss > peak_rss) {
+		peak_rss = t->usage.max_rss;
+		strlcpy (peak_name, t->name, sizeof peak_name);
+	}
+	intr_set_level (old_level);
+
+	free (t->usage.faults);
+	t->usage.faults = NULL;
+}
+
 /* Free the page.
  * DO NOT MODIFY THIS FUNCTION. */
 void
@@ -235,17 +1330,154 @@ vm_claim_page (void *va UNUSED) {
 	return vm_do_claim_page (page);
 }
 
+/* Maps KVA, a user pool page that the caller keeps owning, at VA
+ * in the current process as a writable anonymous page.  Its frame
+ * is never evicted or merged, is not copied into a child by fork
+ * and is left to the caller to free when the page goes away.
+ * Returns false if VA is taken or memory runs out. */
+bool
+vm_map_pinned (void *va, void *kva) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct frame *frame;
+	struct page *page;
+
+	if (!vm_alloc_page (VM_ANON | VM_MARKER_0, va, true))
+		return false;
+	page = spt_find_page (spt, va);
+	page->pinned = true;
+	frame = calloc (1, sizeof *frame);
+	if (frame != NULL) {
+		frame->kva = kva;
+		/* 프레임 테이블에 올리지 않으므로 쫓겨나지 않는다 */
+		if (vm_install_frame (page, frame))
+			return true;
+	}
+	spt_remove_page (spt, page);
+	return false;
+}
+
 /* Claim the PAGE and set up the mmu. */
 static bool
 vm_do_claim_page (struct page *page) {
-	struct frame *frame = vm_get_frame ();
+	return vm_claim (page, NULL);
+}
+
+/* Initializer for a page whose contents are already in its
+ * frame: just frees the segment. */
+static bool
+drop_segment (struct page *page UNUSED, void *aux) {
+	free (aux);
+	return true;
+}
+
+/* Attaches PAGE to TEXT, handing over the caller's reference to
+ * TEXT, and turns PAGE into a page whose contents are in TEXT's
+ * frame.  Returns false if memory is short. */
+static bool
+vm_attach_text (struct page *page, struct text_frame *text) {
+	if (!text_attach (page, text))
+		return false;
+	/* 내용은 text frame에 있으므로 프레임 없이 페이지만 바꾼다 */
+	if (VM_TYPE (page->operations->type) == VM_UNINIT) {
+		page->uninit.init = drop_segment;
+		swap_in (page, NULL);
+	}
+	return true;
+}
+
+/* Gives PAGE a frame, maps it and loads its contents.  A
+ * read-only page of an executable or a page of an mmap'd file is
+ * attached to its text frame instead, and maps the frame that is
+ * loaded in, reading it first if no process has.  If IO is
+ * nonnull, stores in *IO whether PAGE was read from disk. */
+static bool
+vm_claim (struct page *page, bool *io) {
+	struct text_key key;
+	struct text_frame *text = NULL;
+	struct frame *frame;
+	bool ignored;
+	/* 읽어 올 내용이 없는 새 익명 페이지는 0으로 채운 프레임을 받는다 */
+	bool zero = VM_TYPE (page->operations->type) == VM_UNINIT
+		&& page->uninit.init == NULL;
+
+	if (vm_text_key (page, &key))
+		text = text_get (&key);
+	if (text != NULL) {
+		if (!vm_attach_text (page, text))
+			return false;
+		return text_fault (page, false, io != NULL ? io : &ignored);
+	}
+
+	if (io != NULL)
+		*io = vm_reads_disk (page);
+	frame = vm_get_frame (zero);
+	if (!vm_install_frame (page, frame))
+		return false;
+	vm_frame_register (frame);
+	return true;
+}
+
+/* Returns true if loading PAGE into a frame of its own reads the
+ * disk. */
+static bool
+vm_reads_disk (struct page *page) {
+	struct segment *seg;
+
+	switch (VM_TYPE (page->operations->type)) {
+		case VM_UNINIT:
+			seg = lazy_segment (page);
+			return seg != NULL && seg->page_read_bytes > 0;
+		case VM_ANON:
+			return page->anon.slot_number != -1;
+		case VM_FILE:
+			return page->file.page_read_bytes > 0;
+		default:
+			return false;
+	}
+}
+
+/* If PAGE has no frame yet and its frame may be shared with other
+ * processes, stores the page it is loaded from in *KEY and returns
+ * true.  That is a read-only page of an executable still to be
+ * loaded, or a page of an mmap'd file. */
+bool
+vm_text_key (struct page *page, struct text_key *key) {
+	struct segment *seg = lazy_segment (page);
+
+	if (seg != NULL) {
+		key->mapping = VM_TYPE (page->uninit.type) == VM_FILE;
+		/* 실행 파일에서 쓰기 가능한 부분은 프로세스마다 따로 가진다 */
+		if (!key->mapping && page->writable)
+			return false;
+		key->inode = file_get_inode (seg->file);
+		key->offset = seg->offset;
+		key->read_bytes = seg->page_read_bytes;
+		return true;
+	}
+	/* 프레임을 내려놓았던 매핑 페이지 */
+	if (VM_TYPE (page->operations->type) == VM_FILE && page->frame == NULL
+			&& page->text == NULL) {
+		key->mapping = true;
+		key->inode = file_get_inode (page->file.file);
+		key->offset = page->file.offset;
+		key->read_bytes = page->file.page_read_bytes;
+		return true;
+	}
+	return false;
+}
+
+/* Links PAGE with FRAME, maps it and loads its contents. */
+static bool
+vm_install_frame (struct page *page, struct frame *frame) {
 	struct thread *t = thread_current();
 	/* Set links */
 	frame->page = page;
+	frame->owner = t;
 	page->frame = frame;
 	/* TODO: Insert page table entry to map page's VA to frame's PA. */
 
 	if (pml4_get_page(t->pml4, page->va) == NULL &&  pml4_set_page (t->pml4, page->va, frame->kva, page->writable)){
+		vm_account (t, 1, 0, page_get_type (page) == VM_FILE ? 1 : 0);
 		return swap_in(page, frame->kva);
 	}
 	return false;
@@ -255,9 +1487,13 @@ vm_do_claim_page (struct page *page) {
 /* 새로운 보충 페이지 테이블을 초기화하는 함수 */
 void
 supplemental_page_table_init (struct supplemental_page_table *spt UNUSED) {
-	// 보충 페이지 테이블 초기화
-	spt->pages = calloc(sizeof(struct hash), 1); // 해시 테이블 사용을 위한 동적 할당
-	hash_init(spt->pages, page_hash, page_less, NULL);
+	// 보충 페이지 테이블 초기화; 노드는 처음 삽입할 때 할당
+	spt->root = NULL;
+	spt->page_cnt = 0;
+	spt->ra_next = NULL;
+	spt->ra_window = FAULT_AROUND_INIT;
+	list_init (&spt->regions);
+	list_init (&spt->advice);
 }
 
 /* Copy supplemental page table from src to dst */
@@ -269,44 +1505,102 @@ supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED,
 	// TODO : page마다 type이 다르므로, copy 방식이 달라야함
 	/*	- UNINIT일때는, 그대로 복사하고 claim은 해줄 필요 없음 
 		- 외에는 부모 기반으로 똑같이 만들어준 뒤, 바로 claim 해주기 ㄱㄱ*/
-	struct hash_iterator i;
-	hash_first(&i, src->pages);
-	while (hash_next(&i)) {
-		struct page *src_cur = hash_entry(hash_cur(&i), struct page, hash_elem);
-		// printf("spt copy vmtype : %d\n", src_cur->operations->type);
-		// 0 : VM_UNINIT, 1 : VM_ANON, 2 : VM_FILE
-		void *va = src_cur->va;
-		bool writable = src_cur->writable;
-		enum vm_type type = src_cur->operations->type;
-		struct segment *aux = calloc(1, sizeof(struct segment));
-		switch (VM_TYPE(type)){
-			case VM_UNINIT:
-				memcpy(aux, src_cur->uninit.aux, sizeof(struct segment));
-				if (!vm_alloc_page_with_initializer(src_cur->uninit.type,va,writable,src_cur->uninit.init, aux)){
-					free(aux);
-					return false;
-				}
+	// 주소 순서대로 부모의 페이지를 하나씩 복사
+	return madvise_copy (dst, src)
+		&& spt_for_each (src, NULL, (void *) KERN_BASE, spt_copy_page, dst);
+}
+
+/* Copies SRC_CUR, a page of the parent, into DST_, the child's
+ * spt.  Called through spt_for_each(). */
+static bool
+spt_copy_page (struct page *src_cur, void *dst_) {
+	struct supplemental_page_table *dst = dst_;
+	// printf("spt copy vmtype : %d\n", src_cur->operations->type);
+	// 0 : VM_UNINIT, 1 : VM_ANON, 2 : VM_FILE
+	void *va = src_cur->va;
+	bool writable = src_cur->writable;
+	enum vm_type type = src_cur->operations->type;
+	struct segment *aux = calloc(1, sizeof(struct segment));
+	switch (VM_TYPE(type)){
+		case VM_UNINIT:
+			/* mmap 매핑은 자식에게 물려주지 않는다 */
+			if (VM_TYPE (src_cur->uninit.type) == VM_FILE) {
+				free (aux);
 				break;
-			case VM_ANON :
+			}
+			memcpy(aux, src_cur->uninit.aux, sizeof(struct segment));
+			if (!vm_alloc_page_with_initializer(src_cur->uninit.type,va,writable,src_cur->uninit.init, aux)){
 				free(aux);
-				if (!(vm_alloc_page(type | VM_MARKER_0,va,writable) && vm_claim_page(va))){
+				return false;
+			}
+			break;
+		case VM_ANON :
+			free(aux);
+			/* 공유 메모리는 자식도 같은 세그먼트에 붙는다 */
+			if (src_cur->shm != NULL)
+				return shm_copy (src_cur);
+			/* 고정된 페이지(ioring)는 자식에게 물려주지 않는다 */
+			if (src_cur->pinned)
+				break;
+			if (src_cur->zero) {
+				if (!vm_alloc_page (type | VM_MARKER_0, va, writable)
+						|| !vm_map_zero (spt_find_page (dst, va)))
 					return false;
-				}
-				struct page* child_p = spt_find_page(dst, va);
-				memcpy(child_p->frame->kva, src_cur->frame->kva, PGSIZE);	
 				break;
-			case VM_FILE :
+			}
+			if (src_cur->text != NULL) {
+				/* 공유 중인 실행 파일 페이지는 복사하지 않고 같이 쓴다.
+				 * 첫 fault에 매핑한다 */
+				struct page *page;
+				if (!vm_alloc_page (type | VM_MARKER_0, va, writable))
+					return false;
+				page = spt_find_page (dst, va);
+				if (!text_copy (page, src_cur))
+					return false;
+				swap_in (page, NULL);
 				break;
-			default :
-				PANIC("SPT COPY PANIC!\n");
-		}
+			}
+			if (!vm_alloc_page(type | VM_MARKER_0,va,writable)){
+				return false;
+			}
+			struct page* child_p = spt_find_page(dst, va);
+			struct frame *child_f = vm_get_frame (false);
+			/* 부모 페이지가 복사 도중 쫓겨나지 않도록 잠그고, 쫓겨나는
+			 * 중이면 끝나기를 기다려 복사한다. 이미 스왑에 있으면
+			 * 슬롯에서 읽는다 */
+			lock_acquire (&frame_lock);
+			frame_wait (src_cur);
+			if (src_cur->frame != NULL)
+				memcpy (child_f->kva, src_cur->frame->kva, PGSIZE);
+			else
+				anon_swap_read (src_cur, child_f->kva);
+			lock_release (&frame_lock);
+			if (!vm_install_frame (child_p, child_f))
+				return false;
+			vm_frame_register (child_f);
+			break;
+		case VM_FILE :
+			free(aux);
+			break;
+		default :
+			PANIC("SPT COPY PANIC!\n");
 	}
 	return true;
 }
 
-void page_destructor(struct hash_elem* hash_elem, void* aux){
-	struct page *p = hash_entry(hash_elem, struct page, hash_elem);
-	vm_dealloc_page(p);
+/* Frees NODE, a tree node at LEVEL, along with everything below
+ * it, in address order. */
+static void
+spt_destroy_node (void **node, int level) {
+	for (unsigned i = 0; i < SPT_FANOUT; i++) {
+		if (node[i] == NULL)
+			continue;
+		if (level == SPT_LEVELS - 1)
+			spt_free_page (node[i]);
+		else
+			spt_destroy_node (node[i], level + 1);
+	}
+	free (node);
 }
 
 /* Free the resource hold by the supplemental page table */
@@ -315,22 +1609,10 @@ void
 supplemental_page_table_kill (struct supplemental_page_table *spt UNUSED) {
 	/* TODO: Destroy all the supplemental_page_table hold by thread and
 	 * TODO: writeback all the modified contents to the storage. */
-   	hash_destroy(&spt->pages, page_destructor);
-}
-
-/* Returns a hash value for page p. */
-/* 해시 요소에 대한 해시 값을 계산 후 리턴하는 함수의 포인터 */
-unsigned page_hash (const struct hash_elem *p_, void *aux UNUSED)
-{
-	const struct page *p = hash_entry(p_, struct page, hash_elem);
-	return hash_bytes(&p->va, sizeof p->va);
-}
-/* Returns true if page a precedes page b. */
-/* 해시 요소를 비교하는 함수의 포인터 */
-bool page_less (const struct hash_elem *a_, const struct hash_elem *b_, void *aux UNUSED) 
-{
-  const struct page *a = hash_entry (a_, struct page, hash_elem);
-  const struct page *b = hash_entry (b_, struct page, hash_elem);
-  
-  return a->va < b->va;
+	mmap_unmap_all (spt);
+	madvise_destroy (spt);
+	if (spt->root != NULL)
+		spt_destroy_node (spt->root, 0);
+	spt->root = NULL;
+	spt->page_cnt = 0;
 }
@@ -0,0 +1,265 @@
+/* zswap.c: Compressed cache in front of the swap disk.
+ *
+ * Writing a page to swap costs eight sector writes and reading it
+ * back eight more, yet many evicted anonymous pages are mostly
+ * zeros.  anon_swap_out() offers every page here first.  A page
+ * whose 64-bit words are all the same is kept as that one value;
+ * any other page is compressed with a small LZ77 coder and kept in
+ * a malloc() block, which comes out of the kernel pool.  A page
+ * that does not shrink to a quarter of its size goes to the disk
+ * as before.
+ *
+ * The pool is capped at ZSWAP_POOL_PAGES pages' worth of blocks.
+ * Once it is over, zswap_victim() hands back the oldest entry,
+ * which anon.c writes to a swap slot and frees.
+ *
+ * The caller serializes all calls; anon.c does so with swap_lock.
+ *
+ * Compressed format: a sequence of tokens.  A tag byte below 0x80
+ * is followed by tag + 1 literal bytes.  A tag of 0x80 or above is
+ * a match of (tag & 0x7f) + LZ_MIN_MATCH bytes, copied from the
+ * distance given by the next two bytes, little-endian. */
+
+#include "vm/zswap.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/disk.h"
+#include "threads/malloc.h"
+#include "threads/vaddr.h"
+
+/* Kernel pages the pool may fill. */
+#define ZSWAP_POOL_PAGES 64
+#define ZSWAP_POOL_BYTES (ZSWAP_POOL_PAGES * PGSIZE)
+
+/* Largest compressed page worth keeping: one that still fits in
+ * malloc()'s largest block size, 1 kB. */
+#define ZSWAP_MAX_LEN (PGSIZE / 4 - sizeof (struct zswap_entry))
+
+#define LZ_HASH_BITS 10
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_MATCH (LZ_MIN_MATCH + 0x7f)
+#define LZ_MAX_LITERALS 0x80
+
+/* Entries in the pool, oldest first, and bytes they take. */
+static struct list pool;
+static size_t pool_bytes;
+
+/* Earlier positions + 1 of each hashed 4-byte sequence, and the
+ * output of the last compression. */
+static uint16_t lz_table[1 << LZ_HASH_BITS];
+static uint8_t lz_buf[ZSWAP_MAX_LEN];
+
+/* Statistics. */
+static long long same_cnt;              /* Same-filled pages stored. */
+static long long compress_cnt;          /* Compressed pages stored. */
+static long long reject_cnt;            /* ...that did not compress. */
+static long long load_cnt;              /* Pages loaded back. */
+static long long writeback_cnt;         /* Entries pushed to disk. */
+static long long bytes_in;              /* Bytes compressed... */
+static long long bytes_out;             /* ...and what they came to. */
+
+void
+zswap_init (void) {
+	list_init (&pool);
+}
+
+/* Returns the size of the malloc() block that holds SIZE bytes. */
+static size_t
+block_size (size_t size) {
+	size_t block = 16;
+
+	while (block < size)
+		block *= 2;
+	return block;
+}
+
+/* Appends the N literal bytes at SRC to OUT, which holds *OP bytes
+ * of MAX.  Returns false if they do not fit. */
+static bool
+lz_literals (const uint8_t *src, size_t n, uint8_t *out, size_t *op,
+		size_t max) {
+	while (n > 0) {
+		size_t run = n < LZ_MAX_LITERALS ? n : LZ_MAX_LITERALS;
+
+		if (*op + 1 + run > max)
+			return false;
+		out[(*op)++] = run - 1;
+		memcpy (out + *op, src, run);
+		*op += run;
+		src += run;
+		n -= run;
+	}
+	return true;
+}
+
+/* Compresses the page at IN into at most MAX bytes of OUT.  Returns
+ * the compressed length, or 0 if it does not fit. */
+static size_t
+lz_compress (const uint8_t *in, uint8_t *out, size_t max) {
+	size_t ip = 0, op = 0, lit = 0;
+
+	memset (lz_table, 0, sizeof lz_table);
+	while (ip + LZ_MIN_MATCH <= PGSIZE) {
+		uint32_t v;
+		size_t h, cand, len, dist;
+
+		memcpy (&v, in + ip, sizeof v);
+		h = (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+		cand = lz_table[h];
+		lz_table[h] = ip + 1;
+		if (cand == 0 || memcmp (in + cand - 1, in + ip, LZ_MIN_MATCH) != 0) {
+			ip++;
+			continue;
+		}
+
+		cand--;
+		len = LZ_MIN_MATCH;
+		while (len < LZ_MAX_MATCH && ip + len < PGSIZE
+				&& in[cand + len] == in[ip + len])
+			len++;
+		if (!lz_literals (in + lit, ip - lit, out, &op, max) || op + 3 > max)
+			return 0;
+		dist = ip - cand;
+		out[op++] = 0x80 | (len - LZ_MIN_MATCH);
+		out[op++] = dist & 0xff;
+		out[op++] = dist >> 8;
+		ip += len;
+		lit = ip;
+	}
+	if (!lz_literals (in + lit, PGSIZE - lit, out, &op, max))
+		return 0;
+	return op;
+}
+
+/* Expands the LEN bytes of compressed data at IN into the page at
+ * OUT. */
+static void
+lz_decompress (const uint8_t *in, size_t len, uint8_t *out) {
+	size_t ip = 0, op = 0;
+
+	while (ip < len) {
+		uint8_t tag = in[ip++];
+
+		if (tag & 0x80) {
+			size_t n = (tag & 0x7f) + LZ_MIN_MATCH;
+			size_t dist = in[ip] | in[ip + 1] << 8;
+
+			ip += 2;
+			ASSERT (dist > 0 && dist <= op && op + n <= PGSIZE);
+			/* 겹치는 복사일 수 있으므로 한 바이트씩 옮긴다 */
+			for (; n > 0; n--, op++)
+				out[op] = out[op - dist];
+		} else {
+			size_t n = tag + 1;
+
+			ASSERT (op + n <= PGSIZE);
+			memcpy (out + op, in + ip, n);
+			ip += n;
+			op += n;
+		}
+	}
+	ASSERT (op == PGSIZE);
+}
+
+/* Returns true if the page at KVA repeats one 64-bit word, which is
+ * stored in *FILL. */
+static bool
+same_filled (const void *kva, uint64_t *fill) {
+	const uint64_t *w = kva;
+
+	for (size_t i = 1; i < PGSIZE / sizeof *w; i++)
+		if (w[i] != w[0])
+			return false;
+	*fill = w[0];
+	return true;
+}
+
+/* Stores the contents of PAGE, at KVA, in the pool.  Returns the
+ * new entry, or a null pointer if the page does not compress well
+ * or memory is short, in which case it belongs on the disk. */
+struct zswap_entry *
+zswap_store (struct page *page, const void *kva) {
+	struct zswap_entry *entry;
+	uint64_t fill = 0;
+	bool same = same_filled (kva, &fill);
+	size_t len = 0;
+
+	if (!same) {
+		len = lz_compress (kva, lz_buf, ZSWAP_MAX_LEN);
+		if (len == 0) {
+			reject_cnt++;
+			return NULL;
+		}
+	}
+
+	entry = malloc (sizeof *entry + len);
+	if (entry == NULL)
+		return NULL;
+	entry->page = page;
+	entry->charge = block_size (sizeof *entry + len);
+	entry->same = same;
+	entry->fill = fill;
+	entry->len = len;
+	memcpy (entry->data, lz_buf, len);
+	list_push_back (&pool, &entry->elem);
+	pool_bytes += entry->charge;
+
+	if (same)
+		same_cnt++;
+	else {
+		compress_cnt++;
+		bytes_in += PGSIZE;
+		bytes_out += len;
+	}
+	return entry;
+}
+
+/* Copies the page ENTRY holds into KVA. */
+void
+zswap_load (const struct zswap_entry *entry, void *kva) {
+	if (entry->same) {
+		uint64_t *w = kva;
+
+		for (size_t i = 0; i < PGSIZE / sizeof *w; i++)
+			w[i] = entry->fill;
+	} else
+		lz_decompress (entry->data, entry->len, kva);
+	load_cnt++;
+}
+
+/* Takes ENTRY out of the pool and frees it.  WRITTEN_BACK is true
+ * if its contents were just written to a swap slot. */
+void
+zswap_free (struct zswap_entry *entry, bool written_back) {
+	list_remove (&entry->elem);
+	pool_bytes -= entry->charge;
+	if (written_back)
+		writeback_cnt++;
+	free (entry);
+}
+
+/* Returns the oldest entry if the pool is over its size, or a null
+ * pointer. */
+struct zswap_entry *
+zswap_victim (void) {
+	if (pool_bytes <= ZSWAP_POOL_BYTES || list_empty (&pool))
+		return NULL;
+	return list_entry (list_front (&pool), struct zswap_entry, elem);
+}
+
+/* Prints zswap statistics. */
+void
+zswap_print_stats (void) {
+	long long writes = same_cnt + compress_cnt - writeback_cnt;
+	long long ratio = bytes_out > 0 ? bytes_in * 100 / bytes_out : 0;
+	int sectors = PGSIZE / DISK_SECTOR_SIZE;
+
+	printf ("Zswap: %lld same-filled and %lld compressed pages, "
+			"%lld incompressible, %zu entries in %zu bytes\n",
+			same_cnt, compress_cnt, reject_cnt, list_size (&pool), pool_bytes);
+	printf ("Zswap: compression ratio %lld.%02lld, %lld pages written back, "
+			"%lld sector writes and %lld sector reads avoided\n",
+			ratio / 100, ratio % 100, writeback_cnt,
+			writes * sectors, load_cnt * sectors);
+}